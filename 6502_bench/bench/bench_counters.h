@@ -0,0 +1,20 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_BENCH_COUNTERS_H
+#define INC_6502_PROJECT_BENCH_COUNTERS_H
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+/*
+ * reports emulated clock and executed instructions per second of the whole run
+ * clock is printed with SI prefix, emulated_Hz=1.79M/s is a 1.79 MHz machine running in real time
+ */
+inline void ReportThroughput(benchmark::State& state, uint64_t cycles, uint64_t instructions) {
+    state.counters["emulated_Hz"] = benchmark::Counter(double(cycles), benchmark::Counter::kIsRate);
+    state.counters["instructions/s"] = benchmark::Counter(double(instructions), benchmark::Counter::kIsRate);
+}
+
+#endif //INC_6502_PROJECT_BENCH_COUNTERS_H
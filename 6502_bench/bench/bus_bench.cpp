@@ -0,0 +1,110 @@
+#include "6502_cpu.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace MOS6502;
+
+namespace {
+    /*random addresses below limit, precomputed so the loop measures the bus and not the generator*/
+    std::vector<uint16_t> RandomAddresses(uint32_t limit) {
+        std::mt19937 random{6502};
+        std::vector<uint16_t> addresses(4096);
+        for(uint16_t& address : addresses)
+            address = random() % limit;
+        return addresses;
+    }
+}
+
+/*flat RAM_ONLY bus, Read checks the flat flag before touching RAM*/
+static void BM_BusRead(benchmark::State& state) {
+    Bus mem{};
+    mem.Initialise();
+    std::vector<uint16_t> addresses = RandomAddresses(Bus::MAX_MEM);
+
+    size_t i = 0;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(mem.Read(addresses[i]));
+        i = (i + 1) & (addresses.size() - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BusRead);
+
+static void BM_BusWrite(benchmark::State& state) {
+    Bus mem{};
+    mem.Initialise();
+    std::vector<uint16_t> addresses = RandomAddresses(Bus::MAX_MEM);
+
+    size_t i = 0;
+    for(auto _ : state){
+        mem.Write(addresses[i], uint8_t(i));
+        i = (i + 1) & (addresses.size() - 1);
+    }
+    benchmark::DoNotOptimize(mem.RAM);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BusWrite);
+
+/*view used by engines on a flat bus*/
+static void BM_FlatBusRead(benchmark::State& state) {
+    Bus mem{};
+    mem.Initialise();
+    FlatBus flat{mem};
+    std::vector<uint16_t> addresses = RandomAddresses(Bus::MAX_MEM);
+
+    size_t i = 0;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(flat.Read(addresses[i]));
+        i = (i + 1) & (addresses.size() - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FlatBusRead);
+
+static void BM_FlatBusWrite(benchmark::State& state) {
+    Bus mem{};
+    mem.Initialise();
+    FlatBus flat{mem};
+    std::vector<uint16_t> addresses = RandomAddresses(Bus::MAX_MEM);
+
+    size_t i = 0;
+    for(auto _ : state){
+        flat.Write(addresses[i], uint8_t(i));
+        i = (i + 1) & (addresses.size() - 1);
+    }
+    benchmark::DoNotOptimize(mem.RAM);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FlatBusWrite);
+
+/*NES internal RAM mirrored four times, every access goes through the memory map*/
+static void BM_MirroredRead(benchmark::State& state) {
+    Bus mem{NES};
+    mem.Initialise();
+    std::vector<uint16_t> addresses = RandomAddresses(0x2000);
+
+    size_t i = 0;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(mem.Read(addresses[i]));
+        i = (i + 1) & (addresses.size() - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MirroredRead);
+
+/*writes to mirrored pages bump generation of every mirror*/
+static void BM_MirroredWrite(benchmark::State& state) {
+    Bus mem{NES};
+    mem.Initialise();
+    std::vector<uint16_t> addresses = RandomAddresses(0x2000);
+
+    size_t i = 0;
+    for(auto _ : state){
+        mem.Write(addresses[i], uint8_t(i));
+        i = (i + 1) & (addresses.size() - 1);
+    }
+    benchmark::DoNotOptimize(mem.RAM);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MirroredWrite);
@@ -0,0 +1,281 @@
+#include "6502_cpu_instructions.h"
+#include "6502_block_cache.h"
+#include "6502_jit.h"
+#include "bench_counters.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <type_traits>
+
+using namespace MOS6502;
+
+namespace MOS6502 {
+    /*reaches addressing mode helpers and handler table of the cpu*/
+    class CPUBench {
+    public:
+        template<ADDRESSING_MODE mode, typename Memory>
+        static uint16_t GetAddress(CPU& cpu, int32_t& cycles, const Memory& memory) {
+            return cpu.GetAddress<mode, true>(cycles, memory);
+        }
+
+        static void Dispatch(CPU& cpu, int32_t& cycles, Bus& memory, uint8_t opcode) {
+            CPU::instructionsLookupTable[opcode](cpu, cycles, memory);
+        }
+    };
+}
+
+namespace {
+    //register only instructions taking 2 cycles, so the mix measures dispatch and not memory
+    const uint8_t IMPLIED_MIX[] = {INSTRUCTIONS::INS_INX, INSTRUCTIONS::INS_INY, INSTRUCTIONS::INS_DEX,
+                                   INSTRUCTIONS::INS_DEY, INSTRUCTIONS::INS_TAX, INSTRUCTIONS::INS_TXA,
+                                   INSTRUCTIONS::INS_TAY, INSTRUCTIONS::INS_TYA, INSTRUCTIONS::INS_CLC,
+                                   INSTRUCTIONS::INS_SEC, INSTRUCTIONS::INS_NOP, INSTRUCTIONS::INS_ASL_A,
+                                   INSTRUCTIONS::INS_LSR_A, INSTRUCTIONS::INS_ROL_A, INSTRUCTIONS::INS_ROR_A};
+    constexpr uint32_t MIX_LENGTH = 250;
+    constexpr uint16_t MIX_START = 0x0200;
+
+    /*MIX_LENGTH random instructions of IMPLIED_MIX followed by jmp back to the first one*/
+    void PlaceDispatchLoop(Bus& mem, CPU& cpu) {
+        std::mt19937 random{6502};
+        mem.Initialise();
+        for(uint32_t i = 0; i < MIX_LENGTH; i++)
+            mem[MIX_START + i] = IMPLIED_MIX[random() % std::size(IMPLIED_MIX)];
+        mem[MIX_START + MIX_LENGTH] = INSTRUCTIONS::INS_JMP_ABS;
+        mem[MIX_START + MIX_LENGTH + 1] = MIX_START & 0xFF;
+        mem[MIX_START + MIX_LENGTH + 2] = MIX_START >> 8;
+
+        cpu.LoadState(CPUState{MIX_START, 0xFF, 0, 0, 0, 0x20});
+    }
+
+    /*instructions in cycles of the dispatch loop, every instruction takes 2 cycles and the jmp 3*/
+    uint64_t DispatchLoopInstructions(uint64_t cycles) {
+        return cycles * (MIX_LENGTH + 1) / (2 * MIX_LENGTH + 3);
+    }
+
+    constexpr int32_t SLICE = 100000;
+
+    /*
+     * * = $8000
+     *
+     * start ldy #$00
+     * loop lda $10
+     * clc
+     * adc #$01
+     * sta $10
+     * lda $0300,y
+     * eor #$FF
+     * sta $0400,y
+     * iny
+     * bne loop
+     * jmp start
+     * */
+    const uint8_t ROM_LOOP[] = {0xA0, 0x00, 0xA5, 0x10, 0x18, 0x69, 0x01, 0x85, 0x10, 0xB9, 0x00, 0x03,
+                                0x49, 0xFF, 0x99, 0x00, 0x04, 0xC8, 0xD0, 0xEE, 0x4C, 0x00, 0x80};
+    constexpr uint16_t ROM_START = 0x8000;
+
+    /*ROM_LOOP in a read only page, so the bus is not flat and every fetch looks its page up*/
+    void PlaceROMLoop(Bus& mem, CPU& cpu, uint8_t (&rom)[Bus::PAGE_SIZE]) {
+        mem.Initialise();
+        std::copy(std::begin(ROM_LOOP), std::end(ROM_LOOP), rom);
+        mem.MapMemory(ROM_START >> 8, 1, rom, Bus::PAGE_SIZE, false);
+
+        cpu.LoadState(CPUState{ROM_START, 0xFF, 0, 0, 0, 0x20});
+    }
+
+    /*instructions in cycles of the ROM loop, 256 iterations of 9 instructions (26 cycles) with ldy and jmp take 6660 cycles*/
+    uint64_t ROMLoopInstructions(uint64_t cycles) {
+        return cycles * (256 * 9 + 2) / 6660;
+    }
+}
+
+template<ADDRESSING_MODE mode, typename Memory>
+static void BM_AddressingMode(benchmark::State& state) {
+    Bus mem{};
+    CPU cpu{};
+    //operands and pointers point into zero page and page 3, X and Y cross no page
+    for(uint32_t i = 0; i < Bus::MAX_MEM; i++)
+        mem[i] = 0x03;
+    cpu.X = 0x10;
+    cpu.Y = 0x20;
+
+    FlatBus flat{mem};
+    const Memory& memory = [&]() -> const Memory& {
+        if constexpr(std::is_same_v<Memory, Bus>)
+            return mem;
+        else
+            return flat;
+    }();
+
+    int32_t cycles = 0;
+    for(auto _ : state){
+        cpu.PC = 0x0200;
+        benchmark::DoNotOptimize(CPUBench::GetAddress<mode>(cpu, cycles, memory));
+    }
+    benchmark::DoNotOptimize(cycles);
+    state.SetItemsProcessed(state.iterations());
+}
+
+#define ADDRESSING_MODE_BENCHMARKS(MEMORY) \
+    BENCHMARK_TEMPLATE(BM_AddressingMode, ZERO_PAGE, MEMORY); \
+    BENCHMARK_TEMPLATE(BM_AddressingMode, ZERO_PAGE_X, MEMORY); \
+    BENCHMARK_TEMPLATE(BM_AddressingMode, ZERO_PAGE_Y, MEMORY); \
+    BENCHMARK_TEMPLATE(BM_AddressingMode, ABSOLUTE, MEMORY); \
+    BENCHMARK_TEMPLATE(BM_AddressingMode, ABSOLUTE_X, MEMORY); \
+    BENCHMARK_TEMPLATE(BM_AddressingMode, ABSOLUTE_Y, MEMORY); \
+    BENCHMARK_TEMPLATE(BM_AddressingMode, INDIRECT_X, MEMORY); \
+    BENCHMARK_TEMPLATE(BM_AddressingMode, INDIRECT_Y, MEMORY)
+
+ADDRESSING_MODE_BENCHMARKS(Bus);
+ADDRESSING_MODE_BENCHMARKS(FlatBus);
+
+/*single handler called through the shared table, PC is rewound so the same NOP runs again*/
+static void BM_HandlerTable(benchmark::State& state) {
+    Bus mem{};
+    CPU cpu{};
+    mem.Initialise();
+    mem[0x0200] = INSTRUCTIONS::INS_NOP;
+
+    int32_t cycles = 0;
+    for(auto _ : state){
+        cpu.PC = 0x0201;
+        CPUBench::Dispatch(cpu, cycles, mem, INSTRUCTIONS::INS_NOP);
+    }
+    benchmark::DoNotOptimize(cycles);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandlerTable);
+
+/*random mix of register instructions, one branch target per opcode*/
+static void BM_DispatchExecute(benchmark::State& state) {
+    Bus mem{};
+    CPU cpu{};
+    PlaceDispatchLoop(mem, cpu);
+
+    uint64_t cycles = 0;
+    for(auto _ : state)
+        cycles += cpu.Execute(SLICE, mem);
+    ReportThroughput(state, cycles, DispatchLoopInstructions(cycles));
+}
+BENCHMARK(BM_DispatchExecute);
+
+static void BM_DispatchThreaded(benchmark::State& state) {
+    Bus mem{};
+    CPU cpu{};
+    PlaceDispatchLoop(mem, cpu);
+
+    uint64_t cycles = 0;
+    for(auto _ : state)
+        cycles += cpu.ExecuteThreaded(SLICE, mem);
+    ReportThroughput(state, cycles, DispatchLoopInstructions(cycles));
+}
+BENCHMARK(BM_DispatchThreaded);
+
+static void BM_DispatchBlockCache(benchmark::State& state) {
+    Bus mem{};
+    CPU cpu{};
+    BlockCache cache{};
+    PlaceDispatchLoop(mem, cpu);
+
+    uint64_t cycles = 0;
+    for(auto _ : state)
+        cycles += cache.Execute(cpu, SLICE, mem);
+    ReportThroughput(state, cycles, DispatchLoopInstructions(cycles));
+}
+BENCHMARK(BM_DispatchBlockCache);
+
+/*loop of instructions taking operands, fetched from a read only page*/
+static void BM_ROMLoopExecute(benchmark::State& state) {
+    Bus mem{};
+    CPU cpu{};
+    uint8_t rom[Bus::PAGE_SIZE]{};
+    PlaceROMLoop(mem, cpu, rom);
+
+    uint64_t cycles = 0;
+    for(auto _ : state)
+        cycles += cpu.Execute(SLICE, mem);
+    ReportThroughput(state, cycles, ROMLoopInstructions(cycles));
+}
+BENCHMARK(BM_ROMLoopExecute);
+
+static void BM_ROMLoopBlockCache(benchmark::State& state) {
+    Bus mem{};
+    CPU cpu{};
+    BlockCache cache{};
+    uint8_t rom[Bus::PAGE_SIZE]{};
+    PlaceROMLoop(mem, cpu, rom);
+
+    uint64_t cycles = 0;
+    for(auto _ : state)
+        cycles += cache.Execute(cpu, SLICE, mem);
+    ReportThroughput(state, cycles, ROMLoopInstructions(cycles));
+}
+BENCHMARK(BM_ROMLoopBlockCache);
+
+static void BM_DispatchJIT(benchmark::State& state) {
+    if(!JIT::IsSupported()) {
+        state.SkipWithError("JIT is not supported on this host");
+        return;
+    }
+
+    Bus mem{};
+    CPU cpu{};
+    JIT jit{};
+    PlaceDispatchLoop(mem, cpu);
+
+    uint64_t cycles = 0;
+    for(auto _ : state)
+        cycles += jit.Execute(cpu, SLICE, mem);
+    ReportThroughput(state, cycles, DispatchLoopInstructions(cycles));
+}
+BENCHMARK(BM_DispatchJIT);
+
+static void BM_CPUReset(benchmark::State& state) {
+    Bus mem{};
+    CPU cpu{};
+    CPU::Setup(mem, 0x0400);
+
+    for(auto _ : state){
+        int32_t cycles = 7;
+        cpu.Reset(cycles, mem);
+        benchmark::DoNotOptimize(cpu.PC);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CPUReset);
+
+/*clears 64K of RAM and rebuilds the memory map*/
+static void BM_BusReset(benchmark::State& state) {
+    Bus mem{};
+
+    for(auto _ : state){
+        mem.Reset();
+        benchmark::DoNotOptimize(mem.RAM);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BusReset);
+
+static void BM_MachineFromArena(benchmark::State& state) {
+    MemoryArena arena{Bus::MAX_MEM};
+
+    for(auto _ : state){
+        arena.Reset();
+        Bus mem{arena};
+        CPU cpu{};
+        benchmark::DoNotOptimize(mem.RAM);
+        benchmark::DoNotOptimize(cpu.PC);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MachineFromArena);
+
+static void BM_MachineFromHeap(benchmark::State& state) {
+    for(auto _ : state){
+        Bus mem{};
+        CPU cpu{};
+        benchmark::DoNotOptimize(mem.RAM);
+        benchmark::DoNotOptimize(cpu.PC);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MachineFromHeap);
@@ -0,0 +1,76 @@
+#include "6502_cpu.h"
+#include "6502_profiler.h"
+#include "6502_trace.h"
+#include "ROMImage.h"
+#include "bench_counters.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <memory>
+
+using namespace MOS6502;
+
+enum class OBSERVER {
+    NONE,
+    PROFILER,
+    TRACER
+};
+
+//trace of one run is about 16 bytes per instruction, removed after each run
+const char* const TRACE_PATH = "6502_bench.trace";
+
+/*runs Klaus Dormann's functional test from the first instruction to its success loop*/
+static void BM_FunctionalTest(benchmark::State& state, const char* path, uint16_t successPC, OBSERVER observer) {
+    ROMImage image{path};
+    Bus mem{};
+    CPU cpu{};
+    Profiler profiler{};
+    if(observer == OBSERVER::PROFILER)
+        cpu.profiler = &profiler;
+
+    RunLimits limits{};
+    limits.targetPC = successPC;
+    //deadline only stops a run which hangs in a failed test
+    limits.cycles = 200'000'000;
+
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    for(auto _ : state){
+        state.PauseTiming();
+        mem.Initialise();
+        mem.Load(0x000A, image.Data(), image.Size());
+        cpu.LoadState(CPUState{0x0400, 0xFF, 0, 0, 0, 0x20});
+        std::unique_ptr<TraceRecorder> recorder;
+        if(observer == OBSERVER::TRACER)
+            recorder = std::make_unique<TraceRecorder>(TRACE_PATH);
+        cpu.tracer = recorder.get();
+        state.ResumeTiming();
+
+        RunResult result = cpu.Run(limits, mem);
+        //waiting for the writer to drain the ring buffer is part of the cost
+        if(recorder)
+            recorder->Close();
+
+        state.PauseTiming();
+        recorder.reset();
+        cpu.tracer = nullptr;
+        std::remove(TRACE_PATH);
+        state.ResumeTiming();
+        if(result.reason != STOP_REASON::TARGET_PC) {
+            state.SkipWithError("functional test did not reach its success loop");
+            return;
+        }
+        cycles += result.cycles;
+        instructions += result.instructions;
+    }
+    ReportThroughput(state, cycles, instructions);
+}
+BENCHMARK_CAPTURE(BM_FunctionalTest, binary, "bin_programs/6502_functional_test.bin", 0x336d, OBSERVER::NONE)
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FunctionalTest, decimal, "bin_programs/6502_functional_test_decimal_mode.bin", 0x3469, OBSERVER::NONE)
+        ->Unit(benchmark::kMillisecond);
+//cost of recording a profile (same as unprofiled when profiling is compiled out)
+BENCHMARK_CAPTURE(BM_FunctionalTest, binary_profiled, "bin_programs/6502_functional_test.bin", 0x336d, OBSERVER::PROFILER)
+        ->Unit(benchmark::kMillisecond);
+//cost of writing a full trace to disk
+BENCHMARK_CAPTURE(BM_FunctionalTest, binary_traced, "bin_programs/6502_functional_test.bin", 0x336d, OBSERVER::TRACER)
+        ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,85 @@
+#include "6502_cpu.h"
+#include "6502_scheduler.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace MOS6502;
+
+namespace {
+    //cpu cycles of one NTSC NES frame
+    constexpr uint64_t FRAME_CYCLES = 29780;
+}
+
+/*one frame of a nop loop with range(0) device events spread over it, 0 is the cost of the cpu alone*/
+static void BM_SchedulerFrame(benchmark::State& state) {
+    Bus mem{};
+    mem.Initialise();
+    CPU cpu{};
+    Scheduler scheduler{cpu, mem};
+    //loop nop, nop, jmp loop
+    mem[0x1000] = INS_NOP;
+    mem[0x1001] = INS_NOP;
+    mem[0x1002] = INS_JMP_ABS;
+    mem[0x1003] = 0x00;
+    mem[0x1004] = 0x10;
+    cpu.LoadState(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20});
+    //the loop is idle, it would be skipped
+    cpu.skipIdleLoops = false;
+
+    std::mt19937 random{6502};
+    std::vector<uint64_t> offsets(state.range(0));
+    for(uint64_t& offset : offsets)
+        offset = random() % FRAME_CYCLES;
+
+    uint64_t fired = 0;
+    uint64_t cycles = 0;
+    for(auto _ : state){
+        uint64_t frameStart = scheduler.Now();
+        for(uint64_t offset : offsets)
+            scheduler.ScheduleAt(frameStart + offset, [&fired](uint64_t){ fired++; });
+
+        scheduler.RunFor(FRAME_CYCLES);
+        cycles += scheduler.Now() - frameStart;
+    }
+    benchmark::DoNotOptimize(fired);
+    state.counters["emulated_Hz"] = benchmark::Counter(double(cycles), benchmark::Counter::kIsRate);
+    state.counters["events/s"] = benchmark::Counter(double(fired), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SchedulerFrame)->Arg(0)->Arg(100)->Arg(5000);
+
+/*one frame of a jmp-to-itself loop woken by an nmi every range(0) cycles, range(1) enables idle loop skipping*/
+static void BM_SchedulerIdleFrame(benchmark::State& state) {
+    Bus mem{};
+    mem.Initialise();
+    CPU cpu{};
+    Scheduler scheduler{cpu, mem};
+    //wait jmp wait
+    mem[0x1000] = INS_JMP_ABS;
+    mem[0x1001] = 0x00;
+    mem[0x1002] = 0x10;
+    //nmi handler inx, rti
+    mem[0x2000] = INS_INX;
+    mem[0x2001] = INS_RTI;
+    mem[0xFFFA] = 0x00;
+    mem[0xFFFB] = 0x20;
+    cpu.LoadState(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20});
+    cpu.skipIdleLoops = state.range(1) != 0;
+
+    uint64_t period = state.range(0);
+    uint64_t cycles = 0;
+    for(auto _ : state){
+        uint64_t frameStart = scheduler.Now();
+        for(uint64_t offset = period; offset < FRAME_CYCLES; offset += period)
+            scheduler.ScheduleAt(frameStart + offset, [&cpu](uint64_t){
+                cpu.SetNMI(true);
+                cpu.SetNMI(false);
+            });
+
+        scheduler.RunFor(FRAME_CYCLES);
+        cycles += scheduler.Now() - frameStart;
+    }
+    benchmark::DoNotOptimize(cpu.X);
+    state.counters["emulated_Hz"] = benchmark::Counter(double(cycles), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SchedulerIdleFrame)->Args({1000, 0})->Args({1000, 1})->Args({10000, 0})->Args({10000, 1});
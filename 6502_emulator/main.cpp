@@ -1,10 +1,145 @@
+#include <csignal>
 #include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <string>
+#include "6502_acia.h"
 #include "6502_cpu.h"
+#include "6502_jobs.h"
+#include "6502_scheduler.h"
+#include "ROMImage.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MOS6502_TERMINAL 1
+#include <termios.h>
+#include <unistd.h>
+#endif
 
 //https://web.archive.org/web/20210604074847/http://obelisk.me.uk/6502/
 using namespace MOS6502;
 
-int main(){
+const char* StopReasonName(STOP_REASON reason){
+    switch(reason) {
+        case STOP_REASON::CYCLES: return "cycles";
+        case STOP_REASON::INSTRUCTIONS: return "instructions";
+        case STOP_REASON::TARGET_PC: return "target";
+        case STOP_REASON::PREDICATE: return "predicate";
+        case STOP_REASON::UNKNOWN_INSTRUCTION: return "unknown instruction";
+        case STOP_REASON::STOP_REQUESTED: return "stop requested";
+    }
+    return "?";
+}
+
+/*
+ * 6502_emulator <job list> [threads]
+ * runs every job of the list (format in JobRunner::ParseJobList) and prints one line per job in the same order
+ * */
+int RunJobList(const char* path, size_t threads){
+    std::ifstream input(path);
+    if(!input) {
+        fprintf(stderr, "can not open job list %s\n", path);
+        return 1;
+    }
+
+    try {
+        std::vector<Job> jobs = JobRunner::ParseJobList(input);
+        JobRunner runner{threads};
+        std::vector<JobResult> results = runner.Run(jobs);
+
+        for(size_t i = 0; i < results.size(); i++){
+            const JobResult& result = results[i];
+            printf("%zu %s: %s after %llu cycles, %llu instructions, PC: 0x%04X A: 0x%02X X: 0x%02X Y: 0x%02X S: 0x%02X P: 0x%02X\n",
+                   i, jobs[i].romPath.c_str(), StopReasonName(result.run.reason),
+                   (unsigned long long)result.run.cycles, (unsigned long long)result.run.instructions,
+                   result.state.PC, result.state.A, result.state.X, result.state.Y, result.state.S, result.state.P);
+        }
+    } catch(const std::exception& error) {
+        fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    return 0;
+}
+
+volatile std::sig_atomic_t interrupted = 0;
+//cycles between checks for Ctrl-C and end of input
+const uint64_t CONSOLE_SLICE = 1000000;
+
+/*
+ * 6502_emulator --console <rom image> [acia page]
+ * maps the image as ROM ending at $FFFF, a 6551 ACIA at the page (hex, $50 by default) connected to stdin and stdout
+ * and runs from the reset vector at full speed until input ends, Ctrl-C or an unknown instruction
+ * */
+int RunConsole(const char* romPath, uint8_t aciaPage){
+    try {
+        ROMImage rom{romPath};
+        if(rom.Size() % Bus::PAGE_SIZE != 0 || rom.Size() > 0x10000) {
+            fprintf(stderr, "%s: console image has to be whole pages, up to 64 KiB\n", romPath);
+            return 1;
+        }
+
+        Bus mem{};
+        CPU cpu{};
+        Scheduler scheduler{cpu, mem};
+        mem.Initialise();
+        rom.MapTo(mem, uint8_t(0x100 - rom.Size() / Bus::PAGE_SIZE));
+
+#ifdef MOS6502_TERMINAL
+        signal(SIGPIPE, SIG_IGN);
+#endif
+        signal(SIGINT, [](int){ interrupted = 1; });
+
+        STOP_REASON reason = STOP_REASON::STOP_REQUESTED;
+        {
+            ACIA6551 acia{scheduler, 0, 1};
+            mem.MapDevice(aciaPage, 1, &acia);
+            acia.irqOutput = [&cpu](bool asserted){ cpu.SetIRQ(asserted); };
+
+#ifdef MOS6502_TERMINAL
+            //keys go to the program as they are typed, it echoes them itself
+            termios terminal{};
+            bool restoreTerminal = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &terminal) == 0;
+            if(restoreTerminal) {
+                termios raw = terminal;
+                raw.c_lflag &= ~(ICANON | ECHO);
+                tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+            }
+#endif
+
+            int32_t resetCycles = 7;
+            cpu.Reset(resetCycles, mem);
+
+            //after input ends the program gets one more slice to answer the last line
+            bool lastSlice = false;
+            while(!interrupted) {
+                reason = scheduler.RunFor(CONSOLE_SLICE);
+                if(reason == STOP_REASON::UNKNOWN_INSTRUCTION || lastSlice)
+                    break;
+                lastSlice = acia.InputClosed();
+            }
+
+#ifdef MOS6502_TERMINAL
+            if(restoreTerminal)
+                tcsetattr(STDIN_FILENO, TCSANOW, &terminal);
+#endif
+        }
+
+        if(reason == STOP_REASON::UNKNOWN_INSTRUCTION) {
+            fprintf(stderr, "unknown instruction at PC: 0x%04X after %llu cycles\n", cpu.PC, (unsigned long long)scheduler.Now());
+            return 1;
+        }
+    } catch(const std::exception& error) {
+        fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv){
+    if(argc > 2 && std::string(argv[1]) == "--console")
+        return RunConsole(argv[2], argc > 3 ? std::strtoul(argv[3], nullptr, 16) : 0x50);
+    if(argc > 1)
+        return RunJobList(argv[1], argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0);
 
     Bus mem{};
     CPU cpu{};
@@ -79,7 +214,8 @@ int main(){
     cpu.Reset(NUM_OF_CYCLES, mem); //7 cycles
 
     //We specify number of CPU cycles we want to execute
-    cpu.Execute(NUM_OF_CYCLES, mem);
+    if(cpu.Execute(NUM_OF_CYCLES, mem) == -1)
+        fprintf(stderr, "unknown instruction at PC: 0x%04X\n", cpu.PC);
 
     printf("X: 0x%X\n", cpu.X); //0x12
     printf("A: 0x%X\n", cpu.A); //0x15
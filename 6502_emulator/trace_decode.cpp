@@ -0,0 +1,33 @@
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include "6502_trace.h"
+
+using namespace MOS6502;
+
+/*
+ * 6502_trace_decode <trace file>
+ * prints trace written by TraceRecorder (CPU::tracer) one instruction per line
+ * */
+int main(int argc, char** argv){
+    if(argc != 2) {
+        fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if(!input) {
+        fprintf(stderr, "can not open trace %s\n", argv[1]);
+        return 1;
+    }
+
+    try {
+        std::ios::sync_with_stdio(false);
+        DecodeTrace(input, std::cout);
+    } catch(const std::exception& error) {
+        fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    return 0;
+}
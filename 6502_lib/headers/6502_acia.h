@@ -0,0 +1,133 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_ACIA_H
+#define INC_6502_PROJECT_6502_ACIA_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#include "Bus.h"
+#include "6502_scheduler.h"
+
+namespace MOS6502 {
+    /*
+     * MOS 6551 Asynchronous Communications Interface Adapter, mapped with Bus::MapDevice, its 4 registers repeat
+     * over the mapped pages. Receiver and transmitter are backed by host file descriptors (stdin/stdout, pipe, pty, socket).
+     *
+     * The cpu only touches two ring buffers. Host I/O happens in a scheduler event every pollCycles:
+     * one read of everything the host has (up to the free space) and one write of everything transmitted since,
+     * so there is never a system call per byte. Descriptors are switched to non-blocking while the ACIA owns them.
+     *
+     * Not modelled: baud rate timing (next byte is received as soon as the previous one is read), parity, framing,
+     * modem lines (DCD and DSR always read as asserted). Bytes written while the transmit buffer is full are dropped.
+     */
+    class ACIA6551 : public Device {
+    public:
+        enum REGISTER : uint8_t {
+            DATA, STATUS, COMMAND, CONTROL
+        };
+
+        enum STATUS_FLAG : uint8_t {
+            PARITY_ERROR  = 0x01,
+            FRAMING_ERROR = 0x02,
+            OVERRUN       = 0x04,
+            RX_FULL       = 0x08,
+            TX_EMPTY      = 0x10,
+            NO_DCD        = 0x20,
+            NO_DSR        = 0x40,
+            IRQ_FLAG      = 0x80
+        };
+
+        //bytes buffered in each direction, power of 2
+        static constexpr uint32_t BUFFER_SIZE = 4096;
+        //10 ms at 1 MHz
+        static constexpr uint64_t DEFAULT_POLL_CYCLES = 10000;
+
+        /*
+         * -1 leaves a direction unconnected: nothing is received, transmitted bytes are discarded.
+         * throws std::runtime_error when a descriptor can not be switched to non-blocking
+         */
+        ACIA6551(Scheduler& scheduler, int inputFd, int outputFd, uint64_t pollCycles = DEFAULT_POLL_CYCLES);
+        /*flushes transmitted bytes and gives descriptors back in their blocking mode*/
+        ~ACIA6551() override;
+
+        ACIA6551(const ACIA6551&) = delete;
+        ACIA6551& operator=(const ACIA6551&) = delete;
+
+        uint8_t Read(uint16_t address) override;
+        void Write(uint16_t address, uint8_t value) override;
+        /*registers change only in the poll event and on cpu accesses, reads with side effects left are not stable*/
+        bool ReadIsStable(uint16_t address) const override;
+
+        /*RES pin: clears command and control registers, buffered bytes are kept*/
+        void Reset();
+
+        /*one read and one write on host descriptors, called by the poll event*/
+        void Poll();
+        /*writes every buffered byte, waits while output is full*/
+        void Flush();
+
+        /*input reached end of file and the program has read every byte received before*/
+        bool InputClosed() const { return inputEnded && input.Empty() && !(status & RX_FULL); }
+
+        bool IRQ() const { return status & IRQ_FLAG; }
+        /*called when the IRQ output changes, connect it to CPU::SetIRQ (or to a wired-or of several devices)*/
+        std::function<void(bool asserted)> irqOutput{};
+
+    private:
+        /*single threaded byte queue, indices run freely and are masked on access*/
+        struct ByteRing {
+            std::array<uint8_t, BUFFER_SIZE> data{};
+            uint32_t head = 0;
+            uint32_t tail = 0;
+
+            uint32_t Size() const { return tail - head; }
+            bool Empty() const { return head == tail; }
+            bool Full() const { return Size() == BUFFER_SIZE; }
+            void Push(uint8_t value) { data[tail++ & (BUFFER_SIZE - 1)] = value; }
+            uint8_t Pop() { return data[head++ & (BUFFER_SIZE - 1)]; }
+        };
+
+        bool TerminalReady() const { return command & 0x01; }
+        bool ReceiverIRQEnabled() const { return TerminalReady() && !(command & 0x02); }
+        bool TransmitterIRQEnabled() const { return TerminalReady() && (command & 0x0C) == 0x04; }
+        bool Echo() const { return (command & 0x1C) == 0x10; }
+
+        /*moves the next buffered byte to the receive data register when it is empty*/
+        void LoadReceiver();
+        void Transmit(uint8_t value);
+        /*raises the IRQ flag, it stays set until status is read*/
+        void Interrupt();
+        void ClearInterrupt();
+
+        //return true when any byte was moved
+        bool ReadInput();
+        bool WriteOutput();
+        void SchedulePoll();
+
+        Scheduler& scheduler;
+        Scheduler::EventId event = 0;
+        uint64_t pollCycles;
+
+        int inputFd;
+        int outputFd;
+        //descriptor flags before they were made non-blocking, restored by the destructor
+        int inputFlags = -1;
+        int outputFlags = -1;
+        bool inputEnded = false;
+
+        ByteRing input{};
+        ByteRing output{};
+
+        uint8_t receiveData = 0;
+        //TX_EMPTY is not kept, it is set while the transmit buffer has room
+        uint8_t status = 0;
+        uint8_t command = 0;
+        uint8_t control = 0;
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_ACIA_H
@@ -0,0 +1,135 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_BLOCK_CACHE_H
+#define INC_6502_PROJECT_6502_BLOCK_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "6502_cpu.h"
+
+namespace MOS6502 {
+    /*
+     * Memory seen by handlers of decoded blocks.
+     * Operand bytes come from the decoded instruction instead of being fetched at PC again, data accesses go to memory.
+     */
+    template<typename Memory>
+    struct DecodedOperandBus {
+        Memory& memory;
+        //bytes following the opcode in fetch order, lowest byte first
+        mutable uint32_t operands = 0;
+
+        uint8_t Read(uint16_t address) const {
+            return memory.Read(address);
+        }
+
+        void Write(uint16_t address, uint8_t value) {
+            memory.Write(address, value);
+        }
+
+        /*called by CPU::Fetch8Bits and CPU::Fetch16Bits in place of a read at PC*/
+        uint8_t NextOperandByte() const {
+            uint8_t byte = uint8_t(operands);
+            operands >>= 8;
+            return byte;
+        }
+    };
+
+    /*
+     * Interpreter working on pre-decoded basic blocks.
+     * Block remembers handler, operand bytes and cost of every instruction, so code is fetched and decoded only once.
+     * Blocks are invalidated when a page they were decoded from is written (Bus::pageGeneration)
+     * or when host rewrote memory in bulk (Bus::hostWriteEpoch).
+     * Code on device pages is never decoded, it is interpreted one instruction at a time.
+     * Opcode pairs listed in MOS6502_FUSED_PAIRS (6502_superinstructions.h) are dispatched once for both instructions.
+     */
+    class BlockCache {
+    public:
+        BlockCache();
+
+        /* return number of cycles used, stops at the same instruction as CPU::Execute would */
+        int32_t Execute(CPU& cpu, int32_t cycles, Bus& memory);
+
+        /* drops every decoded block */
+        void Flush();
+
+    private:
+        //maximum number of instructions decoded into one block
+        static constexpr int MAX_BLOCK_INSTRUCTIONS = 32;
+
+        struct DecodedInstruction {
+            CPU::InstructionHandler handler;
+            //label of the inlined handler in threaded Execute
+            void* label;
+            //operand bytes of the instruction (of both halves of a fused pair), zero page and absolute ones are the effective address
+            uint32_t operands;
+            //address of the following instruction (after both halves of a fused pair), block is left when branch goes elsewhere
+            uint16_t nextPC;
+            //base cycles from InstructionsDataTable, page crossings and taken branches not included
+            uint8_t cycles;
+            //instruction can write memory, block has to be checked after it
+            bool writesMemory;
+            //instruction can move PC somewhere else than nextPC
+            bool branches;
+        };
+
+        struct Block {
+            //last entry is a sentinel leaving the block
+            DecodedInstruction instructions[MAX_BLOCK_INSTRUCTIONS + 1];
+            int32_t count = 0;
+            //cycles taken by the block when every page is crossed and every branch is taken
+            int32_t maxCycles = 0;
+
+            uint8_t firstPage = 0;
+            uint8_t lastPage = 0;
+            uint32_t firstPageGeneration = 0;
+            uint32_t lastPageGeneration = 0;
+            uint32_t hostWriteEpoch = 0;
+
+            bool IsValid(const Bus& memory) const {
+                return memory.hostWriteEpoch == hostWriteEpoch && IsCodeUnchanged(memory);
+            }
+
+            /*host can not write memory while the block runs, so only cpu writes are checked inside it*/
+            bool IsCodeUnchanged(const Bus& memory) const {
+                return memory.pageGeneration[firstPage] == firstPageGeneration &&
+                       memory.pageGeneration[lastPage] == lastPageGeneration;
+            }
+        };
+
+        /*label of an inlined opcode pair (superinstruction)*/
+        struct FusedLabel {
+            uint8_t first;
+            uint8_t second;
+            void* label;
+        };
+
+        /*labels of inlined handlers indexed by opcode and label leaving the block, nullptr without labels-as-values*/
+        struct Labels {
+            void* const* opcodes;
+            void* blockEnd;
+            //pairs from MOS6502_FUSED_PAIRS, decoded as one instruction
+            const FusedLabel* fused;
+            size_t fusedCount;
+        };
+
+        /*returns valid block starting at address, decodes it if needed*/
+        Block& GetBlock(uint16_t address, const Bus& memory, const Labels& labels);
+        /*decodes block starting at address*/
+        static void Decode(Block& block, uint16_t address, const Bus& memory, const Labels& labels);
+
+        /*blocks are decoded and validated on bus, instructions access memory (FlatBus when bus is flat)*/
+        template<typename Memory>
+        int32_t ExecuteOn(CPU& cpu, int32_t cycles, Bus& bus, Memory& memory);
+
+        //decoded blocks indexed by their start address
+        std::vector<std::unique_ptr<Block>> blocks;
+        //flat and mapped buses run different instantiations, blocks are flushed when the bus changes
+        bool decodedForFlatBus = false;
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_BLOCK_CACHE_H
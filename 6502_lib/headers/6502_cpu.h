@@ -6,8 +6,10 @@
 #define INC_6502_EMULATOR_6502_CPU_H
 #include <cstdint>
 #include <cstdio>
-#include <map>
+#include <array>
+#include <atomic>
 #include <functional>
+#include <optional>
 
 #include "Bus.h"
 #include "Instructions.h"
@@ -23,9 +25,76 @@
 #define HIGH_NYBBLE(a) (a >> 4)
 
 namespace MOS6502 {
+    class CPU;
+    class Profiler;
+    class TraceRecorder;
+    template<typename Memory>
+    struct TracingBus;
+
+    template<typename Memory>
+    constexpr bool isTracingBus = false;
+    template<typename Memory>
+    constexpr bool isTracingBus<TracingBus<Memory>> = true;
+    template<typename Memory>
+    struct DecodedOperandBus;
+
+    template<typename Memory>
+    constexpr bool isDecodedOperandBus = false;
+    template<typename Memory>
+    constexpr bool isDecodedOperandBus<DecodedOperandBus<Memory>> = true;
+
+    /*why CPU::Run returned*/
+    enum class STOP_REASON : uint8_t {
+        CYCLES,
+        INSTRUCTIONS,
+        TARGET_PC,
+        PREDICATE,
+        UNKNOWN_INSTRUCTION,
+        STOP_REQUESTED
+    };
+
+    /*stop conditions of CPU::Run, conditions left at their defaults are not checked*/
+    struct RunLimits {
+        //stop once at least that many cycles were used (0 - no deadline)
+        uint64_t cycles = 0;
+        //stop after that many instructions (0 - no limit)
+        uint64_t instructions = 0;
+        //stop before executing instruction at that address
+        std::optional<uint16_t> targetPC{};
+        //stop before executing next instruction when predicate returns true
+        std::function<bool(const CPU&, const Bus&)> predicate{};
+    };
+
+    struct RunResult {
+        STOP_REASON reason;
+        //cycles used, instruction which stopped the run included
+        uint64_t cycles;
+        uint64_t instructions;
+        //cycles used past RunLimits::cycles, last instruction can not be interrupted
+        uint32_t overshoot;
+    };
+
+    /*progress of CPU::ExecuteInfinite, published once per slice so other threads can compute throughput*/
+    struct ExecutionCounters {
+        std::atomic<uint64_t> cycles{0};
+        std::atomic<uint64_t> instructions{0};
+    };
+
+    /*registers of the cpu, everything needed to resume execution, memory is saved by Bus::TakeSnapshot*/
+    struct CPUState {
+        uint16_t PC;
+        uint8_t S;
+        uint8_t A;
+        uint8_t X;
+        uint8_t Y;
+        uint8_t P;
+
+        bool operator==(const CPUState&) const = default;
+    };
+
     class CPU {
     public:
-        CPU();
+        CPU() = default;
 
         /*
          * sets value of the reset vector
@@ -38,8 +107,63 @@ namespace MOS6502 {
 
         /* return number of cycles used */
         int32_t Execute(int32_t cycles, Bus& memory);
-        /* return number of cycles used */
-        void ExecuteInfinite(Bus& memory);
+        /*
+         * return number of cycles used
+         * threaded engine (computed goto), falls back to Execute on compilers without labels-as-values
+         */
+        int32_t ExecuteThreaded(int32_t cycles, Bus& memory);
+        /*
+         * runs until stop is set (from any thread) or an unknown instruction is executed
+         * stop and counters are touched once per INFINITE_RUN_SLICE cycles
+         */
+        RunResult ExecuteInfinite(Bus& memory, const std::atomic<bool>& stop, ExecutionCounters* counters = nullptr);
+        /*
+         * runs until one of the limits is reached, always stops between two instructions
+         * limits are checked before each instruction, so a run can stop without executing anything
+         */
+        RunResult Run(const RunLimits& limits, Bus& memory);
+
+        CPUState SaveState() const;
+        void LoadState(const CPUState& state);
+
+        /*
+         * Hardware interrupt inputs, set by devices (or the host) at any time, also from a bus access of a running instruction.
+         * IRQ is level triggered and masked by P.I, NMI is taken once per rising edge of its line.
+         * Execute, Run and ExecuteInfinite enter a pending interrupt between two instructions (7 cycles, vector $FFFE or $FFFA),
+         * other engines leave it pending until one of them runs. Lines are set from the thread running the cpu.
+         */
+        void SetIRQ(bool asserted);
+        void SetNMI(bool asserted);
+        bool IRQLine() const { return irqLine; }
+        bool NMIPending() const { return nmiPending; }
+
+        /*
+         * Cycles executed so far by the running Execute call, counted per memory access, 0 outside of Execute.
+         * Lets devices accessed by an instruction find the current cycle (see 6502_scheduler.h).
+         */
+        int32_t SliceElapsed() const {
+            return cycleCounter != nullptr ? sliceCycles - *cycleCounter - deferredCycles : 0;
+        }
+        /*cycles the last Execute call used before an unknown instruction made it return -1*/
+        int32_t CyclesBeforeTrap() const { return cyclesBeforeTrap; }
+        /*makes the running Execute call return once remainingCycles more cycles are used, does nothing outside of it*/
+        void ShortenSlice(int32_t remainingCycles);
+
+        /*
+         * when set, Execute and Run record every instruction in the profiler (see 6502_profiler.h)
+         * other engines do not profile, ignored when profiling is compiled out
+         */
+        Profiler* profiler = nullptr;
+        /*when set, Execute and Run push a record of every instruction to the recorder (see 6502_trace.h)*/
+        TraceRecorder* tracer = nullptr;
+        /*
+         * Execute skips idle loops: a short loop closed by a backward branch or jmp, which writes nothing,
+         * reads only fixed addresses of memory or registers of devices stable until the next event (Device::ReadIsStable)
+         * and comes back to its first instruction with the same registers twice in a row.
+         * Remaining whole iterations of the slice are charged at once, registers and cycles end as without skipping.
+         * Not done while profiling or tracing, Run and other engines never skip.
+         */
+        bool skipIdleLoops = true;
 
         /////////// REGISTERS ///////////
         uint16_t PC{}; //16-bit program counter
@@ -50,14 +174,14 @@ namespace MOS6502 {
         uint8_t X{}; //8-bit X register
         uint8_t Y{}; //8-bit Y register
 
-        const uint8_t NegativeBitFlag   = 0b10000000;
-        const uint8_t OverflowBitFlag   = 0b01000000;
-        const uint8_t UnusedBitFlag     = 0b00100000;
-        const uint8_t BreakBitFlag      = 0b00010000;
-        const uint8_t DecimalBitFlag    = 0b00001000;
-        const uint8_t InterruptBitFlag  = 0b00000100;
-        const uint8_t ZeroBitFlag       = 0b00000010;
-        const uint8_t CarryBitFlag      = 0b00000001;
+        static constexpr uint8_t NegativeBitFlag   = 0b10000000;
+        static constexpr uint8_t OverflowBitFlag   = 0b01000000;
+        static constexpr uint8_t UnusedBitFlag     = 0b00100000;
+        static constexpr uint8_t BreakBitFlag      = 0b00010000;
+        static constexpr uint8_t DecimalBitFlag    = 0b00001000;
+        static constexpr uint8_t InterruptBitFlag  = 0b00000100;
+        static constexpr uint8_t ZeroBitFlag       = 0b00000010;
+        static constexpr uint8_t CarryBitFlag      = 0b00000001;
 
         union {
             struct {
@@ -78,6 +202,15 @@ namespace MOS6502 {
 
 
     private:
+        //translated code runs on registers of the cpu and falls back to its handlers
+        friend class JIT;
+        //decoded blocks call handlers of the cpu directly
+        friend class BlockCache;
+        //lanes run instructions without a vector implementation on handlers of the cpu
+        friend class CPULanes;
+        //microbenchmarks of addressing modes and handlers (6502_bench)
+        friend class CPUBench;
+
         enum class LOGICAL_OPERATION {
             AND,
             XOR,
@@ -97,80 +230,252 @@ namespace MOS6502 {
         };
 
         /*return 8-bit zero-page address*/
-        uint8_t getZeroPageAddress(int32_t& cycles, const Bus &memory);
+        template<typename Memory>
+        uint8_t getZeroPageAddress(int32_t& cycles, const Memory& memory);
         /*return 8-bit zero-page address with an X offset*/
-        uint8_t getZeroPageAddressX(int32_t& cycles, const Bus& memory);
+        template<typename Memory>
+        uint8_t getZeroPageAddressX(int32_t& cycles, const Memory& memory);
         /*return 8-bit zero-page address with an Y offset*/
-        uint8_t getZeroPageAddressY(int32_t& cycles, const Bus& memory);
+        template<typename Memory>
+        uint8_t getZeroPageAddressY(int32_t& cycles, const Memory& memory);
         /*return 16-bit absolute address*/
-        uint16_t getAbsoluteAddress(int32_t& cycles, const Bus& memory);
+        template<typename Memory>
+        uint16_t getAbsoluteAddress(int32_t& cycles, const Memory& memory);
         /*return 16-bit absolute address with an X offset*/
-        uint16_t getAbsoluteAddressX(int32_t& cycles, const Bus& memory, bool checkPageCrossing);
+        template<typename Memory>
+        uint16_t getAbsoluteAddressX(int32_t& cycles, const Memory& memory, bool checkPageCrossing);
         /*return 16-bit absolute address with an Y offset*/
-        uint16_t getAbsoluteAddressY(int32_t& cycles, const Bus& memory, bool checkPageCrossing);
+        template<typename Memory>
+        uint16_t getAbsoluteAddressY(int32_t& cycles, const Memory& memory, bool checkPageCrossing);
         /*return 16-bit address (address = memory[16-bit value + X]) */
-        uint16_t getIndirectIndexedAddressX(int32_t& cycles, const Bus& memory);
+        template<typename Memory>
+        uint16_t getIndirectIndexedAddressX(int32_t& cycles, const Memory& memory);
         /*return 16-bit address (address = memory[8-bit value] + X) */
-        uint16_t getIndexedIndirectAddressY(int32_t& cycles, const Bus& memory, bool checkPageCrossing);
+        template<typename Memory>
+        uint16_t getIndexedIndirectAddressY(int32_t& cycles, const Memory& memory, bool checkPageCrossing);
 
-        /* Fetches 8-bits (1 byte) from memory (changes program counter)*/
-        uint16_t Fetch8Bits(int32_t& cycles, const Bus& memory);
+        /* Fetches 8-bits (1 byte) from memory (changes program counter), DecodedOperandBus hands out its decoded bytes instead*/
+        template<typename Memory>
+        uint16_t Fetch8Bits(int32_t& cycles, const Memory& memory);
         /* Fetches 16-bits (2 bytes) from memory (changes program counter)*/
-        uint16_t Fetch16Bits(int32_t& cycles, const Bus& memory);
+        template<typename Memory>
+        uint16_t Fetch16Bits(int32_t& cycles, const Memory& memory);
 
         /* Reads 8-bits (1 byte) from memory from address*/
-        static uint8_t Read8Bits(int32_t& cycles, const Bus& memory, uint16_t address);
+        template<typename Memory>
+        static uint8_t Read8Bits(int32_t& cycles, const Memory& memory, uint16_t address);
         /* Reads 16-bits (2 bytes) from memory from address (little endian)*/
-        static uint16_t Read16Bits(int32_t& cycles, const Bus& memory, uint16_t address);
+        template<typename Memory>
+        static uint16_t Read16Bits(int32_t& cycles, const Memory& memory, uint16_t address);
 
         /*Writes 16 bits (2 bytes) to an address with little endian convention*/
-        static void Write8Bits(int32_t &cycles, Bus &memory, uint16_t address, uint8_t value);
+        template<typename Memory>
+        static void Write8Bits(int32_t &cycles, Memory& memory, uint16_t address, uint8_t value);
         /*Writes 16 bits (2 bytes) to an address with little endian convention*/
-        static void Write16Bits(int32_t &cycles, Bus &memory, uint16_t address, uint16_t value);
+        template<typename Memory>
+        static void Write16Bits(int32_t &cycles, Memory& memory, uint16_t address, uint16_t value);
 
         /*push 8-bit value on the stack | 1 cycle*/
-        void StackPush8Bits(int32_t& cycles, Bus& memory, uint8_t value);
+        template<typename Memory>
+        void StackPush8Bits(int32_t& cycles, Memory& memory, uint8_t value);
         /*push 16-bit value on the stack | 2 cycle*/
-        void StackPush16Bits(int32_t& cycles, Bus& memory, uint16_t value);
+        template<typename Memory>
+        void StackPush16Bits(int32_t& cycles, Memory& memory, uint16_t value);
 
         /*pop 8-bit value from the stack*/
-        uint8_t StackPop8Bits(int32_t& cycles, Bus& memory);
+        template<typename Memory>
+        uint8_t StackPop8Bits(int32_t& cycles, Memory& memory);
         /*pop 16-bit value from the stack*/
-        uint16_t StackPop16Bits(int32_t& cycles, Bus& memory);
+        template<typename Memory>
+        uint16_t StackPop16Bits(int32_t& cycles, Memory& memory);
 
         /*Sets N and Z flags of processor status after loading a register*/
         void SetStatusNZ(uint8_t& reg);
 
+        /*Builds N, Z, C and V bits of P from lazy flags, called when leaving Execute*/
+        void StoreLazyFlags();
+        /*Loads lazy flags from N, Z, C and V bits of P, called when entering Execute and after P is pulled*/
+        void LoadLazyFlags();
+        /*Returns P with N, Z, C and V built from lazy flags, used when status is pushed*/
+        uint8_t GetStatus() const;
+
+        bool FlagN() const { return (flagResult & 0x0180) != 0; }
+        bool FlagZ() const { return (flagResult & 0x00FF) == 0; }
+        bool FlagC() const { return flagCarry != 0; }
+        bool FlagV() const { return flagOverflow != 0; }
+
         /*returns address basing on addressing mode*/
-        uint16_t GetAddress(ADDRESSING_MODE mode, int32_t& cycles, const Bus& memory, bool checkPageCrossing);
+        template<ADDRESSING_MODE mode, bool checkPageCrossing, typename Memory>
+        uint16_t GetAddress(int32_t& cycles, const Memory& memory);
 
         /*Performs logical operation on accumulator*/
-        void PerformLogicalOnAccumulator(ADDRESSING_MODE mode, LOGICAL_OPERATION operation, int32_t& cycles, Bus& memory);
+        template<ADDRESSING_MODE mode, LOGICAL_OPERATION operation, typename Memory>
+        void PerformLogicalOnAccumulator(int32_t& cycles, Memory& memory);
         /*Increments and Decrements memory location*/
-        void IncrementDecrementValue(ADDRESSING_MODE mode, MATH_OPERATION operation, int32_t& cycles, Bus& memory);
+        template<ADDRESSING_MODE mode, MATH_OPERATION operation, typename Memory>
+        void IncrementDecrementValue(int32_t& cycles, Memory& memory);
         /*Performs Add and Subtract On Accumulator*/
-        void PerformAddSubtractOnAccumulator(ADDRESSING_MODE mode, MATH_OPERATION operation, int32_t& cycles, Bus& memory);
+        template<ADDRESSING_MODE mode, MATH_OPERATION operation, typename Memory>
+        void PerformAddSubtractOnAccumulator(int32_t& cycles, Memory& memory);
         /*Loads register with specified addressing mode*/
-        void LoadRegister(ADDRESSING_MODE mode, int32_t& cycles, const Bus& memory, uint8_t& reg);
+        template<ADDRESSING_MODE mode, uint8_t CPU::* reg, typename Memory>
+        void LoadRegister(int32_t& cycles, const Memory& memory);
         /*Stores register in specified address in memory*/
-        void StoreRegister(ADDRESSING_MODE mode, int32_t& cycles, Bus& memory, uint8_t& reg);
+        template<ADDRESSING_MODE mode, uint8_t CPU::* reg, typename Memory>
+        void StoreRegister(int32_t& cycles, Memory& memory);
         /*Branches if given flag is in expected state*/
-        void BranchIf(int32_t &cycles, MOS6502::Bus &memory, bool flag, bool expectedState);
+        template<typename Memory>
+        void BranchIf(int32_t &cycles, Memory& memory, bool flag, bool expectedState);
         /*Compares memory value to register*/
-        void CompareWithRegister(ADDRESSING_MODE mode, int32_t& cycles, Bus& memory, uint8_t& reg);
+        template<ADDRESSING_MODE mode, uint8_t CPU::* reg, typename Memory>
+        void CompareWithRegister(int32_t& cycles, Memory& memory);
         /*Shifts value*/
-        void ShiftValue(ADDRESSING_MODE mode, MATH_OPERATION operation, int32_t& cycles, Bus& memory);
+        template<ADDRESSING_MODE mode, MATH_OPERATION operation, typename Memory>
+        void ShiftValue(int32_t& cycles, Memory& memory);
+
+        /*Handles single instruction, called after opcode was fetched*/
+        template<typename Memory>
+        using Handler = void (*)(CPU& cpu, int32_t& cycles, Memory& memory);
+        using InstructionHandler = Handler<Bus>;
+
+        /*Handler specialized for one opcode, addressing mode and operation are taken from InstructionsDataTable*/
+        template<uint8_t opcode, typename Memory = Bus>
+        static void Instruction(CPU& cpu, int32_t& cycles, Memory& memory);
 
         /*Fills lookup table array with instructions*/
-        void fillInstructionsLookupTable();
+        template<typename Memory>
+        static constexpr std::array<Handler<Memory>, 256> fillInstructionsLookupTable();
+        /*Returns lookup table with handlers working on given memory type*/
+        template<typename Memory>
+        static const std::array<Handler<Memory>, 256>& LookupTable();
+        /*Trap for opcodes that are not implemented, stops execution*/
+        template<typename Memory>
+        static void UnknownInstruction(CPU& cpu, int32_t& cycles, Memory& memory);
         /*Finds instruction in instructionDataTable*/
-        static instruction findInstructionInDataTable(INSTRUCTIONS opcode);
+        static constexpr instruction findInstructionInDataTable(INSTRUCTIONS opcode);
+        /*Checks if opcode is described in instructionDataTable*/
+        static constexpr bool isInstructionInDataTable(uint8_t opcode);
+
+        //cycles executed by ExecuteInfinite between checks of the stop flag
+        static constexpr int32_t INFINITE_RUN_SLICE = 1 << 16;
+        //longest loop, in bytes, checked for being idle
+        static constexpr int32_t IDLE_LOOP_BYTES = 16;
+        //idleBranch of no loop, outside of the address space
+        static constexpr uint32_t NO_IDLE_LOOP = 0x10000;
 
         /*stack index 0, stack pointer is added to that index*/
         uint16_t stackLocation = 0x0100;
 
-        //lookup table for instructions and their functions
-        std::map<INSTRUCTIONS, std::function<void(int32_t&, Bus&)>> instructionsLookupTable;
+        /*
+         * Lazy flags, P holds N, Z, C and V only outside of Execute.
+         * Z is set when low byte of flagResult is 0, N when bit 7 or bit 8 is set (BIT keeps bit 7 of operand in bit 8).
+         */
+        uint16_t flagResult = 0;
+        //carry as 0 or 1
+        uint8_t flagCarry = 0;
+        //overflow as 0 or 1
+        uint8_t flagOverflow = 0;
+
+        /*set by UnknownInstruction trap, makes Execute return -1*/
+        bool unknownInstructionTrapped = false;
+        //cycles left in the slice when the trap zeroed the counter
+        int32_t cyclesLeftAtTrap = 0;
+        int32_t cyclesBeforeTrap = 0;
+
+        /////////// INTERRUPTS ///////////
+        bool irqLine = false;
+        bool nmiLine = false;
+        bool nmiPending = false;
+        //interrupt may have to be entered before the next instruction
+        bool interruptPoll = false;
+        //CLI and PLP unmask IRQ one instruction late, used by Run (Execute gets the delay from the cycle counter)
+        bool interruptPollDelayed = false;
+        /*
+         * Cycle counter of the running Execute loop. Interrupt request moves its remaining cycles to deferredCycles,
+         * the loop stops on its usual cycles > 0 check and gives them back after entering the interrupt
+         */
+        int32_t* cycleCounter = nullptr;
+        int32_t deferredCycles = 0;
+        /*points cycleCounter at the counter of a running loop, cleared also when a device throws out of the loop*/
+        struct CycleCounterScope {
+            CPU& cpu;
+
+            CycleCounterScope(CPU& owner, int32_t& cycles) : cpu(owner) {
+                cpu.cycleCounter = &cycles;
+            }
+
+            ~CycleCounterScope() {
+                cpu.cycleCounter = nullptr;
+                cpu.deferredCycles = 0;
+                cpu.idleSkipping = false;
+            }
+        };
+        //cycles given to the running Execute call, lowered by ShortenSlice
+        int32_t sliceCycles = 0;
+
+        /////////// IDLE LOOPS ///////////
+        //set by ExecuteOn when skipIdleLoops is set and nothing observes single instructions
+        bool idleSkipping = false;
+        //address of the branch closing the loop being watched, NO_IDLE_LOOP when none
+        uint32_t idleBranch = NO_IDLE_LOOP;
+        //loop was found to write or to read something which can change, it is not checked again
+        bool idleRejected = false;
+        //registers and cycle counter the last time the loop got back to its first instruction
+        uint64_t idleRegisters = 0;
+        uint8_t idleStatus = 0;
+        int32_t idleCycles = 0;
+
+        /*
+         * called by a taken branch or jmp at address branch jumping at most IDLE_LOOP_BYTES back, PC is the loop start.
+         * Skips whole iterations once the loop is found to be idle.
+         */
+        template<typename Memory>
+        void IdleBranch(int32_t& cycles, const Memory& memory, uint16_t branch);
+        /*true when instructions from start up to the one at branch can not change anything but registers*/
+        template<typename Memory>
+        static bool IsIdleLoop(const Memory& memory, uint16_t start, uint16_t branch);
+        //loop is watched again from scratch, its iterations have to be measured anew
+        void ForgetIdleLoop() { idleBranch = NO_IDLE_LOOP; }
+
+        /*makes the running loop stop before the next instruction, or after it when delayed*/
+        void RequestInterruptPoll(bool delayed);
+        /*called by CLI, PLP and RTI once P.I is pulled down*/
+        void InterruptsUnmasked(bool delayed) {
+            if(irqLine && !P.I)
+                RequestInterruptPoll(delayed);
+        }
+        /*enters NMI or an unmasked IRQ, if one is pending | 7 cycles, returns the vector or 0 when nothing was entered*/
+        template<typename Memory>
+        uint16_t EnterInterrupt(int32_t& cycles, Memory& memory);
+        /*EnterInterrupt reported to the tracer and the profiler like an instruction*/
+        template<typename Memory, bool profiled>
+        void EnterInterruptRecorded(int32_t& cycles, Memory& memory);
+
+        //lookup table for instructions and their functions, indexed by opcode and shared by all cpus
+        static const std::array<InstructionHandler, 256> instructionsLookupTable;
+        //same handlers accessing memory through FlatBus
+        static const std::array<Handler<FlatBus>, 256> flatInstructionsLookupTable;
+        //same handlers recording memory writes for the tracer
+        static const std::array<Handler<TracingBus<Bus>>, 256> tracingInstructionsLookupTable;
+        static const std::array<Handler<TracingBus<FlatBus>>, 256> flatTracingInstructionsLookupTable;
+
+        /*
+         * Engines are instantiated for Bus and for FlatBus,
+         * public entry points pick FlatBus when the bus is flat, so its checks are not repeated on every access
+         */
+        template<typename Memory, bool profiled = false>
+        int32_t ExecuteOn(int32_t cycles, Memory& memory);
+        template<typename Memory>
+        int32_t ExecuteThreadedOn(int32_t cycles, Memory& memory);
+        template<typename Memory, bool profiled = false>
+        RunResult RunOn(const RunLimits& limits, const Bus& bus, Memory& memory);
+        template<typename Memory>
+        RunResult ExecuteInfiniteOn(Memory& memory, const std::atomic<bool>& stop, ExecutionCounters* counters);
+        /*ExecuteOn and RunOn on a TracingBus, profiled as well when the profiler is set*/
+        template<typename Memory>
+        int32_t ExecuteTraced(int32_t cycles, Memory& memory);
+        template<typename Memory>
+        RunResult RunTraced(const RunLimits& limits, const Bus& bus, Memory& memory);
     };
 }
 
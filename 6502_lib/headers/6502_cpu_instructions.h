@@ -0,0 +1,661 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_CPU_INSTRUCTIONS_H
+#define INC_6502_PROJECT_6502_CPU_INSTRUCTIONS_H
+
+#include <stdexcept>
+#include <type_traits>
+#include "6502_cpu.h"
+
+/*
+ * Inline helpers and per-opcode handler templates of the cpu.
+ * Included by every execution engine, so each handler can be instantiated and inlined at its dispatch point.
+ */
+
+//expands X for every opcode 0x##high##0 - 0x##high##F
+#define OPCODE_ROW(high, X) \
+    X(0x##high##0) X(0x##high##1) X(0x##high##2) X(0x##high##3) \
+    X(0x##high##4) X(0x##high##5) X(0x##high##6) X(0x##high##7) \
+    X(0x##high##8) X(0x##high##9) X(0x##high##A) X(0x##high##B) \
+    X(0x##high##C) X(0x##high##D) X(0x##high##E) X(0x##high##F)
+
+//expands X for every opcode 0x00 - 0xFF
+#define FOR_EACH_OPCODE(X) \
+    OPCODE_ROW(0, X) OPCODE_ROW(1, X) OPCODE_ROW(2, X) OPCODE_ROW(3, X) \
+    OPCODE_ROW(4, X) OPCODE_ROW(5, X) OPCODE_ROW(6, X) OPCODE_ROW(7, X) \
+    OPCODE_ROW(8, X) OPCODE_ROW(9, X) OPCODE_ROW(A, X) OPCODE_ROW(B, X) \
+    OPCODE_ROW(C, X) OPCODE_ROW(D, X) OPCODE_ROW(E, X) OPCODE_ROW(F, X)
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::Fetch8Bits(int32_t& cycles, const Memory& memory){
+    uint8_t byte;
+    if constexpr (isDecodedOperandBus<Memory>)
+        byte = memory.NextOperandByte();
+    else
+        byte = memory.Read(PC);
+    PC++;
+    cycles--;
+    return byte;
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::Fetch16Bits(int32_t& cycles, const Memory& memory){
+    uint8_t lowByte;
+    uint8_t highByte;
+    if constexpr (isDecodedOperandBus<Memory>) {
+        lowByte = memory.NextOperandByte();
+        highByte = memory.NextOperandByte();
+    } else {
+        lowByte = memory.Read(PC);
+        highByte = memory.Read(PC + 1);
+    }
+    PC += 2;
+
+    cycles -= 2;
+
+    uint16_t result = lowByte;
+    result |= (highByte << 8);
+
+    return result;
+}
+
+template<typename Memory>
+inline uint8_t MOS6502::CPU::Read8Bits(int32_t& cycles, const Memory& memory, uint16_t address){
+    uint8_t byte = memory.Read(address);
+    cycles--;
+    return byte;
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::Read16Bits(int32_t& cycles, const Memory& memory, uint16_t address){
+    uint8_t lowByte = memory.Read(address);
+    uint8_t highByte = memory.Read(address + 1);
+
+    cycles -= 2;
+
+    uint16_t result = lowByte;
+    result |= (highByte << 8);
+
+    return result;
+}
+
+template<typename Memory>
+inline void MOS6502::CPU::Write8Bits(int32_t& cycles, Memory& memory, uint16_t address, uint8_t value){
+    memory.Write(address, value);
+    cycles--;
+}
+
+template<typename Memory>
+inline void MOS6502::CPU::Write16Bits(int32_t& cycles, Memory& memory, uint16_t address, uint16_t value){
+    memory.Write(address, value & 0xFF);
+    memory.Write(address + 1, value >> 8);
+    cycles -= 2;
+}
+
+template<typename Memory>
+inline void MOS6502::CPU::StackPush8Bits(int32_t &cycles, Memory& memory, uint8_t value) {
+    Write8Bits(cycles, memory, stackLocation + S, value);
+    S -= 1;
+}
+
+template<typename Memory>
+inline void MOS6502::CPU::StackPush16Bits(int32_t &cycles, Memory& memory, uint16_t value) {
+    Write16Bits(cycles, memory, stackLocation + S - 1, value);
+    S -= 2;
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::EnterInterrupt(int32_t& cycles, Memory& memory) {
+    interruptPoll = false;
+    interruptPollDelayed = false;
+
+    uint16_t vector;
+    if(nmiPending) {
+        nmiPending = false;
+        vector = 0xFFFA;
+    }
+    else if(irqLine && !P.I)
+        vector = 0xFFFE;
+    else
+        return 0;
+
+    //same sequence as BRK without the opcode fetch, pushed P has B cleared
+    StackPush16Bits(cycles, memory, PC);
+    StackPush8Bits(cycles, memory, (GetStatus() | UnusedBitFlag) & ~BreakBitFlag);
+    P.I = true;
+    PC = Read16Bits(cycles, memory, vector);
+    cycles -= 2;
+    return vector;
+}
+
+template<typename Memory>
+inline uint8_t MOS6502::CPU::StackPop8Bits(int32_t &cycles, Memory& memory) {
+    S += 1;
+    uint8_t value = Read8Bits(cycles, memory, stackLocation + S);
+    return value;
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::StackPop16Bits(int32_t &cycles, Memory& memory) {
+    S += 2;
+    uint16_t value = Read16Bits(cycles, memory, stackLocation + S - 1);
+    return value;
+}
+
+template<typename Memory>
+inline uint8_t MOS6502::CPU::getZeroPageAddress(int32_t& cycles, const Memory& memory){
+    return Fetch8Bits(cycles, memory);
+}
+
+template<typename Memory>
+inline uint8_t MOS6502::CPU::getZeroPageAddressX(int32_t &cycles, const Memory& memory) {
+    cycles--; // add X register to address
+    return getZeroPageAddress(cycles, memory) + X;
+}
+
+template<typename Memory>
+inline uint8_t MOS6502::CPU::getZeroPageAddressY(int32_t &cycles, const Memory& memory) {
+    cycles--; // add Y register to address
+    return getZeroPageAddress(cycles, memory) + Y;
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::getAbsoluteAddress(int32_t& cycles, const Memory& memory){
+    return Fetch16Bits(cycles, memory);
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::getAbsoluteAddressX(int32_t& cycles, const Memory& memory, bool checkPageCrossing){
+    uint16_t absoluteAddress = getAbsoluteAddress(cycles, memory);
+    if(checkPageCrossing &&(absoluteAddress & 0xFF) + X > 0xFF)
+        cycles--; // page crossed
+    return absoluteAddress + X;
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::getAbsoluteAddressY(int32_t& cycles, const Memory& memory, bool checkPageCrossing){
+    uint16_t absoluteAddress = getAbsoluteAddress(cycles, memory);
+    if(checkPageCrossing &&(absoluteAddress & 0xFF) + Y > 0xFF)
+        cycles--; // page crossed
+    return absoluteAddress + Y;
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::getIndirectIndexedAddressX(int32_t &cycles, const Memory& memory) {
+    cycles--; // add X register to address
+    return Read16Bits(cycles, memory, uint8_t(getZeroPageAddress(cycles, memory) + X));
+}
+
+template<typename Memory>
+inline uint16_t MOS6502::CPU::getIndexedIndirectAddressY(int32_t &cycles, const Memory& memory, bool checkPageCrossing) {
+    uint16_t targetAddress = Read16Bits(cycles, memory, Fetch8Bits(cycles, memory));
+    if(checkPageCrossing && (targetAddress & 0xFF) + Y >= 0xFF)
+        cycles--; //page crossed
+    return targetAddress + Y;
+}
+
+inline void MOS6502::CPU::SetStatusNZ(uint8_t& reg){
+    flagResult = reg;
+}
+
+inline void MOS6502::CPU::StoreLazyFlags() {
+    P.N = FlagN();
+    P.Z = FlagZ();
+    P.C = FlagC();
+    P.V = FlagV();
+}
+
+inline void MOS6502::CPU::LoadLazyFlags() {
+    flagResult = (P.Z ? 0x0000 : 0x0001) | (P.N ? 0x0100 : 0x0000);
+    flagCarry = P.C;
+    flagOverflow = P.V;
+}
+
+inline uint8_t MOS6502::CPU::GetStatus() const {
+    //no compares or branches, the tracer builds P before every instruction
+    uint8_t status = P.PS & ~(NegativeBitFlag | OverflowBitFlag | ZeroBitFlag | CarryBitFlag);
+    status |= (flagResult | flagResult >> 1) & NegativeBitFlag;
+    status |= flagOverflow << 6;
+    status |= ((flagResult & 0x00FF) == 0) << 1;
+    status |= flagCarry;
+    return status;
+}
+
+template<MOS6502::ADDRESSING_MODE mode, bool checkPageCrossing, typename Memory>
+inline uint16_t MOS6502::CPU::GetAddress(int32_t& cycles, const Memory& memory){
+    if constexpr (mode == ZERO_PAGE)
+        return getZeroPageAddress(cycles, memory);
+    else if constexpr (mode == ZERO_PAGE_X)
+        return getZeroPageAddressX(cycles, memory);
+    else if constexpr (mode == ZERO_PAGE_Y)
+        return getZeroPageAddressY(cycles, memory);
+    else if constexpr (mode == ABSOLUTE)
+        return getAbsoluteAddress(cycles, memory);
+    else if constexpr (mode == ABSOLUTE_X)
+        return getAbsoluteAddressX(cycles, memory, checkPageCrossing);
+    else if constexpr (mode == ABSOLUTE_Y)
+        return getAbsoluteAddressY(cycles, memory, checkPageCrossing);
+    else if constexpr (mode == INDIRECT_X)
+        return getIndirectIndexedAddressX(cycles, memory);
+    else if constexpr (mode == INDIRECT_Y)
+        return getIndexedIndirectAddressY(cycles, memory, checkPageCrossing);
+    else
+        static_assert(mode == ZERO_PAGE, "Unhandled load addressing mode");
+}
+
+template<MOS6502::ADDRESSING_MODE mode, uint8_t MOS6502::CPU::* reg, typename Memory>
+inline void MOS6502::CPU::LoadRegister(int32_t& cycles, const Memory& memory){
+    if constexpr (mode == IMMEDIATE)
+        this->*reg = Fetch8Bits(cycles, memory);
+    else
+        this->*reg = Read8Bits(cycles, memory, GetAddress<mode, true>(cycles, memory));
+    SetStatusNZ(this->*reg);
+}
+
+template<MOS6502::ADDRESSING_MODE mode, uint8_t MOS6502::CPU::* reg, typename Memory>
+inline void MOS6502::CPU::StoreRegister(int32_t &cycles, Memory& memory) {
+    Write8Bits(cycles, memory, GetAddress<mode, false>(cycles, memory), this->*reg);
+    if constexpr (mode == ABSOLUTE_X || mode == ABSOLUTE_Y || mode == INDIRECT_Y)
+        cycles--;
+}
+
+template<MOS6502::ADDRESSING_MODE mode, MOS6502::CPU::LOGICAL_OPERATION operation, typename Memory>
+inline void MOS6502::CPU::PerformLogicalOnAccumulator(int32_t &cycles, Memory& memory) {
+    uint8_t value;
+    if constexpr (mode == IMMEDIATE)
+        value = Fetch8Bits(cycles, memory);
+    else
+        value = Read8Bits(cycles, memory, GetAddress<mode, true>(cycles, memory));
+
+    if constexpr (operation == LOGICAL_OPERATION::AND) {
+        A = (A & value);
+        SetStatusNZ(A);
+    } else if constexpr (operation == LOGICAL_OPERATION::XOR) {
+        A = (A ^ value);
+        SetStatusNZ(A);
+    } else if constexpr (operation == LOGICAL_OPERATION::OR) {
+        A = (A | value);
+        SetStatusNZ(A);
+    } else if constexpr (operation == LOGICAL_OPERATION::BIT) {
+        flagResult = (A & value) | ((value & NegativeBitFlag) << 1);
+        flagOverflow = (value & OverflowBitFlag) != 0;
+    } else
+        static_assert(operation == LOGICAL_OPERATION::AND, "Unhandled operation");
+}
+
+template<MOS6502::ADDRESSING_MODE mode, MOS6502::CPU::MATH_OPERATION operation, typename Memory>
+inline void MOS6502::CPU::IncrementDecrementValue(int32_t &cycles, Memory& memory) {
+    static_assert(operation == MATH_OPERATION::INCREMENT || operation == MATH_OPERATION::DECREMENT,
+                  "INVALID MATH OPERATION FOR THIS METHOD");
+
+    if constexpr (mode == IMPLIED_X || mode == IMPLIED_Y) {
+        uint8_t& reg = (mode == IMPLIED_X) ? X : Y;
+        if constexpr (operation == MATH_OPERATION::INCREMENT)
+            reg++;
+        else
+            reg--;
+        cycles--;
+        SetStatusNZ(reg);
+    } else {
+        uint16_t address = GetAddress<mode, false>(cycles, memory);
+        uint8_t value = Read8Bits(cycles, memory, address);
+        if constexpr (operation == MATH_OPERATION::INCREMENT)
+            value++;
+        else
+            value--;
+
+        cycles--;
+        if constexpr (mode == ABSOLUTE_X)
+            cycles--;
+        Write8Bits(cycles, memory, address, value);
+        SetStatusNZ(value);
+    }
+}
+
+//A - A register, M - operand, R - result, 0,1 - most significant bit of each component
+// A  M  R | V | A^R | A^M |~(A^M) |
+// 0  0  0 | 0 |  0  |  0  |   1   |
+// 0  0  1 | 1 |  1  |  0  |   1   |
+// 0  1  0 | 0 |  0  |  1  |   0   |
+// 0  1  1 | 0 |  1  |  1  |   0   |  so V = ~(A^M) & (A^R)
+// 1  0  0 | 0 |  1  |  1  |   0   |
+// 1  0  1 | 0 |  0  |  1  |   0   |
+// 1  1  0 | 1 |  1  |  0  |   1   |
+// 1  1  1 | 0 |  0  |  0  |   1   |
+
+template<MOS6502::ADDRESSING_MODE mode, MOS6502::CPU::MATH_OPERATION operation, typename Memory>
+inline void MOS6502::CPU::PerformAddSubtractOnAccumulator(int32_t &cycles, Memory& memory) {
+    static_assert(operation == MATH_OPERATION::ADD || operation == MATH_OPERATION::SUBTRACT,
+                  "INVALID MATH OPERATION FOR THIS METHOD");
+
+    uint16_t operand;
+    if constexpr (mode == IMMEDIATE)
+        operand = Fetch8Bits(cycles, memory);
+    else
+        operand = Read8Bits(cycles, memory, GetAddress<mode, true>(cycles, memory));
+
+    uint16_t result;
+
+    if (P.D == 1) {
+        int m = 1;
+
+        if constexpr (operation == MATH_OPERATION::SUBTRACT) {
+            m = -1;
+            flagCarry = !flagCarry;
+        }
+
+        uint8_t accumulatorLow = LOW_NYBBLE(A) + LOW_NYBBLE(operand)*m + flagCarry*m;
+        uint8_t accumulatorHigh = HIGH_NYBBLE(A) + HIGH_NYBBLE(operand)*m;
+
+        if(accumulatorLow > 9) {
+            accumulatorLow += 6 * m;
+            accumulatorLow &= 0xF;
+            accumulatorHigh += 1*m;
+        }
+
+        if constexpr (operation == MATH_OPERATION::ADD)
+            flagCarry = 0;
+        else
+            flagCarry = 1;
+
+        if(accumulatorHigh > 9) {
+            accumulatorHigh += 6 * m;
+            accumulatorHigh &= 0xF;
+            if constexpr (operation == MATH_OPERATION::ADD)
+                flagCarry = 1;
+            else
+                flagCarry = 0;
+        }
+
+        result = (accumulatorHigh << 4) + LOW_NYBBLE(accumulatorLow);
+    } else {
+        if constexpr (operation == MATH_OPERATION::SUBTRACT)
+            operand = operand ^ 0x00FF;
+
+        result = A + operand + flagCarry;
+        flagCarry = (result & 0xFF00) > 0;
+    }
+
+    flagOverflow = ((!(MSB(A)^MSB(operand))) & (MSB(A)^MSB(uint8_t(result))));
+    A = (result & 0xFF);
+    SetStatusNZ(A);
+}
+
+template<typename Memory>
+inline void MOS6502::CPU::BranchIf(int32_t &cycles, Memory& memory, bool flag, bool expectedState) {
+    auto offset = static_cast<int8_t>(Fetch8Bits(cycles, memory));
+
+    if(flag == expectedState){
+        cycles--;
+        if((PC >> 8) != ((PC + offset) >> 8))
+            cycles--; // page crossed
+        PC += offset;
+
+        //decoded blocks never skip idle loops
+        if constexpr(!isTracingBus<Memory> && !isDecodedOperandBus<Memory>) {
+            if(idleSkipping && offset < 0 && offset >= -IDLE_LOOP_BYTES) [[unlikely]]
+                IdleBranch(cycles, memory, uint16_t(PC - offset - 2));
+        }
+    }
+    //loop left through its closing branch, iterations are counted from scratch when it is entered again
+    else if(uint16_t(PC - 2) == idleBranch) [[unlikely]]
+        ForgetIdleLoop();
+}
+
+template<MOS6502::ADDRESSING_MODE mode, uint8_t MOS6502::CPU::* reg, typename Memory>
+inline void MOS6502::CPU::CompareWithRegister(int32_t &cycles, Memory& memory) {
+    uint8_t operand;
+    if constexpr (mode == IMMEDIATE)
+        operand = Fetch8Bits(cycles, memory);
+    else
+        operand = Read8Bits(cycles, memory, GetAddress<mode, true>(cycles, memory));
+
+    //result is zero only when register equals operand
+    flagResult = uint8_t(this->*reg - operand);
+    flagCarry = (this->*reg >= operand);
+}
+
+template<MOS6502::ADDRESSING_MODE mode, MOS6502::CPU::MATH_OPERATION operation, typename Memory>
+inline void MOS6502::CPU::ShiftValue(int32_t &cycles, Memory& memory) {
+    uint8_t operand;
+    uint16_t address = 0;
+
+    if constexpr (mode == ACCUMULATOR)
+        operand = A;
+    else {
+        address = GetAddress<mode, false>(cycles, memory);
+        operand = Read8Bits(cycles, memory, address);
+    }
+
+    if constexpr (operation == MATH_OPERATION::SHIFT_LEFT || operation == MATH_OPERATION::ROTATE_LEFT){
+        bool temp = (operand & NegativeBitFlag) > 0;
+        operand = operand << 1;
+
+        if constexpr (operation == MATH_OPERATION::ROTATE_LEFT)
+            operand += flagCarry;
+
+        flagCarry = temp;
+    } else if constexpr (operation == MATH_OPERATION::SHIFT_RIGHT || operation == MATH_OPERATION::ROTATE_RIGHT){
+        bool temp = (operand & CarryBitFlag) > 0;
+        operand = operand >> 1;
+
+        if constexpr (operation == MATH_OPERATION::ROTATE_RIGHT)
+            operand |= uint8_t(flagCarry << 7);
+
+        flagCarry = temp;
+    } else
+        static_assert(operation == MATH_OPERATION::SHIFT_LEFT, "INVALID MATH OPERATION FOR THIS METHOD");
+
+    cycles--;
+    SetStatusNZ(operand);
+
+    if constexpr (mode == ABSOLUTE_X)
+        cycles--;
+
+    if constexpr (mode == ACCUMULATOR)
+        A = operand;
+    else
+        Write8Bits(cycles, memory, address, operand);
+}
+
+constexpr MOS6502::instruction MOS6502::CPU::findInstructionInDataTable(MOS6502::INSTRUCTIONS opcode) {
+    for(const instruction& ins : InstructionsDataTable){
+        if(ins.opcode == opcode)
+            return ins;
+    }
+    throw std::runtime_error("INVALID INSTRUCTION");
+}
+
+constexpr bool MOS6502::CPU::isInstructionInDataTable(uint8_t opcode) {
+    for(const instruction& ins : InstructionsDataTable){
+        if(ins.opcode == opcode)
+            return true;
+    }
+    return false;
+}
+
+template<typename Memory>
+inline void MOS6502::CPU::UnknownInstruction(CPU& cpu, int32_t& cycles, Memory&) {
+    //reported by the caller through the -1 returned by Execute, handlers can run on many threads at once
+    cpu.unknownInstructionTrapped = true;
+    cpu.cyclesLeftAtTrap = cycles;
+    cycles = 0;
+}
+
+template<uint8_t opcode, typename Memory>
+inline void MOS6502::CPU::Instruction(CPU& cpu, int32_t& cycles, Memory& memory) {
+    if constexpr (!isInstructionInDataTable(opcode)) {
+        UnknownInstruction(cpu, cycles, memory);
+    } else {
+        constexpr instruction ins = findInstructionInDataTable(INSTRUCTIONS(opcode));
+        constexpr ADDRESSING_MODE mode = ins.addressingMode;
+        constexpr const char* name = ins.name;
+
+        /////////////////////////////////// LOAD REGISTERS INSTRUCTIONS IMPLEMENTATION ///////////////////////////////////////
+        if constexpr (IsSameMnemonic(name, "LDA"))
+            cpu.LoadRegister<mode, &CPU::A>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "LDX"))
+            cpu.LoadRegister<mode, &CPU::X>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "LDY"))
+            cpu.LoadRegister<mode, &CPU::Y>(cycles, memory);
+
+        /////////////////////////////////// STORE REGISTERS INSTRUCTIONS IMPLEMENTATION ///////////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "STA"))
+            cpu.StoreRegister<mode, &CPU::A>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "STX"))
+            cpu.StoreRegister<mode, &CPU::X>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "STY"))
+            cpu.StoreRegister<mode, &CPU::Y>(cycles, memory);
+
+        /////////////////////////////////// TRANSFER REGISTERS INSTRUCTIONS IMPLEMENTATION ///////////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "TAX")) { cpu.X = cpu.A; cpu.SetStatusNZ(cpu.X); cycles--; }
+        else if constexpr (IsSameMnemonic(name, "TXA")) { cpu.A = cpu.X; cpu.SetStatusNZ(cpu.A); cycles--; }
+        else if constexpr (IsSameMnemonic(name, "TAY")) { cpu.Y = cpu.A; cpu.SetStatusNZ(cpu.Y); cycles--; }
+        else if constexpr (IsSameMnemonic(name, "TYA")) { cpu.A = cpu.Y; cpu.SetStatusNZ(cpu.A); cycles--; }
+        else if constexpr (IsSameMnemonic(name, "TSX")) { cpu.X = cpu.S; cpu.SetStatusNZ(cpu.X); cycles--; }
+        else if constexpr (IsSameMnemonic(name, "TXS")) { cpu.S = cpu.X; cycles--; }
+
+        /////////////////////////////////// STACK OPERATIONS INSTRUCTIONS IMPLEMENTATION ///////////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "PHA")) { cpu.StackPush8Bits(cycles, memory, cpu.A); cycles--; }
+        else if constexpr (IsSameMnemonic(name, "PHP")) { cpu.StackPush8Bits(cycles, memory, cpu.GetStatus() | cpu.UnusedBitFlag | cpu.BreakBitFlag); cycles--; }
+        else if constexpr (IsSameMnemonic(name, "PLA")) { cpu.A = cpu.StackPop8Bits(cycles, memory); cycles -= 2; cpu.SetStatusNZ(cpu.A); }
+        else if constexpr (IsSameMnemonic(name, "PLP")) {
+            uint8_t stackPS = cpu.StackPop8Bits(cycles, memory);
+            stackPS &= ~(cpu.UnusedBitFlag | cpu.BreakBitFlag);
+            cpu.P.PS &= (cpu.UnusedBitFlag | cpu.BreakBitFlag);
+            cpu.P.PS |= stackPS;
+            cpu.LoadLazyFlags();
+            cycles -= 2;
+            cpu.InterruptsUnmasked(true);
+        }
+
+        /////////////////////////////////// LOGICAL OPERATIONS INSTRUCTIONS IMPLEMENTATION ///////////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "AND"))
+            cpu.PerformLogicalOnAccumulator<mode, LOGICAL_OPERATION::AND>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "ORA"))
+            cpu.PerformLogicalOnAccumulator<mode, LOGICAL_OPERATION::OR>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "EOR"))
+            cpu.PerformLogicalOnAccumulator<mode, LOGICAL_OPERATION::XOR>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "BIT"))
+            cpu.PerformLogicalOnAccumulator<mode, LOGICAL_OPERATION::BIT>(cycles, memory);
+
+        ////////////////////////////////// JUMP INSTRUCTION IMPLEMENTATION //////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "JSR")) {
+            uint16_t absoluteAddress = cpu.Fetch16Bits(cycles, memory);
+            cpu.StackPush16Bits(cycles, memory, cpu.PC - 1);
+            cpu.PC = absoluteAddress;
+            cycles--;
+        }
+        else if constexpr (IsSameMnemonic(name, "RTS")) { cpu.PC = cpu.StackPop16Bits(cycles, memory) + 1; cycles -= 3; }
+        else if constexpr (IsSameMnemonic(name, "JMP") && mode == ABSOLUTE) {
+            //opcode is already fetched
+            uint16_t jump = uint16_t(cpu.PC - 1);
+            cpu.PC = cpu.getAbsoluteAddress(cycles, memory);
+
+            //jmp at most IDLE_LOOP_BYTES back closes a loop like a branch
+            if constexpr(!isTracingBus<Memory> && !isDecodedOperandBus<Memory>) {
+                if(cpu.idleSkipping && cpu.PC <= jump && jump + 3 - cpu.PC <= IDLE_LOOP_BYTES) [[unlikely]]
+                    cpu.IdleBranch(cycles, memory, jump);
+            }
+        }
+        else if constexpr (IsSameMnemonic(name, "JMP") && mode == INDIRECT) {
+            uint16_t lsb = cpu.Fetch8Bits(cycles, memory);
+            uint16_t msb = cpu.Fetch8Bits(cycles, memory);
+
+            uint16_t address = (msb << 8) | lsb;
+
+            if (lsb == 0x00FF)
+                cpu.PC = cpu.Read8Bits(cycles,memory, address & 0xFF00 << 8) | cpu.Read8Bits(cycles, memory, address);
+            else
+                cpu.PC = cpu.Read16Bits(cycles, memory, address);
+        }
+
+        ////////////////////////////////// INCREMENT INSTRUCTION IMPLEMENTATION //////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "INX") || IsSameMnemonic(name, "INY") || IsSameMnemonic(name, "INC"))
+            cpu.IncrementDecrementValue<mode, MATH_OPERATION::INCREMENT>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "DEX") || IsSameMnemonic(name, "DEY") || IsSameMnemonic(name, "DEC"))
+            cpu.IncrementDecrementValue<mode, MATH_OPERATION::DECREMENT>(cycles, memory);
+
+        ////////////////////////////////// BRANCH INSTRUCTIONS IMPLEMENTATION //////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "BEQ")) cpu.BranchIf(cycles, memory, cpu.FlagZ(), true);
+        else if constexpr (IsSameMnemonic(name, "BNE")) cpu.BranchIf(cycles, memory, cpu.FlagZ(), false);
+        else if constexpr (IsSameMnemonic(name, "BMI")) cpu.BranchIf(cycles, memory, cpu.FlagN(), true);
+        else if constexpr (IsSameMnemonic(name, "BPL")) cpu.BranchIf(cycles, memory, cpu.FlagN(), false);
+        else if constexpr (IsSameMnemonic(name, "BCS")) cpu.BranchIf(cycles, memory, cpu.FlagC(), true);
+        else if constexpr (IsSameMnemonic(name, "BCC")) cpu.BranchIf(cycles, memory, cpu.FlagC(), false);
+        else if constexpr (IsSameMnemonic(name, "BVS")) cpu.BranchIf(cycles, memory, cpu.FlagV(), true);
+        else if constexpr (IsSameMnemonic(name, "BVC")) cpu.BranchIf(cycles, memory, cpu.FlagV(), false);
+
+        ////////////////////////////////// SET/CLEAR FLAGS INSTRUCTIONS IMPLEMENTATION //////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "CLC")) { cpu.flagCarry = 0; cycles--; }
+        else if constexpr (IsSameMnemonic(name, "SEC")) { cpu.flagCarry = 1; cycles--; }
+        else if constexpr (IsSameMnemonic(name, "CLD")) { cpu.P.D = 0; cycles--; }
+        else if constexpr (IsSameMnemonic(name, "SED")) { cpu.P.D = 1; cycles--; }
+        else if constexpr (IsSameMnemonic(name, "CLI")) { cpu.P.I = 0; cycles--; cpu.InterruptsUnmasked(true); }
+        else if constexpr (IsSameMnemonic(name, "SEI")) { cpu.P.I = 1; cycles--; }
+        else if constexpr (IsSameMnemonic(name, "CLV")) { cpu.flagOverflow = 0; cycles--; }
+
+        ////////////////////////////////// ADD/SUBTRACT WITH CARRY INSTRUCTIONS IMPLEMENTATION //////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "ADC"))
+            cpu.PerformAddSubtractOnAccumulator<mode, MATH_OPERATION::ADD>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "SBC"))
+            cpu.PerformAddSubtractOnAccumulator<mode, MATH_OPERATION::SUBTRACT>(cycles, memory);
+
+        ////////////////////////////////// COMPARE INSTRUCTIONS IMPLEMENTATION //////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "CMP"))
+            cpu.CompareWithRegister<mode, &CPU::A>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "CPX"))
+            cpu.CompareWithRegister<mode, &CPU::X>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "CPY"))
+            cpu.CompareWithRegister<mode, &CPU::Y>(cycles, memory);
+
+        ////////////////////////////////// SHIFT AND ROTATE INSTRUCTIONS IMPLEMENTATION //////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "ASL"))
+            cpu.ShiftValue<mode, MATH_OPERATION::SHIFT_LEFT>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "LSR"))
+            cpu.ShiftValue<mode, MATH_OPERATION::SHIFT_RIGHT>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "ROL"))
+            cpu.ShiftValue<mode, MATH_OPERATION::ROTATE_LEFT>(cycles, memory);
+        else if constexpr (IsSameMnemonic(name, "ROR"))
+            cpu.ShiftValue<mode, MATH_OPERATION::ROTATE_RIGHT>(cycles, memory);
+
+        ////////////////////////////////// SYSTEM FUNCTIONS INSTRUCTIONS IMPLEMENTATION //////////////////////////////////
+        else if constexpr (IsSameMnemonic(name, "BRK")) {
+            cpu.PC++;
+            cpu.StackPush16Bits(cycles, memory, cpu.PC);
+            cpu.StackPush8Bits(cycles, memory, cpu.GetStatus() | cpu.UnusedBitFlag | cpu.BreakBitFlag);
+            cpu.PC = cpu.Read16Bits(cycles, memory, 0xFFFE);
+            cpu.P.I = true;
+            cycles--;
+        }
+        else if constexpr (IsSameMnemonic(name, "NOP")) { cycles--; }
+        else if constexpr (IsSameMnemonic(name, "RTI")) {
+            uint8_t stackPS = cpu.StackPop8Bits(cycles, memory);
+            stackPS &= ~(cpu.UnusedBitFlag | cpu.BreakBitFlag);
+            cpu.P.PS &= (cpu.UnusedBitFlag | cpu.BreakBitFlag);
+            cpu.P.PS |= stackPS;
+            cpu.LoadLazyFlags();
+            cpu.PC = cpu.StackPop16Bits(cycles, memory);
+            cycles -= 2;
+            cpu.InterruptsUnmasked(false);
+        }
+        else
+            static_assert(opcode != opcode, "Instruction from InstructionsDataTable has no implementation");
+    }
+}
+
+template<typename Memory>
+inline const std::array<MOS6502::CPU::Handler<Memory>, 256>& MOS6502::CPU::LookupTable() {
+    if constexpr (std::is_same_v<Memory, FlatBus>)
+        return flatInstructionsLookupTable;
+    else if constexpr (std::is_same_v<Memory, TracingBus<Bus>>)
+        return tracingInstructionsLookupTable;
+    else if constexpr (std::is_same_v<Memory, TracingBus<FlatBus>>)
+        return flatTracingInstructionsLookupTable;
+    else
+        return instructionsLookupTable;
+}
+
+#endif //INC_6502_PROJECT_6502_CPU_INSTRUCTIONS_H
@@ -0,0 +1,99 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_JIT_H
+#define INC_6502_PROJECT_6502_JIT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+
+#include "6502_cpu.h"
+
+namespace MOS6502 {
+    /*
+     * Translates basic blocks of 6502 code into x86-64 code and runs them.
+     * Instructions which can not be translated are executed by the interpreter of the cpu.
+     * On hosts other than x86-64 Linux and on buses which are not a single flat RAM every instruction is interpreted.
+     */
+    class JIT {
+    public:
+        JIT();
+        ~JIT();
+
+        JIT(const JIT&) = delete;
+        JIT& operator=(const JIT&) = delete;
+
+        /* return number of cycles used, stops at the same instruction as CPU::Execute would */
+        int32_t Execute(CPU& cpu, int32_t cycles, Bus& memory);
+
+        /* drops every translated block */
+        void Flush();
+
+        /* true if translated code can be executed on this host */
+        static bool IsSupported();
+
+        /////////// STATE SHARED WITH TRANSLATED CODE ///////////
+        struct State {
+            uint8_t* RAM;
+            //Bus::pageGeneration, bumped by every store
+            uint32_t* pageGeneration;
+            int32_t cycles;
+            uint32_t PC;
+            uint32_t A;
+            uint32_t X;
+            uint32_t Y;
+            uint32_t S;
+            uint32_t P;
+            //set when block stops before an instruction it can not execute
+            uint32_t bail;
+        };
+        /////////// STATE SHARED WITH TRANSLATED CODE ///////////
+
+    private:
+        using BlockFunction = void (*)(State* state);
+
+        struct Block {
+            //nullptr when first instruction of the block has to be interpreted
+            BlockFunction code = nullptr;
+            //6502 code the block was translated from, compared with memory only when its pages were written
+            std::vector<uint8_t> source;
+
+            uint8_t firstPage = 0;
+            uint8_t lastPage = 0;
+            uint32_t firstPageGeneration = 0;
+            uint32_t lastPageGeneration = 0;
+            uint32_t hostWriteEpoch = 0;
+
+            /*same check as BlockCache, nothing was written to pages of the block since it was validated*/
+            bool IsUnwritten(const Bus& memory) const {
+                return memory.hostWriteEpoch == hostWriteEpoch &&
+                       memory.pageGeneration[firstPage] == firstPageGeneration &&
+                       memory.pageGeneration[lastPage] == lastPageGeneration;
+            }
+
+            /*remembers generations of pages holding the source*/
+            void Validated(const Bus& memory) {
+                firstPageGeneration = memory.pageGeneration[firstPage];
+                lastPageGeneration = memory.pageGeneration[lastPage];
+                hostWriteEpoch = memory.hostWriteEpoch;
+            }
+        };
+
+        /*returns valid block starting at address, translates it if needed, nullptr if address can not start a block*/
+        Block* GetBlock(uint16_t address, const Bus& memory);
+        /*copies code to executable memory, returns nullptr if cache is full or its pages can not be protected*/
+        BlockFunction Commit(const std::vector<uint8_t>& code);
+
+        /*memory for translated blocks, read and execute only, pages are writable only while Commit copies a block*/
+        uint8_t* codeCache = nullptr;
+        size_t codeCacheUsed = 0;
+
+        //translated blocks indexed by their start address
+        std::vector<std::unique_ptr<Block>> blocks;
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_JIT_H
@@ -0,0 +1,78 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_JOBS_H
+#define INC_6502_PROJECT_6502_JOBS_H
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "6502_cpu.h"
+#include "ROMImage.h"
+
+namespace MOS6502 {
+    /*program run on a fresh machine: image copied to RAM at loadAddress, cpu started from state*/
+    struct Job {
+        std::string romPath;
+        uint16_t loadAddress = 0;
+        CPUState state{0x0000, 0xFF, 0x00, 0x00, 0x00, 0x20};
+        RunLimits limits{};
+    };
+
+    struct JobResult {
+        RunResult run;
+        //registers when the job stopped
+        CPUState state;
+    };
+
+    /*
+     * Runs independent jobs on a pool of worker threads.
+     * Every worker owns a Bus and a CPU allocated once and reused for each of its jobs, images are loaded once per path.
+     * Jobs are dealt to workers in contiguous ranges, a worker which ran out of jobs steals from the back of another queue.
+     */
+    class JobRunner {
+    public:
+        /*0 threads - one for each hardware thread*/
+        explicit JobRunner(size_t threadCount = 0);
+
+        size_t ThreadCount() const { return workers.size(); }
+
+        /*
+         * runs every job and returns results in order of jobs, blocks until all of them stop
+         * throws std::runtime_error when an image can not be opened, before any job is run
+         */
+        std::vector<JobResult> Run(const std::vector<Job>& jobs);
+
+        /*
+         * Parses job list, one job per line, '#' starts a comment:
+         *   <image path> pc=<address> [load=<address>] [a= x= y= s= p=<value>] [cycles=<n>] [instructions=<n>] [target=<address>]
+         * numbers are decimal or hex with 0x or $ prefix, image paths can not contain spaces.
+         * Every job needs cycles or instructions, target only stops it earlier.
+         * Throws std::invalid_argument naming the line when it can not be parsed or the job has neither limit.
+         */
+        static std::vector<Job> ParseJobList(std::istream& input);
+
+    private:
+        struct Worker {
+            Bus bus{};
+            CPU cpu{};
+            std::mutex lock{};
+            //indices of jobs, owner pops from the front, thieves from the back
+            std::deque<size_t> queue{};
+        };
+
+        void Work(size_t self, const std::vector<Job>& jobs, const std::vector<const ROMImage*>& images,
+                  std::vector<JobResult>& results);
+        bool NextJob(size_t self, size_t& job);
+
+        std::vector<std::unique_ptr<Worker>> workers{};
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_JOBS_H
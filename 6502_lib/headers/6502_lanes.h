@@ -0,0 +1,86 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_LANES_H
+#define INC_6502_PROJECT_6502_LANES_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "6502_cpu.h"
+
+namespace MOS6502 {
+    /*
+     * Runs up to MAX_LANES independent cpus in lockstep, registers are kept as arrays indexed by lane (structure of arrays).
+     * Every step lanes sitting on the same opcode as the first running lane execute it together,
+     * other lanes are masked off and wait for a later step.
+     * Register and immediate instructions run as fixed width loops over all lanes which compilers turn into SIMD code,
+     * instructions accessing memory and decimal mode arithmetic run lane by lane on the handlers of the cpu.
+     * Every lane needs its own bus, results are the same as running each cpu alone with CPU::Execute.
+     */
+    class CPULanes {
+    public:
+        static constexpr size_t MAX_LANES = 32;
+
+        /*adds lane starting from state and running on memory, throws std::length_error when every lane is taken*/
+        size_t AddLane(const CPUState& state, Bus& memory);
+        /*removes every lane*/
+        void Clear();
+
+        size_t LaneCount() const { return laneCount; }
+        CPUState GetState(size_t lane) const;
+
+        /*runs every lane for cycles like CPU::Execute*/
+        void Execute(int32_t cycles);
+        /*cycles used by lane in the last Execute, -1 when it hit an unknown instruction*/
+        int32_t CyclesUsed(size_t lane) const;
+
+        //instructions executed for whole groups of lanes at once and for single lanes
+        uint64_t vectorInstructions = 0;
+        uint64_t scalarInstructions = 0;
+
+    private:
+        /////////// LANE REGISTERS ///////////
+        alignas(64) uint16_t PC[MAX_LANES]{};
+        alignas(64) uint8_t A[MAX_LANES]{};
+        alignas(64) uint8_t X[MAX_LANES]{};
+        alignas(64) uint8_t Y[MAX_LANES]{};
+        alignas(64) uint8_t S[MAX_LANES]{};
+        alignas(64) uint8_t P[MAX_LANES]{};
+        /////////// LANE REGISTERS ///////////
+
+        alignas(64) int32_t cyclesLeft[MAX_LANES]{};
+        //0xFF for lanes executing current instruction, 0x00 for masked off lanes
+        alignas(64) uint8_t mask[MAX_LANES]{};
+        //operand of immediate and relative instructions
+        alignas(64) uint8_t operand[MAX_LANES]{};
+        alignas(64) uint8_t opcode[MAX_LANES]{};
+
+        Bus* memory[MAX_LANES]{};
+        bool trapped[MAX_LANES]{};
+        int32_t budget = 0;
+        size_t laneCount = 0;
+
+        //runs instructions of single lanes
+        CPU scalar{};
+
+        /*executes opcode on lanes in group, returns false when it has no vector implementation*/
+        bool ExecuteVector(uint8_t opcode, uint32_t group);
+        void ExecuteScalar(size_t lane);
+
+        void FetchOperands(uint32_t group);
+        /*advances PC by bytes and takes cycles from every lane in mask*/
+        void Retire(uint8_t bytes, uint8_t cycles);
+
+        void Load(uint8_t* reg, const uint8_t* value);
+        void SetFlags(uint8_t flags, bool set);
+        void SetNZ(const uint8_t* value);
+        void Logical(uint8_t opcode);
+        void AddWithCarry(bool subtract);
+        void Compare(const uint8_t* reg);
+        void Branch(uint8_t flag, bool expectedState);
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_LANES_H
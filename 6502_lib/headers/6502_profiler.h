@@ -0,0 +1,129 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_PROFILER_H
+#define INC_6502_PROJECT_6502_PROFILER_H
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "Instructions.h"
+
+/*
+ * Profiling support is chosen at build time: cmake -DMOS6502_PROFILER=OFF compiles it out,
+ * CPU::profiler is then ignored and Execute does not even check it.
+ */
+#ifndef MOS6502_PROFILER
+#define MOS6502_PROFILER 1
+#endif
+
+namespace MOS6502 {
+    /*
+     * Cycles spent by a guest program, recorded by CPU::Execute and CPU::Run while CPU::profiler points at it.
+     * Without a profiler those engines run their usual loop, the pointer is checked once per call.
+     * Calls are followed through JSR/BRK and RTS/RTI, cycles of an instruction go to the function executing it.
+     * Interrupt entry is a call of its handler, its 7 cycles are charged to the handler.
+     */
+    class Profiler {
+    public:
+        /*
+         * calls nested deeper are counted in the deepest function, programs leaving subroutines without RTS stay bounded.
+         * Returns from those calls are matched first, so the stack is right again once they are all back.
+         */
+        static constexpr uint32_t MAX_DEPTH = 256;
+
+        Profiler();
+
+        /*called by the cpu after every instruction, pc and opcode of the instruction and PC after it*/
+        void Record(uint16_t pc, uint8_t opcode, uint32_t cycles, uint16_t nextPC) {
+            opcodeCount[opcode]++;
+            opcodeCycles[opcode] += cycles;
+            pcCycles[pc] += cycles;
+
+            //penalties are the cycles above the base cycles of the opcode, unknown opcodes have none
+            uint32_t extra = baseCycles[opcode] != 0 && cycles > baseCycles[opcode] ? cycles - baseCycles[opcode] : 0;
+            if(isBranch[opcode]) {
+                //taken branch costs one cycle, branch to the next instruction is taken too
+                bool taken = extra != 0;
+                branchesTaken += taken;
+                branchesNotTaken += !taken;
+                extra -= taken;
+            }
+            pageCrossings += extra;
+
+            nodes[current].cycles += cycles;
+            if(opcode == INS_JSR || opcode == INS_BRK)
+                Call(nextPC);
+            else if(opcode == INS_RTS || opcode == INS_RTI)
+                Return();
+        }
+
+        /*called by the cpu after entering an interrupt, vector it was read from, handler address and cycles of the entry*/
+        void Interrupt(uint16_t vector, uint16_t handler, uint32_t cycles) {
+            irqs += vector == 0xFFFE;
+            nmis += vector == 0xFFFA;
+            interruptCycles += cycles;
+
+            Call(handler);
+            nodes[current].cycles += cycles;
+        }
+
+        void Clear();
+
+        /*opcode table and hottest addresses sorted by cycles, with page crossing and branch counters*/
+        void WriteFlatProfile(std::ostream& output, size_t addressCount = 32) const;
+        /*
+         * one line per call stack: "root;$8000;$8123 <cycles>", the format read by flamegraph.pl
+         * functions are named by their entry address
+         */
+        void WriteCollapsedStacks(std::ostream& output) const;
+
+        //indexed by opcode (INSTRUCTIONS)
+        std::array<uint64_t, 256> opcodeCount{};
+        std::array<uint64_t, 256> opcodeCycles{};
+        //cycles of instructions starting at each address
+        std::vector<uint64_t> pcCycles;
+
+        uint64_t pageCrossings = 0;
+        uint64_t branchesTaken = 0;
+        uint64_t branchesNotTaken = 0;
+        //interrupts entered and cycles of their entry sequences, not counted in the opcode tables
+        uint64_t irqs = 0;
+        uint64_t nmis = 0;
+        uint64_t interruptCycles = 0;
+
+    private:
+        struct Node {
+            uint16_t address;
+            uint32_t parent;
+            uint32_t depth;
+            //cycles spent in the function itself, callees excluded
+            uint64_t cycles;
+        };
+
+        void Call(uint16_t target);
+        void Return() {
+            if(overflowDepth != 0)
+                overflowDepth--;
+            else if(current != 0)
+                current = nodes[current].parent;
+        }
+
+        //node 0 is the code running when profiling started
+        std::vector<Node> nodes;
+        //child of a node calling target, indexed by (node << 16) | target
+        std::unordered_map<uint64_t, uint32_t> children{};
+        uint32_t current = 0;
+        //calls past MAX_DEPTH which have not returned yet
+        uint32_t overflowDepth = 0;
+
+        static const std::array<uint8_t, 256> baseCycles;
+        static const std::array<bool, 256> isBranch;
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_PROFILER_H
@@ -0,0 +1,80 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_REWIND_H
+#define INC_6502_PROJECT_6502_REWIND_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "6502_cpu.h"
+
+namespace MOS6502 {
+    /*
+     * Ring buffer of cpu registers and Bus::RAM captured every captureInterval cycles.
+     * Only the newest frame keeps a full copy of RAM, every frame stores XOR of its RAM with the previous frame,
+     * run length encoded, so stepping back applies deltas from the newest frame down to the one restored.
+     * Oldest frames are dropped when the buffer uses more than memoryCap bytes.
+     * Emulated time in seconds is cycles divided by clock rate (1.789773 MHz on NTSC NES).
+     */
+    class RewindBuffer {
+    public:
+        RewindBuffer(uint64_t captureInterval, size_t memoryCap);
+
+        /*runs cpu for cycles (or until an unknown instruction), capturing a frame on every interval boundary*/
+        RunResult Run(CPU& cpu, Bus& bus, uint64_t cycles);
+
+        /*captures frame at the current cycle, frames can be captured by hand between runs*/
+        void Capture(const CPU& cpu, const Bus& bus);
+
+        /*
+         * restores newest frame at least cycles older than the current cycle (oldest frame when there is none)
+         * frames newer than the restored one are dropped, returns cycle of the restored frame
+         */
+        uint64_t StepBack(uint64_t cycles, CPU& cpu, Bus& bus);
+
+        /*drops every frame, next run starts a new timeline at cycle 0*/
+        void Clear();
+
+        //cycles run through this buffer, rewound by StepBack
+        uint64_t Now() const { return now; }
+        size_t FrameCount() const { return frames.size(); }
+        uint64_t OldestCycle() const { return frames.empty() ? now : frames.front().cycle; }
+        //frames and full copy of the newest RAM
+        size_t MemoryUsed() const { return memoryUsed; }
+
+    private:
+        struct Frame {
+            uint64_t cycle;
+            CPUState cpu;
+            //turns RAM of this frame into RAM of the previous frame (and back), empty for the oldest frame
+            std::vector<uint8_t> delta;
+        };
+
+        //equal bytes ending a literal run, shorter runs cost more than their header
+        static constexpr uint32_t MIN_EQUAL_RUN = 4;
+        static constexpr uint32_t MAX_RUN = 0xFFFF;
+
+        /*appends runs of [skip: u16][count: u16][count bytes of from ^ to]*/
+        static void EncodeDelta(const uint8_t* from, const uint8_t* to, uint32_t size, std::vector<uint8_t>& out);
+        static void ApplyDelta(uint8_t* memory, const std::vector<uint8_t>& delta);
+
+        void DropOldFrames();
+
+        uint64_t captureInterval;
+        size_t memoryCap;
+
+        uint64_t now = 0;
+        uint64_t nextCapture = 0;
+        size_t memoryUsed = 0;
+
+        std::deque<Frame> frames{};
+        //RAM of the newest frame
+        std::vector<uint8_t> newest{};
+        std::vector<uint8_t> scratch{};
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_REWIND_H
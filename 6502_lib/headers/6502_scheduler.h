@@ -0,0 +1,102 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_SCHEDULER_H
+#define INC_6502_PROJECT_6502_SCHEDULER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "6502_cpu.h"
+
+namespace MOS6502 {
+    /*
+     * Runs a cpu together with devices of its bus, time is counted in absolute cpu cycles from 0.
+     * Devices are not ticked every cycle: they schedule an event for the next cycle something happens on their own
+     * (timer underflow, byte received, ...) and catch up to Now() when the cpu reads or writes their registers.
+     * Between two events the cpu runs uninterrupted in a single CPU::Execute call.
+     *
+     * Events are kept in a binary min-heap, insert and removal of the earliest event are O(log n).
+     * Cancelled events are removed lazily, the heap is compacted when they outnumber pending ones.
+     * Events at the same cycle fire in the order they were scheduled.
+     */
+    class Scheduler {
+    public:
+        /*called with the cycle the event was scheduled for, Now() may be a few cycles later (end of an instruction)*/
+        using Callback = std::function<void(uint64_t cycle)>;
+        //0 is never returned by Schedule
+        using EventId = uint64_t;
+
+        //longest single Execute call, events further away are reached in several slices
+        static constexpr int32_t MAX_SLICE = 1 << 20;
+        //heaps this small are not compacted, cancelled events leave them soon enough
+        static constexpr size_t COMPACT_THRESHOLD = 64;
+
+        Scheduler(CPU& cpu, Bus& bus) : cpu(cpu), bus(bus) {}
+
+        /*
+         * current cycle, also in the middle of an instruction (counted per memory access),
+         * used by devices catching up when their registers are accessed
+         */
+        uint64_t Now() const { return now + cpu.SliceElapsed(); }
+
+        /*event at an absolute cycle, cycle in the past fires before the next instruction*/
+        EventId ScheduleAt(uint64_t cycle, Callback callback);
+        EventId ScheduleIn(uint64_t cycles, Callback callback) { return ScheduleAt(Now() + cycles, std::move(callback)); }
+        /*returns false when the event has already fired or was cancelled*/
+        bool Cancel(EventId id);
+
+        size_t PendingEvents() const { return pending; }
+        /*events kept in the heap, cancelled ones stay there until they reach the top or the heap is compacted*/
+        size_t QueuedEvents() const { return heap.size(); }
+        /*cycle of the earliest pending event, UINT64_MAX without events*/
+        uint64_t NextEventCycle();
+
+        /*
+         * runs the cpu for at least the given number of cycles, firing events on the way,
+         * stops early on an unknown instruction
+         */
+        STOP_REASON RunFor(uint64_t cycles);
+
+    private:
+        struct Event {
+            uint64_t cycle;
+            //breaks ties, events at one cycle fire first in, first out
+            uint64_t sequence;
+            uint32_t slot;
+            uint32_t generation;
+        };
+        /*slot of the callback, reused once the event is gone, generation tells apart events using the same slot*/
+        struct Slot {
+            Callback callback;
+            uint32_t generation = 0;
+            bool active = false;
+        };
+
+        static bool Later(const Event& first, const Event& second) {
+            return first.cycle != second.cycle ? first.cycle > second.cycle : first.sequence > second.sequence;
+        }
+
+        /*drops cancelled events from the top of the heap*/
+        void SkipCancelled();
+        /*drops every cancelled event, called once they outnumber pending ones*/
+        void Compact();
+        /*fires every event scheduled at or before now*/
+        void FireDueEvents();
+
+        CPU& cpu;
+        Bus& bus;
+        //cycle at which the running (or next) Execute call started
+        uint64_t now = 0;
+        uint64_t sequence = 0;
+        size_t pending = 0;
+
+        std::vector<Event> heap{};
+        std::vector<Slot> slots{};
+        std::vector<uint32_t> freeSlots{};
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_SCHEDULER_H
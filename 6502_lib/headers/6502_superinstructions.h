@@ -0,0 +1,76 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_SUPERINSTRUCTIONS_H
+#define INC_6502_PROJECT_6502_SUPERINSTRUCTIONS_H
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "6502_cpu.h"
+
+/*
+ * Opcode pairs which BlockCache runs as one dispatch (superinstructions).
+ * Set is chosen at build time: cmake -DMOS6502_SUPERINSTRUCTIONS=OFF disables fusion,
+ * defining MOS6502_FUSED_PAIRS(X) replaces the default set. OpcodeProfile shows which pairs are hottest.
+ * First instruction of a pair can not be a branch or a jump.
+ */
+#ifndef MOS6502_SUPERINSTRUCTIONS
+#define MOS6502_SUPERINSTRUCTIONS 1
+#endif
+
+#ifndef MOS6502_FUSED_PAIRS
+#if MOS6502_SUPERINSTRUCTIONS
+#define MOS6502_FUSED_PAIRS(X) \
+    X(0xA9, 0x85) /* LDA #imm, STA zp */ \
+    X(0xCA, 0xD0) /* DEX, BNE */ \
+    X(0x88, 0xD0) /* DEY, BNE */ \
+    X(0xE8, 0xD0) /* INX, BNE */ \
+    X(0xC9, 0xD0) /* CMP #imm, BNE */ \
+    X(0xC9, 0xF0) /* CMP #imm, BEQ */ \
+    X(0xC5, 0xD0) /* CMP zp, BNE */ \
+    X(0x69, 0xC9) /* ADC #imm, CMP #imm */ \
+    X(0x68, 0x29) /* PLA, AND #imm */ \
+    X(0x29, 0xC5) /* AND #imm, CMP zp */ \
+    X(0x08, 0xA5) /* PHP, LDA zp */
+#else
+#define MOS6502_FUSED_PAIRS(X)
+#endif
+#endif
+
+namespace MOS6502 {
+    /*Counts opcode pairs and triples executed by the cpu*/
+    class OpcodeProfile {
+    public:
+        struct NGram {
+            std::array<uint8_t, 3> opcodes;
+            uint8_t length;
+            uint64_t count;
+        };
+
+        OpcodeProfile();
+
+        /* runs cpu one instruction at a time, return number of cycles used (-1 on unknown instruction) */
+        int32_t Record(CPU& cpu, int32_t cycles, Bus& memory);
+
+        /* returns up to count most frequent n-grams of given length (2 or 3) */
+        std::vector<NGram> Hottest(uint8_t length, size_t count) const;
+
+        void Clear();
+
+    private:
+        //indexed by (first << 8) | second
+        std::vector<uint64_t> pairs;
+        //indexed by (first << 16) | (second << 8) | third
+        std::unordered_map<uint32_t, uint64_t> triples;
+
+        //last two opcodes, older one in the high byte
+        uint16_t history = 0;
+        uint8_t historyLength = 0;
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_SUPERINSTRUCTIONS_H
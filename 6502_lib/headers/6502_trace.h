@@ -0,0 +1,244 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_TRACE_H
+#define INC_6502_PROJECT_6502_TRACE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "Bus.h"
+
+namespace MOS6502 {
+    /*
+     * One executed instruction, registers as they were before it.
+     * Cycle of an instruction is the sum of cycles of the records before it.
+     * Interrupt entry is a record too: flags tell IRQ from NMI, opcode is 0 and operands hold the handler address.
+     */
+    struct TraceRecord {
+        uint16_t PC;
+        uint8_t opcode;
+        //bytes after the opcode, whether they belong to the instruction or not
+        uint8_t operands[2];
+        uint8_t A, X, Y, S, P;
+        uint8_t cycles;
+        //bytes written by the instruction, address and value of the last one
+        uint8_t writeCount;
+        uint16_t writeAddress;
+        uint8_t writeValue;
+        //TRACE_FLAGS
+        uint8_t flags;
+    };
+    enum TRACE_FLAGS : uint8_t {
+        TRACE_IRQ = 0x01,
+        TRACE_NMI = 0x02
+    };
+    static_assert(sizeof(TraceRecord) == 16, "trace files store records as 16 raw bytes");
+
+    /*
+     * Writes records to a file: header (magic "6502TRC1", record size as u32) followed by raw records.
+     * Cpu thread pushes records to a single producer single consumer ring buffer,
+     * a background thread writes them to the file in large chunks. Push waits while the buffer is full, nothing is dropped.
+     * Neither thread spins: the writer sleeps until NOTIFY_BATCH more records are pushed (or Close),
+     * a full buffer makes Reserve sleep until the writer frees a chunk.
+     */
+    class TraceRecorder {
+    public:
+        //records, power of two
+        static constexpr size_t CAPACITY = 1 << 16;
+        //records pushed between wake ups of the writer, power of two dividing CAPACITY
+        static constexpr size_t NOTIFY_BATCH = 1 << 12;
+        static constexpr char MAGIC[8] = {'6', '5', '0', '2', 'T', 'R', 'C', '1'};
+
+        /*throws std::runtime_error when the file can not be created*/
+        explicit TraceRecorder(const std::string& path);
+        ~TraceRecorder();
+
+        TraceRecorder(const TraceRecorder&) = delete;
+        TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+        /*
+         * count free slots for the next records, filled in place and published by Commit.
+         * Slots end at the next NOTIFY_BATCH boundary, so they never wrap around the buffer.
+         * Waits while the buffer is full, slots reserved again before Commit start at the same one.
+         */
+        TraceRecord* Reserve(size_t& count) {
+            uint64_t position = head.load(std::memory_order_relaxed);
+            //tail is read again only when the buffer looks full, the writer's cache line is left alone
+            while(position - knownTail == CAPACITY) {
+                knownTail = tail.load(std::memory_order_acquire);
+                if(position - knownTail == CAPACITY)
+                    tail.wait(knownTail, std::memory_order_acquire);
+            }
+            uint64_t batchEnd = (position | (NOTIFY_BATCH - 1)) + 1;
+            count = size_t(std::min(batchEnd, knownTail + CAPACITY) - position);
+            return &ring[position & (CAPACITY - 1)];
+        }
+
+        /*publishes count records filled in slots returned by Reserve*/
+        void Commit(size_t count) {
+            uint64_t position = head.load(std::memory_order_relaxed) + count;
+            head.store(position, std::memory_order_release);
+
+            //a system call at most once per batch, the writer is already awake when the buffer gets full
+            if((position & (NOTIFY_BATCH - 1)) == 0)
+                WakeWriter();
+        }
+
+        void Push(const TraceRecord& record) {
+            size_t count;
+            *Reserve(count) = record;
+            Commit(1);
+        }
+
+        /*writes every pushed record and closes the file, called by the destructor*/
+        void Close();
+
+        uint64_t RecordCount() const { return head.load(std::memory_order_relaxed); }
+
+    private:
+        void WriteLoop();
+        void WakeWriter() {
+            wakeups.fetch_add(1, std::memory_order_release);
+            wakeups.notify_one();
+        }
+
+        std::unique_ptr<TraceRecord[]> ring;
+        //written by the cpu thread
+        alignas(64) std::atomic<uint64_t> head{0};
+        uint64_t knownTail = 0;
+        //bumped to wake the writer, it sleeps until the value changes
+        std::atomic<uint32_t> wakeups{0};
+        //written by the writer thread
+        alignas(64) std::atomic<uint64_t> tail{0};
+        std::atomic<bool> closing{false};
+
+        FILE* file = nullptr;
+        std::thread writer{};
+    };
+
+    /*
+     * Memory seen by CPU::Execute and CPU::Run while CPU::tracer is set,
+     * forwards accesses to the memory the engine would use otherwise (Bus or FlatBus) and records every instruction.
+     * Records are filled in place and published a batch at a time, the rest when the bus is destroyed.
+     */
+    template<typename Memory>
+    struct TracingBus {
+        Memory& memory;
+        const Bus& bus;
+        TraceRecorder& recorder;
+        //slot in the ring buffer of the instruction being executed
+        TraceRecord* record = nullptr;
+        //slots reserved from the recorder, records before record are filled but not published yet
+        TraceRecord* batchStart = nullptr;
+        TraceRecord* batchEnd = nullptr;
+
+        TracingBus(Memory& memory, const Bus& bus, TraceRecorder& recorder)
+            : memory(memory), bus(bus), recorder(recorder) {}
+
+        ~TracingBus() {
+            Publish();
+        }
+
+        //copy would publish the same records twice
+        TracingBus(const TracingBus&) = delete;
+        TracingBus& operator=(const TracingBus&) = delete;
+
+        uint8_t Read(uint16_t address) const {
+            return memory.Read(address);
+        }
+
+        void Write(uint16_t address, uint8_t value) {
+            memory.Write(address, value);
+            record->writeCount++;
+            record->writeAddress = address;
+            record->writeValue = value;
+        }
+
+        void BeginInstruction(uint16_t PC, uint8_t A, uint8_t X, uint8_t Y, uint8_t S, uint8_t P) {
+            if(record == batchEnd) [[unlikely]]
+                NextBatch();
+
+            //record is filled by two stores: PC, code and A, X, Y, then S and P with every other field zeroed
+            uint64_t registers = PC | uint64_t(PeekCode(PC) & 0xFFFFFF) << 16 |
+                                 uint64_t(A) << 40 | uint64_t(X) << 48 | uint64_t(Y) << 56;
+            uint64_t status = S | uint64_t(P) << 8;
+            std::memcpy(reinterpret_cast<uint8_t*>(record), &registers, sizeof(registers));
+            std::memcpy(reinterpret_cast<uint8_t*>(record) + sizeof(registers), &status, sizeof(status));
+        }
+
+        void EndInstruction(uint32_t cycles) {
+            record->cycles = uint8_t(cycles);
+            record++;
+        }
+
+        /*ends the record begun before an interrupt entry instead of EndInstruction*/
+        void EndInterrupt(uint16_t vector, uint16_t handler, uint32_t cycles) {
+            record->flags = vector == 0xFFFA ? TRACE_NMI : TRACE_IRQ;
+            record->opcode = 0;
+            record->operands[0] = uint8_t(handler);
+            record->operands[1] = uint8_t(handler >> 8);
+            EndInstruction(cycles);
+        }
+
+    private:
+        /*publishes finished records, the one being executed is filled again by the next BeginInstruction*/
+        void Publish() {
+            if(record != batchStart)
+                recorder.Commit(size_t(record - batchStart));
+            batchStart = record;
+        }
+
+        void NextBatch() {
+            Publish();
+            size_t count;
+            record = batchStart = recorder.Reserve(count);
+            batchEnd = batchStart + count;
+        }
+
+        /*opcode and operand bytes in the low 3 bytes, read without side effects, device registers are not touched*/
+        uint32_t PeekCode(uint16_t PC) const {
+            uint32_t code;
+            if constexpr (std::is_same_v<Memory, FlatBus>) {
+                //flat RAM, all bytes in one load unless it wraps around the address space
+                if(PC <= Bus::MAX_MEM - 4) [[likely]] {
+                    std::memcpy(&code, memory.RAM + PC, sizeof(code));
+                    return code;
+                }
+            } else {
+                //one page lookup when the bytes do not cross a page
+                const uint8_t* page = bus.pages[PC >> 8].read;
+                if(page != nullptr && (PC & 0xFF) <= Bus::PAGE_SIZE - 4) [[likely]] {
+                    std::memcpy(&code, page + (PC & 0xFF), sizeof(code));
+                    return code;
+                }
+            }
+            return bus[PC] | bus[uint16_t(PC + 1)] << 8 | bus[uint16_t(PC + 2)] << 16;
+        }
+    };
+    static_assert(offsetof(TraceRecord, S) == 8 && offsetof(TraceRecord, flags) == 15,
+                  "TracingBus fills records with two 8 byte stores");
+
+    /*
+     * Renders a trace file one instruction per line:
+     * "<cycle> <PC>  <bytes>  <mnemonic operand>  A:.. X:.. Y:.. S:.. P:..  [<address>]=<value>"
+     * interrupt entries show as "IRQ -> $<handler>" or "NMI -> $<handler>" at the interrupted PC
+     * throws std::runtime_error when input is not a trace
+     */
+    void DecodeTrace(std::istream& input, std::ostream& output);
+    /*one line of DecodeTrace without the newline*/
+    std::string DecodeTraceRecord(const TraceRecord& record, uint64_t cycle);
+}
+
+#endif //INC_6502_PROJECT_6502_TRACE_H
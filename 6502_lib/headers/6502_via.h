@@ -0,0 +1,150 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_6502_VIA_H
+#define INC_6502_PROJECT_6502_VIA_H
+
+#include <cstdint>
+#include <functional>
+
+#include "Bus.h"
+#include "6502_scheduler.h"
+
+namespace MOS6502 {
+    /*
+     * MOS 6522 Versatile Interface Adapter, mapped with Bus::MapDevice, its 16 registers repeat over the mapped pages.
+     *
+     * Timers and the shift register are not clocked. Each keeps the cycle it was loaded at and its value
+     * is computed from Scheduler::Now() when a register is accessed. A scheduler event is kept only for the earliest
+     * interrupt enabled in IER whose flag is not set yet, so a VIA with idle or masked timers costs nothing.
+     *
+     * Not modelled: port latching (ACR bits 0-1), CA2/CB2 handshake and pulse outputs, bits shifted out on CB2.
+     * In shift register modes driven by T2 the T2 counter is not kept up to date.
+     */
+    class VIA6522 : public Device {
+    public:
+        enum REGISTER : uint8_t {
+            ORB, ORA, DDRB, DDRA,
+            T1CL, T1CH, T1LL, T1LH,
+            T2CL, T2CH, SR, ACR,
+            PCR, IFR, IER, ORA_NO_HANDSHAKE
+        };
+
+        //bits of IFR and IER, bit 7 of IFR is set while any enabled flag is set
+        enum INTERRUPT : uint8_t {
+            IRQ_CA2 = 0x01,
+            IRQ_CA1 = 0x02,
+            IRQ_SR  = 0x04,
+            IRQ_CB2 = 0x08,
+            IRQ_CB1 = 0x10,
+            IRQ_T2  = 0x20,
+            IRQ_T1  = 0x40
+        };
+
+        explicit VIA6522(Scheduler& scheduler);
+        ~VIA6522() override;
+
+        VIA6522(const VIA6522&) = delete;
+        VIA6522& operator=(const VIA6522&) = delete;
+
+        uint8_t Read(uint16_t address) override;
+        void Write(uint16_t address, uint8_t value) override;
+        /*
+         * counters, SR and PB7 driven by T1 change with time, IFR is stable while every flag which could still
+         * be set by time has a scheduler event (its interrupt is enabled)
+         */
+        bool ReadIsStable(uint16_t address) const override;
+
+        /*RES pin: clears port, control and interrupt registers, timers stop raising interrupts*/
+        void Reset();
+
+        /////////// PINS DRIVEN BY THE HOST ///////////
+        //levels of port pins configured as inputs
+        void SetPortAInput(uint8_t value) { portAInput = value; }
+        void SetPortBInput(uint8_t value) { portBInput = value; }
+        void SetCA1(bool level);
+        void SetCA2(bool level);
+        /*rising edge also clocks the shift register in modes driven by CB1*/
+        void SetCB1(bool level);
+        void SetCB2(bool level);
+        /*negative pulse on PB6, counted by T2 in pulse counting mode*/
+        void PulsePB6();
+
+        /*levels driven on port pins, input pins read as 1 (pulled up)*/
+        uint8_t PortAOutput() const;
+        uint8_t PortBOutput() const;
+
+        bool IRQ() const { return irqLevel; }
+        /*called when the IRQ output changes, connect it to CPU::SetIRQ (or to a wired-or of several devices)*/
+        std::function<void(bool asserted)> irqOutput{};
+
+    private:
+        bool T1FreeRun() const { return acr & 0x40; }
+        bool T1DrivesPB7() const { return acr & 0x80; }
+        bool T2CountsPulses() const { return acr & 0x20; }
+        uint8_t ShiftMode() const { return (acr >> 2) & 0x07; }
+
+        /*counter value at cycle, reloading is set on the cycle a free running T1 shows $FFFF before reload*/
+        uint16_t T1Counter(uint64_t cycle, bool* reloading = nullptr) const;
+        uint16_t T2Counter(uint64_t cycle) const;
+        /*level T1 drives on PB7 at cycle now, also before the VIA caught up*/
+        bool PB7(uint64_t now) const;
+        //cycles per shifted bit, 0 when bits are clocked by CB1 or shifting is disabled
+        uint32_t ShiftPeriod() const;
+
+        /*brings flags, PB7 and the shift register to cycle now*/
+        void CatchUp(uint64_t now);
+        void CatchUpShiftRegister(uint64_t now);
+        void ShiftBits(uint32_t count);
+        /*restarts counting from the value at cycle now, used before latch or mode changes*/
+        void RebaseT1(uint64_t now);
+        void RebaseT2(uint64_t now);
+        void UpdateT1Underflow();
+        void UpdateT2Underflow();
+        void StartShift(uint64_t now);
+
+        uint8_t ReadPortA() const;
+        uint8_t ReadPortB() const;
+        bool CA2Independent() const { return (pcr & 0x0A) == 0x02; }
+        bool CB2Independent() const { return (pcr & 0xA0) == 0x20; }
+
+        /*sets IRQ output and moves the scheduler event to the next enabled interrupt, called after every change*/
+        void Update();
+
+        Scheduler& scheduler;
+        Scheduler::EventId event = 0;
+        uint64_t eventCycle = UINT64_MAX;
+
+        uint8_t ora = 0, orb = 0, ddra = 0, ddrb = 0;
+        uint8_t portAInput = 0xFF, portBInput = 0xFF;
+        uint8_t acr = 0, pcr = 0, ifr = 0, ier = 0;
+        bool ca1 = true, ca2 = true, cb1 = true, cb2 = true;
+        bool irqLevel = false;
+
+        //T1 counts down from t1Value starting at t1Anchor, reloads from t1Latch when free running
+        uint64_t t1Anchor = 0;
+        uint16_t t1Value = 0xFFFF;
+        uint16_t t1Latch = 0xFFFF;
+        //one shot T1 interrupts once per load
+        bool t1Armed = false;
+        uint64_t t1NextUnderflow = UINT64_MAX;
+        bool pb7 = true;
+
+        //T2 counts down from t2Value starting at t2Anchor, or by pulses on PB6
+        uint64_t t2Anchor = 0;
+        uint16_t t2Value = 0xFFFF;
+        uint8_t t2LatchLow = 0xFF;
+        uint32_t t2Pulses = 0;
+        bool t2Armed = false;
+        uint64_t t2NextUnderflow = UINT64_MAX;
+
+        //shift register, shiftRemaining bits are left from shiftStart
+        uint8_t sr = 0;
+        bool shifting = false;
+        uint64_t shiftStart = 0;
+        uint32_t shiftRemaining = 0;
+    };
+}
+
+#endif //INC_6502_PROJECT_6502_VIA_H
@@ -4,7 +4,13 @@
 
 #ifndef INC_6502_PROJECT_BUS_H
 #define INC_6502_PROJECT_BUS_H
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
 
 enum LAYOUT {
     RAM_ONLY,
@@ -12,58 +18,332 @@ enum LAYOUT {
 };
 
 namespace MOS6502{
+    /*Memory mapped device, receives every cpu access to pages mapped to it*/
+    class Device {
+    public:
+        virtual ~Device() = default;
+
+        virtual uint8_t Read(uint16_t address) = 0;
+        virtual void Write(uint16_t address, uint8_t value) = 0;
+
+        /*
+         * true when reading address again returns the same value and changes nothing until the next scheduler event
+         * or cpu write to the device, lets CPU::Execute skip loops polling it (CPU::skipIdleLoops)
+         */
+        virtual bool ReadIsStable(uint16_t /*address*/) const { return false; }
+    };
+
+    /*
+     * One block of memory handing out RAM for many buses, so creating a machine does not allocate.
+     * Memory is given back all at once by Reset, buses using it have to be destroyed before.
+     */
+    class MemoryArena {
+    public:
+        //alignment of the block, a cache line
+        static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+        explicit MemoryArena(size_t capacity)
+            : block(static_cast<uint8_t*>(::operator new[](capacity, std::align_val_t{BLOCK_ALIGNMENT}))),
+              capacity(capacity) {}
+
+        MemoryArena(const MemoryArena&) = delete;
+        MemoryArena& operator=(const MemoryArena&) = delete;
+
+        /*address of the chunk is a multiple of alignment (a power of 2), throws std::bad_alloc when the arena has no room left*/
+        uint8_t* Allocate(size_t size, size_t alignment = BLOCK_ALIGNMENT) {
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+            size_t start = ((base + used + alignment - 1) & ~uintptr_t(alignment - 1)) - base;
+            if(start > capacity || size > capacity - start)
+                throw std::bad_alloc();
+            used = start + size;
+            return block.get() + start;
+        }
+
+        void Reset() { used = 0; }
+
+        size_t Used() const { return used; }
+        size_t Capacity() const { return capacity; }
+
+    private:
+        struct AlignedDelete {
+            void operator()(uint8_t* memory) const { ::operator delete[](memory, std::align_val_t{BLOCK_ALIGNMENT}); }
+        };
+
+        std::unique_ptr<uint8_t[], AlignedDelete> block;
+        size_t capacity;
+        size_t used = 0;
+    };
+
     struct Bus {
-        // max memory amount (max possible address reachable)
-        static constexpr uint32_t MAX_MEM = 0xFFFF;
+        // number of addressable bytes (0x0000 - 0xFFFF)
+        static constexpr uint32_t MAX_MEM = 0x10000;
+        static constexpr uint32_t PAGE_SIZE = 0x100;
+        static constexpr uint32_t PAGE_COUNT = MAX_MEM / PAGE_SIZE;
+        // internal RAM of the NES, mirrored up to 0x1FFF
+        static constexpr uint32_t NES_RAM_SIZE = 0x800;
+
+        /*One 256 byte page of the address space, backed by host memory or by a device*/
+        struct Page {
+            //host memory of the page, nullptr when reads go to device
+            uint8_t* read = nullptr;
+            //host memory for writes, nullptr when writes go to device or are ignored (ROM)
+            uint8_t* write = nullptr;
+            //receives accesses host memory does not take
+            Device* device = nullptr;
 
-        //byte array of MAX_MEM size
+            //mirrored region the page belongs to, writes mark every page showing the same memory
+            uint8_t mirrorFirstPage = 0;
+            uint16_t mirrorPageCount = 0;
+            //pages of host memory repeated in the region, 0 when page is not mirrored
+            uint16_t mirrorStride = 0;
+        };
+
+        //byte array of the bus: whole address space for RAM_ONLY, internal RAM for NES
         uint8_t* RAM;
         //
         uint32_t RAM_SIZE = 0;
 
+        //memory map indexed by high byte of an address
+        Page pages[PAGE_COUNT]{};
+        //every page maps RAM at its own address, cpu reads RAM directly
+        bool flat = false;
+
+        //incremented on every write through Write, one counter for each 256 byte page
+        uint32_t pageGeneration[256]{};
+        //incremented whenever host rewrites memory in bulk (Load, LoadProgram, Initialise)
+        uint32_t hostWriteEpoch = 0;
+
         //initialise memory
         void Initialise(){
-            for(size_t i = 0; i < RAM_SIZE; i++){
-                RAM[i] = 0;
+            hostWriteEpoch++;
+            std::memset(RAM, 0, RAM_SIZE);
+        }
+
+        /*bytes of RAM a bus with that layout needs*/
+        static constexpr uint32_t RAMSize(LAYOUT layout) {
+            return layout == NES ? NES_RAM_SIZE : MAX_MEM;
+        }
+
+        Bus(LAYOUT layout = RAM_ONLY) : Bus(new uint8_t[RAMSize(layout)], layout) {
+            ownsRAM = true;
+        }
+
+        /*
+         * RAM is taken from the arena, no heap allocation is made.
+         * Arena has to outlive the bus, throws std::bad_alloc when it has no room left.
+         */
+        Bus(MemoryArena& arena, LAYOUT layout = RAM_ONLY) : Bus(arena.Allocate(RAMSize(layout)), layout) {}
+
+        /*RAM is RAMSize(layout) bytes of storage owned by the caller, which has to outlive the bus*/
+        Bus(uint8_t* storage, LAYOUT layout) : RAM(storage), RAM_SIZE(RAMSize(layout)), layout(layout) {
+            MapLayout();
+        }
+
+        //pages point into RAM, copy would share and double free it
+        Bus(const Bus&) = delete;
+        Bus& operator=(const Bus&) = delete;
+
+        ~Bus() {
+            if(ownsRAM)
+                delete[] RAM;
+        }
+
+        /*
+         * Clears RAM, restores memory map of the layout and forgets the snapshot baseline,
+         * so the bus can be reused for another machine without allocating a new one.
+         */
+        void Reset() {
+            for(Page& page : pages)
+                page = Page{};
+            MapLayout();
+            baseline = Snapshot{};
+            Initialise();
+        }
+
+        /*
+         * Maps size bytes of host memory to pageCount pages starting at firstPage.
+         * Memory smaller than the region is mirrored, size has to be a multiple of PAGE_SIZE dividing the region.
+         * Writes to read only memory go to registers when given (bank registers of a cartridge mapper).
+         * Bus does not take ownership of the memory.
+         */
+        void MapMemory(uint8_t firstPage, uint16_t pageCount, uint8_t* memory, uint32_t size, bool writable,
+                       Device* registers = nullptr);
+
+        /*Maps pageCount pages starting at firstPage to device, bus does not take ownership of the device*/
+        void MapDevice(uint8_t firstPage, uint16_t pageCount, Device* device);
+
+        /*Unmapped pages read as 0 and ignore writes*/
+        void Unmap(uint8_t firstPage, uint16_t pageCount);
+
+        /*true when page at address is backed by host memory (RAM, ROM or mirror)*/
+        bool IsHostMemory(uint16_t address) const {
+            return pages[address >> 8].read != nullptr;
+        }
+
+        /*Reads one byte from an address without side effects, device pages read as 0*/
+        uint8_t operator[](uint32_t address) const {
+            const Page& page = pages[(address >> 8) & 0xFF];
+            return page.read != nullptr ? page.read[address & 0xFF] : 0;
+        }
+
+        /*Writes one byte to an address, page of the address (and its mirrors) is marked as modified*/
+        uint8_t& operator[](uint32_t address) {
+            MarkModified((address >> 8) & 0xFF);
+            return HostByte(address);
+        }
+
+        /*Reads one byte from an address, used by the cpu*/
+        uint8_t Read(uint16_t address) const {
+            if(flat) [[likely]]
+                return RAM[address];
+            const Page& page = pages[address >> 8];
+            if(page.read != nullptr) [[likely]]
+                return page.read[address & 0xFF];
+            return ReadDevice(address);
+        }
+
+        /*Writes one byte to an address, used by the cpu, marks page of the address as modified*/
+        void Write(uint16_t address, uint8_t value) {
+            if(flat) [[likely]] {
+                RAM[address] = value;
+                pageGeneration[address >> 8]++;
+                return;
             }
+            const Page& page = pages[address >> 8];
+            if(page.write != nullptr) [[likely]] {
+                page.write[address & 0xFF] = value;
+                MarkModified(address >> 8);
+                return;
+            }
+            WriteDevice(address, value);
         }
 
+        /*program starts with its address (little endian), which is also written to reset vector*/
+        void LoadProgram(const uint8_t *program, uint32_t programSize) {
+            Initialise();
+            HostByte(0xFFFC) = program[0];
+            HostByte(0xFFFD) = program[1];
+
+            uint16_t programAddress = (program[1] << 8) + program[0];
+            if(programSize > 2)
+                Load(programAddress, program + 2, programSize - 2);
+        }
+
+        /*
+         * Copies size bytes to host memory starting at address, wraps around at the end of address space.
+         * Copied page by page, device and unmapped pages are skipped. Use ROMImage to map ROM without a copy.
+         */
+        void Load(uint16_t address, const uint8_t* data, uint32_t size) {
+            hostWriteEpoch++;
+            uint32_t offset = address;
+            while(size > 0){
+                uint32_t pageOffset = offset & 0xFF;
+                uint32_t chunk = std::min(size, PAGE_SIZE - pageOffset);
+                const Page& page = pages[(offset >> 8) & 0xFF];
+                if(page.read != nullptr)
+                    std::memcpy(page.read + pageOffset, data, chunk);
+
+                data += chunk;
+                offset += chunk;
+                size -= chunk;
+            }
+        }
+
+        using PageCopy = std::array<uint8_t, PAGE_SIZE>;
+
+        /*
+         * Contents of every writable page at the time the snapshot was taken.
+         * Pages not written since the previous snapshot share its copy, so snapshots are cheap to take and to keep.
+         * Memory map and state of devices are not saved.
+         */
+        struct Snapshot {
+            std::shared_ptr<const PageCopy> pages[PAGE_COUNT];
+        };
 
-        Bus(LAYOUT layout = RAM_ONLY){
+        /*
+         * Copies only pages written since the last snapshot was taken or restored.
+         * Writes are seen through Write, operator[] and Load, bytes stored straight to RAM are not.
+         */
+        Snapshot TakeSnapshot();
+        /*copies back only pages which differ from the snapshot, code decoded from them is invalidated*/
+        void RestoreSnapshot(const Snapshot& snapshot);
+
+    private:
+        LAYOUT layout;
+        //false when RAM comes from an arena or from the caller
+        bool ownsRAM = false;
+
+        //host writes to device and unmapped pages land here
+        uint8_t openBus = 0;
+
+        void MapLayout() {
             switch(layout){
                 case RAM_ONLY:
-                    RAM = new uint8_t[MAX_MEM];
-                    RAM_SIZE = MAX_MEM;
+                    MapMemory(0x00, PAGE_COUNT, RAM, RAM_SIZE, true);
+                    flat = true;
                     break;
                 case NES:
+                    //PPU registers (PPURegisterMirror), APU and cartridge (Mapper) are mapped by their devices, see NES_mappers.h
+                    MapMemory(0x00, 0x20, RAM, RAM_SIZE, true);
                     break;
             }
         }
 
-        ~Bus() {
-            delete[] RAM;
+        /*host access to a byte, ROM can be patched this way*/
+        uint8_t& HostByte(uint32_t address) {
+            const Page& page = pages[(address >> 8) & 0xFF];
+            return page.read != nullptr ? page.read[address & 0xFF] : openBus;
         }
 
-        /*Reads one byte from an address*/
-        uint8_t operator[](uint32_t address) const {
-            return (this, RAM[address]);
+        static void CheckRegion(uint8_t firstPage, uint16_t pageCount);
+
+        /*code decoded from remapped pages is stale, layout is no longer a single flat RAM*/
+        void Remapped(uint8_t firstPage, uint16_t pageCount);
+
+        /*cpu accesses host memory does not take, kept out of line so RAM accesses stay small when inlined*/
+        uint8_t ReadDevice(uint16_t address) const;
+        void WriteDevice(uint16_t address, uint8_t value);
+
+        /*bumps generation of the page and of every page mirroring the same memory*/
+        void MarkModified(uint8_t pageIndex) {
+            const Page& page = pages[pageIndex];
+            if(page.mirrorStride == 0) [[likely]] {
+                pageGeneration[pageIndex]++;
+                return;
+            }
+
+            //every page showing the same memory is modified
+            uint32_t end = page.mirrorFirstPage + page.mirrorPageCount;
+            for(uint32_t alias = page.mirrorFirstPage + (pageIndex - page.mirrorFirstPage) % page.mirrorStride;
+                alias < end; alias += page.mirrorStride)
+                pageGeneration[alias]++;
         }
 
-        /*Writes one byte to an address*/
-        uint8_t& operator[](uint32_t address) {
-            return (this, RAM[address]);
+        //memory as it was at the last TakeSnapshot or RestoreSnapshot, with generations of pages at that time
+        Snapshot baseline{};
+        uint32_t baselineGeneration[PAGE_COUNT]{};
+        uint32_t baselineEpoch = 0;
+
+        bool ChangedSinceBaseline(uint8_t pageIndex) const {
+            return baseline.pages[pageIndex] == nullptr || pageGeneration[pageIndex] != baselineGeneration[pageIndex] ||
+                   hostWriteEpoch != baselineEpoch;
         }
+    };
 
-        void LoadProgram(const uint8_t *program, uint8_t programSize) {
-            Initialise();
-            RAM[0xFFFC] = program[0];
-            RAM[0xFFFD] = program[1];
+    /*View of a flat Bus used by execution engines, every access is a single load or store*/
+    struct FlatBus {
+        uint8_t* RAM;
+        uint32_t* pageGeneration;
 
-            uint16_t programAddress = (program[1] << 8) + program[0];
+        explicit FlatBus(Bus& bus) : RAM(bus.RAM), pageGeneration(bus.pageGeneration) {}
 
-            for(uint16_t i = 2; i < programSize; i++){
-                RAM[programAddress + i - 2] = program[i];
-            }
+        uint8_t Read(uint16_t address) const {
+            return RAM[address];
+        }
+
+        void Write(uint16_t address, uint8_t value) {
+            RAM[address] = value;
+            pageGeneration[address >> 8]++;
         }
     };
 }
@@ -6,7 +6,6 @@
 #define INC_6502_PROJECT_INSTRUCTIONS_H
 
 #include <cstdint>
-#include <string>
 
 namespace MOS6502 {
     /* Stores possible addressing modes */
@@ -25,7 +24,8 @@ namespace MOS6502 {
         ABSOLUTE_X,
         ABSOLUTE_Y,
         INDIRECT_X,
-        INDIRECT_Y
+        INDIRECT_Y,
+        INDIRECT
     };
     //contains possible instructions
     enum INSTRUCTIONS : uint8_t {
@@ -363,58 +363,124 @@ namespace MOS6502 {
 
 
     struct instruction {
-        std::string name;
+        const char* name;
         MOS6502::INSTRUCTIONS opcode;
         MOS6502::ADDRESSING_MODE addressingMode;
+        //base number of cycles, without page crossing and taken branch penalties
         uint8_t cycles;
+        //length of the instruction including opcode
         uint8_t bytes;
     };
 
-    [[maybe_unused]] static const instruction InstructionsDataTable[] = {
-            {"LDA", INS_LDA_IM, IMMEDIATE, 2, 1},
+    /*compares two mnemonics, usable at compile time*/
+    constexpr bool IsSameMnemonic(const char* first, const char* second) {
+        while(*first != '\0' && *first == *second) {
+            first++;
+            second++;
+        }
+        return *first == *second;
+    }
+
+    //describes every implemented instruction, handlers of the cpu are generated from this table
+    inline constexpr instruction InstructionsDataTable[] = {
+            {"LDA", INS_LDA_IM, IMMEDIATE, 2, 2},
             {"LDA", INS_LDA_ZP, ZERO_PAGE, 3, 2},
             {"LDA", INS_LDA_ZP_X, ZERO_PAGE_X, 4, 2},
-            {"LDA", INS_LDA_ABS, ABSOLUTE, 4, 2},
-            {"LDA", INS_LDA_ABS_X, ABSOLUTE_X, 4, 2},
-            {"LDA", INS_LDA_ABS_Y, ABSOLUTE_Y, 4, 2},
+            {"LDA", INS_LDA_ABS, ABSOLUTE, 4, 3},
+            {"LDA", INS_LDA_ABS_X, ABSOLUTE_X, 4, 3},
+            {"LDA", INS_LDA_ABS_Y, ABSOLUTE_Y, 4, 3},
             {"LDA", INS_LDA_IND_X, INDIRECT_X, 6, 2},
             {"LDA", INS_LDA_IND_Y, INDIRECT_Y, 5, 2},
 
-            {"LDX", INS_LDX_IM, IMMEDIATE, 2, 1},
+            {"LDX", INS_LDX_IM, IMMEDIATE, 2, 2},
             {"LDX", INS_LDX_ZP, ZERO_PAGE, 3, 2},
-            {"LDX", INS_LDX_ZP_Y, ZERO_PAGE_X, 4, 2},
-            {"LDX", INS_LDX_ABS, ABSOLUTE, 4, 2},
-            {"LDX", INS_LDX_ABS_Y, ABSOLUTE_Y, 4, 2},
+            {"LDX", INS_LDX_ZP_Y, ZERO_PAGE_Y, 4, 2},
+            {"LDX", INS_LDX_ABS, ABSOLUTE, 4, 3},
+            {"LDX", INS_LDX_ABS_Y, ABSOLUTE_Y, 4, 3},
 
-            {"LDY", INS_LDY_IM, IMMEDIATE, 2, 1},
+            {"LDY", INS_LDY_IM, IMMEDIATE, 2, 2},
             {"LDY", INS_LDY_ZP, ZERO_PAGE, 3, 2},
             {"LDY", INS_LDY_ZP_X, ZERO_PAGE_X, 4, 2},
-            {"LDY", INS_LDY_ABS, ABSOLUTE, 4, 2},
-            {"LDY", INS_LDY_ABS_X, ABSOLUTE_Y, 4, 2},
+            {"LDY", INS_LDY_ABS, ABSOLUTE, 4, 3},
+            {"LDY", INS_LDY_ABS_X, ABSOLUTE_X, 4, 3},
 
             {"STA", INS_STA_ZP, ZERO_PAGE, 3, 2},
             {"STA", INS_STA_ZP_X, ZERO_PAGE_X, 4, 2},
-            {"STA", INS_STA_ABS, ABSOLUTE, 4, 2},
-            {"STA", INS_STA_ABS_X, ABSOLUTE_X, 4, 2},
-            {"STA", INS_STA_ABS_Y, ABSOLUTE_Y, 4, 2},
+            {"STA", INS_STA_ABS, ABSOLUTE, 4, 3},
+            {"STA", INS_STA_ABS_X, ABSOLUTE_X, 5, 3},
+            {"STA", INS_STA_ABS_Y, ABSOLUTE_Y, 5, 3},
             {"STA", INS_STA_IND_X, INDIRECT_X, 6, 2},
             {"STA", INS_STA_IND_Y, INDIRECT_Y, 6, 2},
 
             {"STX", INS_STX_ZP, ZERO_PAGE, 3, 2},
-            {"STX", INS_STX_ZP_Y, ZERO_PAGE_X, 4, 2},
-            {"STX", INS_STX_ABS, ABSOLUTE, 4, 2},
+            {"STX", INS_STX_ZP_Y, ZERO_PAGE_Y, 4, 2},
+            {"STX", INS_STX_ABS, ABSOLUTE, 4, 3},
 
             {"STY", INS_STY_ZP, ZERO_PAGE, 3, 2},
             {"STY", INS_STY_ZP_X, ZERO_PAGE_X, 4, 2},
-            {"STY", INS_STY_ABS, ABSOLUTE, 4, 2},
-
-            {"CLC", INS_CLC, IMPLIED, 2, 2},
-            {"SEC", INS_SEC, IMPLIED, 2, 2},
-            {"CLD", INS_CLD, IMPLIED, 2, 2},
-            {"SED", INS_SED, IMPLIED, 2, 2},
-            {"CLI", INS_CLI, IMPLIED, 2, 2},
-            {"SEI", INS_SEI, IMPLIED, 2, 2},
-            {"CLV", INS_CLV, IMPLIED, 2, 2},
+            {"STY", INS_STY_ABS, ABSOLUTE, 4, 3},
+
+            {"TAX", INS_TAX, IMPLIED, 2, 1},
+            {"TAY", INS_TAY, IMPLIED, 2, 1},
+            {"TXA", INS_TXA, IMPLIED, 2, 1},
+            {"TYA", INS_TYA, IMPLIED, 2, 1},
+            {"TSX", INS_TSX, IMPLIED, 2, 1},
+            {"TXS", INS_TXS, IMPLIED, 2, 1},
+
+            {"PHA", INS_PHA, IMPLIED, 3, 1},
+            {"PHP", INS_PHP, IMPLIED, 3, 1},
+            {"PLA", INS_PLA, IMPLIED, 4, 1},
+            {"PLP", INS_PLP, IMPLIED, 4, 1},
+
+            {"AND", INS_AND_IM, IMMEDIATE, 2, 2},
+            {"AND", INS_AND_ZP, ZERO_PAGE, 3, 2},
+            {"AND", INS_AND_ZP_X, ZERO_PAGE_X, 4, 2},
+            {"AND", INS_AND_ABS, ABSOLUTE, 4, 3},
+            {"AND", INS_AND_ABS_X, ABSOLUTE_X, 4, 3},
+            {"AND", INS_AND_ABS_Y, ABSOLUTE_Y, 4, 3},
+            {"AND", INS_AND_IND_X, INDIRECT_X, 6, 2},
+            {"AND", INS_AND_IND_Y, INDIRECT_Y, 5, 2},
+
+            {"ORA", INS_ORA_IM, IMMEDIATE, 2, 2},
+            {"ORA", INS_ORA_ZP, ZERO_PAGE, 3, 2},
+            {"ORA", INS_ORA_ZP_X, ZERO_PAGE_X, 4, 2},
+            {"ORA", INS_ORA_ABS, ABSOLUTE, 4, 3},
+            {"ORA", INS_ORA_ABS_X, ABSOLUTE_X, 4, 3},
+            {"ORA", INS_ORA_ABS_Y, ABSOLUTE_Y, 4, 3},
+            {"ORA", INS_ORA_IND_X, INDIRECT_X, 6, 2},
+            {"ORA", INS_ORA_IND_Y, INDIRECT_Y, 5, 2},
+
+            {"EOR", INS_EOR_IM, IMMEDIATE, 2, 2},
+            {"EOR", INS_EOR_ZP, ZERO_PAGE, 3, 2},
+            {"EOR", INS_EOR_ZP_X, ZERO_PAGE_X, 4, 2},
+            {"EOR", INS_EOR_ABS, ABSOLUTE, 4, 3},
+            {"EOR", INS_EOR_ABS_X, ABSOLUTE_X, 4, 3},
+            {"EOR", INS_EOR_ABS_Y, ABSOLUTE_Y, 4, 3},
+            {"EOR", INS_EOR_IND_X, INDIRECT_X, 6, 2},
+            {"EOR", INS_EOR_IND_Y, INDIRECT_Y, 5, 2},
+
+            {"BIT", INS_BIT_ZP, ZERO_PAGE, 3, 2},
+            {"BIT", INS_BIT_ABS, ABSOLUTE, 4, 3},
+
+            {"JSR", INS_JSR, ABSOLUTE, 6, 3},
+            {"RTS", INS_RTS, IMPLIED, 6, 1},
+            {"JMP", INS_JMP_ABS, ABSOLUTE, 3, 3},
+            {"JMP", INS_JMP_IND, INDIRECT, 5, 3},
+
+            {"INX", INS_INX, IMPLIED_X, 2, 1},
+            {"INY", INS_INY, IMPLIED_Y, 2, 1},
+            {"DEX", INS_DEX, IMPLIED_X, 2, 1},
+            {"DEY", INS_DEY, IMPLIED_Y, 2, 1},
+
+            {"INC", INS_INC_ZP, ZERO_PAGE, 5, 2},
+            {"INC", INS_INC_ZP_X, ZERO_PAGE_X, 6, 2},
+            {"INC", INS_INC_ABS, ABSOLUTE, 6, 3},
+            {"INC", INS_INC_ABS_X, ABSOLUTE_X, 7, 3},
+
+            {"DEC", INS_DEC_ZP, ZERO_PAGE, 5, 2},
+            {"DEC", INS_DEC_ZP_X, ZERO_PAGE_X, 6, 2},
+            {"DEC", INS_DEC_ABS, ABSOLUTE, 6, 3},
+            {"DEC", INS_DEC_ABS_X, ABSOLUTE_X, 7, 3},
 
             {"BEQ", INS_BEQ, RELATIVE, 2, 2},
             {"BNE", INS_BNE, RELATIVE, 2, 2},
@@ -423,32 +489,88 @@ namespace MOS6502 {
             {"BMI", INS_BMI, RELATIVE, 2, 2},
             {"BPL", INS_BPL, RELATIVE, 2, 2},
             {"BVS", INS_BVS, RELATIVE, 2, 2},
-            {"BCS", INS_BCS, RELATIVE, 2, 2},
+            {"BVC", INS_BVC, RELATIVE, 2, 2},
+
+            {"CLC", INS_CLC, IMPLIED, 2, 1},
+            {"SEC", INS_SEC, IMPLIED, 2, 1},
+            {"CLD", INS_CLD, IMPLIED, 2, 1},
+            {"SED", INS_SED, IMPLIED, 2, 1},
+            {"CLI", INS_CLI, IMPLIED, 2, 1},
+            {"SEI", INS_SEI, IMPLIED, 2, 1},
+            {"CLV", INS_CLV, IMPLIED, 2, 1},
 
-            {"ADC", INS_ADC_IM, IMMEDIATE, 2, 1},
+            {"ADC", INS_ADC_IM, IMMEDIATE, 2, 2},
             {"ADC", INS_ADC_ZP, ZERO_PAGE, 3, 2},
             {"ADC", INS_ADC_ZP_X, ZERO_PAGE_X, 4, 2},
-            {"ADC", INS_ADC_ABS, ABSOLUTE, 4, 2},
-            {"ADC", INS_ADC_ABS_X, ABSOLUTE_X, 4, 2},
-            {"ADC", INS_ADC_ABS_Y, ABSOLUTE_Y, 4, 2},
+            {"ADC", INS_ADC_ABS, ABSOLUTE, 4, 3},
+            {"ADC", INS_ADC_ABS_X, ABSOLUTE_X, 4, 3},
+            {"ADC", INS_ADC_ABS_Y, ABSOLUTE_Y, 4, 3},
             {"ADC", INS_ADC_IND_X, INDIRECT_X, 6, 2},
             {"ADC", INS_ADC_IND_Y, INDIRECT_Y, 5, 2},
 
-            {"CMP", INS_CMP_IM, IMMEDIATE, 2, 1},
+            {"SBC", INS_SBC_IM, IMMEDIATE, 2, 2},
+            {"SBC", INS_SBC_ZP, ZERO_PAGE, 3, 2},
+            {"SBC", INS_SBC_ZP_X, ZERO_PAGE_X, 4, 2},
+            {"SBC", INS_SBC_ABS, ABSOLUTE, 4, 3},
+            {"SBC", INS_SBC_ABS_X, ABSOLUTE_X, 4, 3},
+            {"SBC", INS_SBC_ABS_Y, ABSOLUTE_Y, 4, 3},
+            {"SBC", INS_SBC_IND_X, INDIRECT_X, 6, 2},
+            {"SBC", INS_SBC_IND_Y, INDIRECT_Y, 5, 2},
+
+            {"CMP", INS_CMP_IM, IMMEDIATE, 2, 2},
             {"CMP", INS_CMP_ZP, ZERO_PAGE, 3, 2},
             {"CMP", INS_CMP_ZP_X, ZERO_PAGE_X, 4, 2},
-            {"CMP", INS_CMP_ABS, ABSOLUTE, 4, 2},
-            {"CMP", INS_CMP_ABS_X, ABSOLUTE_X, 4, 2},
-            {"CMP", INS_CMP_ABS_Y, ABSOLUTE_Y, 4, 2},
+            {"CMP", INS_CMP_ABS, ABSOLUTE, 4, 3},
+            {"CMP", INS_CMP_ABS_X, ABSOLUTE_X, 4, 3},
+            {"CMP", INS_CMP_ABS_Y, ABSOLUTE_Y, 4, 3},
             {"CMP", INS_CMP_IND_X, INDIRECT_X, 6, 2},
             {"CMP", INS_CMP_IND_Y, INDIRECT_Y, 5, 2},
 
-            {"BRK", INS_BRK, IMPLIED, 7, 2},
-            {"NOP", INS_NOP, ZERO_PAGE_X, 1, 2},
-            {"RTI", INS_RTI, ABSOLUTE, 6, 2},
-
+            {"CPX", INS_CPX_IM, IMMEDIATE, 2, 2},
+            {"CPX", INS_CPX_ZP, ZERO_PAGE, 3, 2},
+            {"CPX", INS_CPX_ABS, ABSOLUTE, 4, 3},
+
+            {"CPY", INS_CPY_IM, IMMEDIATE, 2, 2},
+            {"CPY", INS_CPY_ZP, ZERO_PAGE, 3, 2},
+            {"CPY", INS_CPY_ABS, ABSOLUTE, 4, 3},
+
+            {"ASL", INS_ASL_A, ACCUMULATOR, 2, 1},
+            {"ASL", INS_ASL_ZP, ZERO_PAGE, 5, 2},
+            {"ASL", INS_ASL_ZP_X, ZERO_PAGE_X, 6, 2},
+            {"ASL", INS_ASL_ABS, ABSOLUTE, 6, 3},
+            {"ASL", INS_ASL_ABS_X, ABSOLUTE_X, 7, 3},
+
+            {"LSR", INS_LSR_A, ACCUMULATOR, 2, 1},
+            {"LSR", INS_LSR_ZP, ZERO_PAGE, 5, 2},
+            {"LSR", INS_LSR_ZP_X, ZERO_PAGE_X, 6, 2},
+            {"LSR", INS_LSR_ABS, ABSOLUTE, 6, 3},
+            {"LSR", INS_LSR_ABS_X, ABSOLUTE_X, 7, 3},
+
+            {"ROL", INS_ROL_A, ACCUMULATOR, 2, 1},
+            {"ROL", INS_ROL_ZP, ZERO_PAGE, 5, 2},
+            {"ROL", INS_ROL_ZP_X, ZERO_PAGE_X, 6, 2},
+            {"ROL", INS_ROL_ABS, ABSOLUTE, 6, 3},
+            {"ROL", INS_ROL_ABS_X, ABSOLUTE_X, 7, 3},
+
+            {"ROR", INS_ROR_A, ACCUMULATOR, 2, 1},
+            {"ROR", INS_ROR_ZP, ZERO_PAGE, 5, 2},
+            {"ROR", INS_ROR_ZP_X, ZERO_PAGE_X, 6, 2},
+            {"ROR", INS_ROR_ABS, ABSOLUTE, 6, 3},
+            {"ROR", INS_ROR_ABS_X, ABSOLUTE_X, 7, 3},
+
+            {"BRK", INS_BRK, IMPLIED, 7, 1},
+            {"NOP", INS_NOP, IMPLIED, 2, 1},
+            {"RTI", INS_RTI, IMPLIED, 6, 1},
     };
 
+    /*returns description of the opcode from InstructionsDataTable, nullptr for unknown opcodes*/
+    constexpr const instruction* FindInstruction(uint8_t opcode) {
+        for(const instruction& ins : InstructionsDataTable){
+            if(ins.opcode == opcode)
+                return &ins;
+        }
+        return nullptr;
+    }
 }
 
 #endif //INC_6502_PROJECT_INSTRUCTIONS_H
@@ -0,0 +1,178 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_NES_MAPPERS_H
+#define INC_6502_PROJECT_NES_MAPPERS_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "Bus.h"
+#include "ROMImage.h"
+
+namespace MOS6502 {
+    /*nametable layout selected by cartridge, used by the PPU*/
+    enum MIRRORING {
+        HORIZONTAL,
+        VERTICAL,
+        SINGLE_SCREEN_LOWER,
+        SINGLE_SCREEN_UPPER
+    };
+
+    /*
+     * PPU registers 0x2000 - 0x2007 repeated over 0x2000 - 0x3FFF of a NES bus.
+     * Every access reaches ppu with the address folded to 0x2000 - 0x2007.
+     */
+    class PPURegisterMirror : public Device {
+    public:
+        PPURegisterMirror(Bus& bus, Device& ppu);
+
+        uint8_t Read(uint16_t address) override;
+        void Write(uint16_t address, uint8_t value) override;
+
+    private:
+        Device& ppu;
+    };
+
+    /*
+     * Cartridge mapper of a NES bus, maps PRG-ROM to 0x8000 - 0xFFFF and PRG-RAM to 0x6000 - 0x7FFF.
+     * Banks are switched by pointing pages of the bus at another part of PRG-ROM, nothing is copied.
+     * Writes to PRG-ROM reach the mapper as writes to its registers.
+     * Neither bus nor mapper take ownership of PRG-ROM, it has to outlive both.
+     * Destroyed mapper leaves 0x6000 - 0xFFFF of the bus unmapped, the bus has to outlive the mapper.
+     */
+    class Mapper : public Device {
+    public:
+        static constexpr uint32_t PRG_RAM_SIZE = 0x2000;
+
+        ~Mapper() override;
+
+        //ROM pages are host memory, reads never reach the mapper
+        uint8_t Read(uint16_t) override { return 0; }
+
+        MIRRORING Mirroring() const { return mirroring; }
+
+        //battery backed on some cartridges
+        uint8_t prgRAM[PRG_RAM_SIZE]{};
+
+    protected:
+        /*
+         * Throws std::invalid_argument when prgSize is not a multiple of bankSize between minSize and maxSize,
+         * sizes are checked before anything is mapped so a rejected cartridge leaves the bus untouched.
+         */
+        Mapper(Bus& bus, uint8_t* prg, uint32_t prgSize, uint32_t bankSize, uint32_t minSize, uint32_t maxSize,
+               MIRRORING mirroring);
+
+        /*maps bank of bankSize bytes to the window starting at firstPage, bank number wraps around PRG-ROM*/
+        void MapPRG(uint8_t firstPage, uint32_t bankSize, uint32_t bank);
+        void MapPRGRAM(bool enabled, bool writable);
+
+        uint32_t PRGBanks(uint32_t bankSize) const { return prgSize / bankSize; }
+
+        Bus& bus;
+        uint8_t* prg;
+        uint32_t prgSize;
+        MIRRORING mirroring;
+    };
+
+    /*mapper 0: 16 KiB PRG-ROM mirrored at 0xC000 or 32 KiB PRG-ROM, no registers*/
+    class NROM : public Mapper {
+    public:
+        NROM(Bus& bus, uint8_t* prg, uint32_t prgSize, MIRRORING mirroring = HORIZONTAL);
+
+        void Write(uint16_t, uint8_t) override {}
+    };
+
+    /*mapper 1: 5 bit registers written one bit at a time, 16 or 32 KiB PRG banks*/
+    class MMC1 : public Mapper {
+    public:
+        MMC1(Bus& bus, uint8_t* prg, uint32_t prgSize, MIRRORING mirroring = HORIZONTAL);
+
+        void Write(uint16_t address, uint8_t value) override;
+
+        uint8_t control = 0x0C;
+        uint8_t chrBank[2]{};
+        uint8_t prgBank = 0;
+
+    private:
+        void UpdateBanks();
+
+        //bit 4 marks an empty register, it reaches bit 0 after 4 writes
+        uint8_t shift = 0x10;
+    };
+
+    /*mapper 2: 16 KiB bank switched at 0x8000, last bank fixed at 0xC000*/
+    class UxROM : public Mapper {
+    public:
+        UxROM(Bus& bus, uint8_t* prg, uint32_t prgSize, MIRRORING mirroring = HORIZONTAL);
+
+        void Write(uint16_t address, uint8_t value) override;
+    };
+
+    /*
+     * mapper 4: four 8 KiB PRG windows, two of them switched, and a scanline counter raising IRQ.
+     * Without a PPU the counter is clocked by ClockScanline.
+     */
+    class MMC3 : public Mapper {
+    public:
+        MMC3(Bus& bus, uint8_t* prg, uint32_t prgSize, MIRRORING mirroring = HORIZONTAL);
+
+        void Write(uint16_t address, uint8_t value) override;
+
+        /*clocks IRQ counter, called by the PPU once per scanline*/
+        void ClockScanline();
+
+        uint8_t bankSelect = 0;
+        //R0 - R5 select CHR banks, R6 - R7 PRG banks
+        uint8_t bankRegisters[8]{};
+
+        uint8_t irqLatch = 0;
+        uint8_t irqCounter = 0;
+        bool irqReload = false;
+        bool irqEnabled = false;
+        bool irqPending = false;
+        /*called when irqPending changes, connect it to CPU::SetIRQ (or to a wired-or of several devices)*/
+        std::function<void(bool asserted)> irqOutput{};
+
+    private:
+        void UpdateBanks();
+        void SetIRQPending(bool pending);
+    };
+
+    /*
+     * Creates mapper with iNES number mapperNumber and maps it to bus.
+     * Throws std::invalid_argument for mappers which are not implemented.
+     */
+    std::unique_ptr<Mapper> CreateMapper(uint8_t mapperNumber, Bus& bus, uint8_t* prg, uint32_t prgSize,
+                                         MIRRORING mirroring = HORIZONTAL);
+
+    /*
+     * Cartridge loaded from an iNES file, PRG-ROM is mapped to bus straight from the mapped file.
+     * Throws std::runtime_error when the file is not an iNES image, std::invalid_argument for unsupported mappers.
+     */
+    class Cartridge {
+    public:
+        static constexpr uint32_t HEADER_SIZE = 16;
+        static constexpr uint32_t TRAINER_SIZE = 512;
+        static constexpr uint32_t PRG_UNIT = 0x4000;
+        static constexpr uint32_t CHR_UNIT = 0x2000;
+
+        Cartridge(Bus& bus, const std::string& path);
+
+        Mapper& GetMapper() { return *mapper; }
+
+        uint8_t mapperNumber = 0;
+        //pattern tables for the PPU, nullptr when cartridge has CHR-RAM
+        const uint8_t* chr = nullptr;
+        uint32_t chrSize = 0;
+
+    private:
+        ROMImage image;
+        std::unique_ptr<Mapper> mapper;
+    };
+}
+
+#endif //INC_6502_PROJECT_NES_MAPPERS_H
@@ -0,0 +1,48 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_ROMIMAGE_H
+#define INC_6502_PROJECT_ROMIMAGE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Bus.h"
+
+namespace MOS6502 {
+    /*
+     * File image mapped into memory without reading it.
+     * Mapping is private: the file is never modified and pages are only copied by the kernel when host patches them.
+     * On hosts without mmap the file is read into memory instead.
+     */
+    class ROMImage {
+    public:
+        /*throws std::runtime_error when the file can not be opened or is empty*/
+        explicit ROMImage(const std::string& path);
+        ~ROMImage();
+
+        ROMImage(const ROMImage&) = delete;
+        ROMImage& operator=(const ROMImage&) = delete;
+
+        uint8_t* Data() { return data; }
+        const uint8_t* Data() const { return data; }
+        uint32_t Size() const { return size; }
+
+        /*
+         * Maps size bytes of the image starting at offset as ROM of bus, pages point into the image.
+         * size 0 maps the rest of the image. Image has to outlive the mapping.
+         * Throws std::invalid_argument when the region lies outside the image or its size is not a multiple of 256 bytes.
+         */
+        void MapTo(Bus& bus, uint8_t firstPage, uint32_t offset = 0, uint32_t size = 0, Device* registers = nullptr);
+
+    private:
+        uint8_t* data = nullptr;
+        uint32_t size = 0;
+        //used when file could not be mapped
+        std::vector<uint8_t> buffer{};
+    };
+}
+
+#endif //INC_6502_PROJECT_ROMIMAGE_H
@@ -0,0 +1,250 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_acia.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MOS6502_ACIA_POSIX 1
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr uint32_t RING_MASK = MOS6502::ACIA6551::BUFFER_SIZE - 1;
+
+#ifdef MOS6502_ACIA_POSIX
+    /*returns flags the descriptor had before*/
+    int MakeNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL);
+        if(flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+            throw std::runtime_error("ACIA6551: descriptor " + std::to_string(fd) + " can not be made non-blocking");
+        return flags;
+    }
+
+    bool WouldBlock() {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+#endif
+}
+
+MOS6502::ACIA6551::ACIA6551(Scheduler& scheduler, int inputFd, int outputFd, uint64_t pollCycles)
+    : scheduler(scheduler), pollCycles(pollCycles), inputFd(inputFd), outputFd(outputFd) {
+    if(pollCycles == 0)
+        throw std::invalid_argument("ACIA6551: poll period can not be 0 cycles");
+
+#ifdef MOS6502_ACIA_POSIX
+    if(inputFd >= 0)
+        inputFlags = MakeNonBlocking(inputFd);
+    try {
+        if(outputFd >= 0)
+            outputFlags = MakeNonBlocking(outputFd);
+    } catch(...) {
+        if(inputFlags >= 0)
+            fcntl(inputFd, F_SETFL, inputFlags);
+        throw;
+    }
+#else
+    if(inputFd >= 0 || outputFd >= 0)
+        throw std::runtime_error("ACIA6551: host descriptors need a POSIX host");
+#endif
+
+    inputEnded = inputFd < 0;
+    SchedulePoll();
+}
+
+MOS6502::ACIA6551::~ACIA6551() {
+    if(event != 0)
+        scheduler.Cancel(event);
+    Flush();
+
+#ifdef MOS6502_ACIA_POSIX
+    //the same descriptor can be both, input flags are the original ones then
+    if(outputFlags >= 0)
+        fcntl(outputFd, F_SETFL, outputFlags);
+    if(inputFlags >= 0)
+        fcntl(inputFd, F_SETFL, inputFlags);
+#endif
+}
+
+void MOS6502::ACIA6551::Reset() {
+    command = control = 0;
+    status &= ~(OVERRUN | RX_FULL);
+    ClearInterrupt();
+}
+
+void MOS6502::ACIA6551::SchedulePoll() {
+    if(inputFd < 0 && outputFd < 0)
+        return;
+
+    event = scheduler.ScheduleIn(pollCycles, [this](uint64_t){
+        event = 0;
+        Poll();
+        SchedulePoll();
+    });
+}
+
+bool MOS6502::ACIA6551::ReadInput() {
+#ifdef MOS6502_ACIA_POSIX
+    uint32_t space = BUFFER_SIZE - input.Size();
+    if(inputEnded || space == 0)
+        return false;
+
+    //free space wraps around the end of the ring at most once
+    uint32_t start = input.tail & RING_MASK;
+    uint32_t first = std::min(space, BUFFER_SIZE - start);
+    iovec parts[2] = {{&input.data[start], first}, {&input.data[0], space - first}};
+    ssize_t received = readv(inputFd, parts, space > first ? 2 : 1);
+
+    if(received > 0) {
+        input.tail += uint32_t(received);
+        return true;
+    }
+    //end of file, or an error which will not go away (closed pty gives EIO)
+    if(received == 0 || !WouldBlock())
+        inputEnded = true;
+#endif
+    return false;
+}
+
+bool MOS6502::ACIA6551::WriteOutput() {
+    if(output.Empty())
+        return false;
+#ifdef MOS6502_ACIA_POSIX
+    uint32_t size = output.Size();
+    uint32_t start = output.head & RING_MASK;
+    uint32_t first = std::min(size, BUFFER_SIZE - start);
+    iovec parts[2] = {{&output.data[start], first}, {&output.data[0], size - first}};
+    ssize_t sent = writev(outputFd, parts, size > first ? 2 : 1);
+
+    if(sent > 0) {
+        output.head += uint32_t(sent);
+        return true;
+    }
+    if(sent == 0 || WouldBlock())
+        return false;
+#endif
+    //nobody reads the output anymore, bytes are discarded
+    output.head = output.tail;
+    return false;
+}
+
+void MOS6502::ACIA6551::Poll() {
+    ReadInput();
+    WriteOutput();
+    LoadReceiver();
+}
+
+void MOS6502::ACIA6551::Flush() {
+    while(!output.Empty()) {
+        if(WriteOutput())
+            continue;
+#ifdef MOS6502_ACIA_POSIX
+        //output is full, wait until the reader takes something, give up after a second without progress
+        pollfd ready{outputFd, POLLOUT, 0};
+        if(!output.Empty() && poll(&ready, 1, 1000) <= 0)
+            return;
+#endif
+    }
+}
+
+void MOS6502::ACIA6551::LoadReceiver() {
+    if((status & RX_FULL) || input.Empty() || !TerminalReady())
+        return;
+
+    receiveData = input.Pop();
+    status |= RX_FULL;
+    if(Echo())
+        Transmit(receiveData);
+    if(ReceiverIRQEnabled())
+        Interrupt();
+}
+
+void MOS6502::ACIA6551::Transmit(uint8_t value) {
+    if(outputFd < 0)
+        return;
+    //buffer is flushed early only when the program writes faster than it is polled
+    if(output.Full())
+        WriteOutput();
+    if(!output.Full())
+        output.Push(value);
+}
+
+void MOS6502::ACIA6551::Interrupt() {
+    if(status & IRQ_FLAG)
+        return;
+    status |= IRQ_FLAG;
+    if(irqOutput)
+        irqOutput(true);
+}
+
+void MOS6502::ACIA6551::ClearInterrupt() {
+    if(!(status & IRQ_FLAG))
+        return;
+    status &= ~IRQ_FLAG;
+    if(irqOutput)
+        irqOutput(false);
+}
+
+uint8_t MOS6502::ACIA6551::Read(uint16_t address) {
+    switch(address & 0x03) {
+        case DATA: {
+            uint8_t value = receiveData;
+            status &= ~(RX_FULL | OVERRUN);
+            LoadReceiver();
+            return value;
+        }
+        case STATUS: {
+            uint8_t value = status | (output.Full() ? 0x00 : TX_EMPTY);
+            ClearInterrupt();
+            return value;
+        }
+        case COMMAND: return command;
+        default: return control;
+    }
+}
+
+bool MOS6502::ACIA6551::ReadIsStable(uint16_t address) const {
+    switch(address & 0x03) {
+        //next read would take the received byte
+        case DATA: return !(status & RX_FULL);
+        //next read would clear the IRQ flag
+        case STATUS: return !(status & IRQ_FLAG);
+        default: return true;
+    }
+}
+
+void MOS6502::ACIA6551::Write(uint16_t address, uint8_t value) {
+    switch(address & 0x03) {
+        case DATA:
+            Transmit(value);
+            //byte leaves the transmit register at once, it is empty again
+            if(TransmitterIRQEnabled())
+                Interrupt();
+            break;
+        case STATUS:
+            //programmed reset, parity settings stay
+            command &= 0xE0;
+            status &= ~OVERRUN;
+            ClearInterrupt();
+            break;
+        case COMMAND:
+            command = value;
+            if(!TerminalReady())
+                ClearInterrupt();
+            else if(TransmitterIRQEnabled() && !output.Full())
+                Interrupt();
+            LoadReceiver();
+            break;
+        case CONTROL:
+            control = value;
+            break;
+    }
+}
@@ -0,0 +1,294 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#include "6502_block_cache.h"
+#include "6502_cpu_instructions.h"
+#include "6502_superinstructions.h"
+
+#include <array>
+
+namespace {
+    /*true for instructions which never continue with the next instruction*/
+    constexpr bool EndsBlock(const MOS6502::instruction& ins) {
+        using MOS6502::IsSameMnemonic;
+        return IsSameMnemonic(ins.name, "JMP") || IsSameMnemonic(ins.name, "JSR") ||
+               IsSameMnemonic(ins.name, "RTS") || IsSameMnemonic(ins.name, "RTI") ||
+               IsSameMnemonic(ins.name, "BRK");
+    }
+
+    /*true for instructions which write memory through Bus::Write*/
+    constexpr bool WritesMemory(const MOS6502::instruction& ins) {
+        using MOS6502::IsSameMnemonic;
+        if(IsSameMnemonic(ins.name, "ASL") || IsSameMnemonic(ins.name, "LSR") ||
+           IsSameMnemonic(ins.name, "ROL") || IsSameMnemonic(ins.name, "ROR"))
+            return ins.addressingMode != MOS6502::ACCUMULATOR;
+        return IsSameMnemonic(ins.name, "STA") || IsSameMnemonic(ins.name, "STX") ||
+               IsSameMnemonic(ins.name, "STY") || IsSameMnemonic(ins.name, "INC") ||
+               IsSameMnemonic(ins.name, "DEC") || IsSameMnemonic(ins.name, "PHA") ||
+               IsSameMnemonic(ins.name, "PHP") || IsSameMnemonic(ins.name, "JSR") ||
+               IsSameMnemonic(ins.name, "BRK");
+    }
+
+    /*what decoder needs to know about an opcode*/
+    struct OpcodeInfo {
+        uint8_t bytes = 1;
+        //base cost, page crossing and taken branch add at most 2 more
+        uint8_t cycles = 1;
+        bool writesMemory = false;
+        bool branches = false;
+        //unknown opcodes trap, so they end the block too
+        bool endsBlock = true;
+    };
+
+    constexpr std::array<OpcodeInfo, 256> fillOpcodeInfoTable() {
+        std::array<OpcodeInfo, 256> table{};
+        for(const MOS6502::instruction& ins : MOS6502::InstructionsDataTable){
+            table[ins.opcode] = {ins.bytes, ins.cycles, WritesMemory(ins),
+                                 ins.addressingMode == MOS6502::RELATIVE, EndsBlock(ins)};
+        }
+        return table;
+    }
+
+    //indexed by opcode, so decoding does not search InstructionsDataTable
+    constexpr std::array<OpcodeInfo, 256> opcodeInfoTable = fillOpcodeInfoTable();
+
+    /*first instruction of a fused pair has to continue with the second one*/
+    constexpr bool CanBeFused(uint8_t first, uint8_t second) {
+        return !opcodeInfoTable[first].endsBlock && !opcodeInfoTable[first].branches &&
+               MOS6502::FindInstruction(first) != nullptr && MOS6502::FindInstruction(second) != nullptr;
+    }
+
+#define CHECK_FUSED_PAIR(first, second) \
+    static_assert(CanBeFused(first, second), "MOS6502_FUSED_PAIRS: " #first " can not be fused with " #second);
+    MOS6502_FUSED_PAIRS(CHECK_FUSED_PAIR)
+#undef CHECK_FUSED_PAIR
+}
+
+MOS6502::BlockCache::BlockCache() : blocks(0x10000) {}
+
+void MOS6502::BlockCache::Flush() {
+    for(auto& block : blocks)
+        block.reset();
+}
+
+void MOS6502::BlockCache::Decode(Block& block, uint16_t address, const Bus& memory, const Labels& labels) {
+    block.count = 0;
+    block.maxCycles = 0;
+
+    //block is checked against generations of two pages only, devices can change code without writes
+    auto cannotBeDecoded = [address, &memory](uint32_t PC, uint8_t bytes) {
+        return ((PC + bytes - 1) >> 8) > (address >> 8) + 1u ||
+               !memory.IsHostMemory(PC) || !memory.IsHostMemory(PC + bytes - 1);
+    };
+
+    //bytes following the opcode at PC, lowest byte is fetched first
+    auto readOperands = [&memory](uint32_t PC, uint8_t bytes) {
+        uint32_t operands = 0;
+        for(uint8_t i = 1; i < bytes; i++)
+            operands |= uint32_t(memory[uint16_t(PC + i)]) << (8 * (i - 1));
+        return operands;
+    };
+
+    uint32_t PC = address;
+    for(int count = 0; count < MAX_BLOCK_INSTRUCTIONS; count++){
+        uint8_t opcode = memory[PC];
+        const OpcodeInfo& info = opcodeInfoTable[opcode];
+
+        //first instruction outside host memory leaves the block empty, so it gets interpreted
+        if(cannotBeDecoded(PC, info.bytes))
+            break;
+
+        uint32_t operands = readOperands(PC, info.bytes);
+        PC += info.bytes;
+        DecodedInstruction decoded = {
+                CPU::instructionsLookupTable[opcode],
+                labels.opcodes != nullptr ? labels.opcodes[opcode] : nullptr,
+                operands,
+                uint16_t(PC),
+                info.cycles,
+                info.writesMemory,
+                info.branches
+        };
+        int32_t maxCycles = info.cycles + 2;
+        bool endsBlock = info.endsBlock;
+
+        //pair takes a single entry, its second half decides how the block continues
+        if(!info.endsBlock && !info.branches && PC < Bus::MAX_MEM) {
+            uint8_t nextOpcode = memory[PC];
+            const OpcodeInfo& nextInfo = opcodeInfoTable[nextOpcode];
+
+            for(size_t i = 0; i < labels.fusedCount; i++){
+                const FusedLabel& fused = labels.fused[i];
+                if(fused.first != opcode || fused.second != nextOpcode || cannotBeDecoded(PC, nextInfo.bytes))
+                    continue;
+
+                //second half takes its operand bytes after the ones of the first half
+                operands |= readOperands(PC, nextInfo.bytes) << (8 * (info.bytes - 1));
+                PC += nextInfo.bytes;
+                decoded = {nullptr, fused.label, operands, uint16_t(PC), uint8_t(info.cycles + nextInfo.cycles),
+                           nextInfo.writesMemory, nextInfo.branches};
+                maxCycles += nextInfo.cycles + 2;
+                endsBlock = nextInfo.endsBlock;
+                break;
+            }
+        }
+
+        block.instructions[block.count++] = decoded;
+        block.maxCycles += maxCycles;
+
+        if(endsBlock)
+            break;
+    }
+    block.instructions[block.count] = {nullptr, labels.blockEnd, 0, 0, 0, false, false};
+
+    block.firstPage = address >> 8;
+    block.lastPage = ((block.count > 0 ? PC - 1 : address) >> 8) & 0xFF;
+    block.firstPageGeneration = memory.pageGeneration[block.firstPage];
+    block.lastPageGeneration = memory.pageGeneration[block.lastPage];
+    block.hostWriteEpoch = memory.hostWriteEpoch;
+}
+
+MOS6502::BlockCache::Block& MOS6502::BlockCache::GetBlock(uint16_t address, const Bus& memory, const Labels& labels) {
+    std::unique_ptr<Block>& block = blocks[address];
+    if(block == nullptr) {
+        block = std::make_unique<Block>();
+        Decode(*block, address, memory, labels);
+    } else if(!block->IsValid(memory)) {
+        Decode(*block, address, memory, labels);
+    }
+    return *block;
+}
+
+int32_t MOS6502::BlockCache::Execute(CPU& cpu, int32_t cycles, Bus& memory) {
+    //blocks hold labels of the engine which decoded them
+    if(memory.flat != decodedForFlatBus) {
+        Flush();
+        decodedForFlatBus = memory.flat;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    if(memory.flat) {
+        FlatBus flatMemory(memory);
+        return ExecuteOn(cpu, cycles, memory, flatMemory);
+    }
+#endif
+    return ExecuteOn(cpu, cycles, memory, memory);
+}
+
+template<typename Memory>
+int32_t MOS6502::BlockCache::ExecuteOn(CPU& cpu, int32_t cycles, Bus& bus, Memory& memory) {
+    int32_t totalCycles = cycles;
+    cpu.LoadLazyFlags();
+
+#if defined(__GNUC__) || defined(__clang__)
+    //handlers are inlined under their own labels like in CPU::ExecuteThreaded, blocks store label addresses
+#define OPCODE_LABEL_ADDRESS(opcode) &&opcode_##opcode,
+    static void* const dispatchTable[256] = { FOR_EACH_OPCODE(OPCODE_LABEL_ADDRESS) };
+#undef OPCODE_LABEL_ADDRESS
+#define FUSED_LABEL_ADDRESS(first, second) {first, second, &&fused_##first##_##second},
+    static const FusedLabel fusedTable[] = { MOS6502_FUSED_PAIRS(FUSED_LABEL_ADDRESS) {0, 0, nullptr} };
+#undef FUSED_LABEL_ADDRESS
+    //last entry of fusedTable only keeps the array non-empty when fusion is disabled
+    const Labels labels{dispatchTable, &&nextBlock, fusedTable, std::size(fusedTable) - 1};
+
+    //inlined handlers take operand bytes from the decoded instruction, only the opcode fetch is counted here
+    DecodedOperandBus<Memory> operandBus{memory};
+    const Block* block;
+    const DecodedInstruction* decoded;
+    //budget outlasts the whole block, cycles don't have to be checked before each instruction
+    bool checkCycles;
+
+    //taken branch leaves the block, so does a write to code of the block
+#define DISPATCH_NEXT() \
+    if(decoded->branches && cpu.PC != decoded->nextPC) goto nextBlock; \
+    if(decoded->writesMemory && !block->IsCodeUnchanged(bus)) goto nextBlock; \
+    decoded++; \
+    if(checkCycles && cycles <= 0) goto nextBlock; \
+    goto *decoded->label;
+
+    //opcode is already decoded, only PC and cycles of its fetch are taken
+#define OPCODE_LABEL(opcode) \
+    opcode_##opcode: \
+    cpu.PC++; \
+    cycles--; \
+    operandBus.operands = decoded->operands; \
+    CPU::Instruction<opcode, DecodedOperandBus<Memory>>(cpu, cycles, operandBus); \
+    DISPATCH_NEXT()
+
+    //both halves run in one dispatch, block can still be left between them like between two entries
+#define FUSED_LABEL(first, second) \
+    fused_##first##_##second: \
+    cpu.PC++; \
+    cycles--; \
+    operandBus.operands = decoded->operands; \
+    CPU::Instruction<first, DecodedOperandBus<Memory>>(cpu, cycles, operandBus); \
+    if constexpr (opcodeInfoTable[first].writesMemory) { \
+        if(!block->IsCodeUnchanged(bus)) goto nextBlock; \
+    } \
+    if(checkCycles && cycles <= 0) goto nextBlock; \
+    cpu.PC++; \
+    cycles--; \
+    CPU::Instruction<second, DecodedOperandBus<Memory>>(cpu, cycles, operandBus); \
+    DISPATCH_NEXT()
+
+nextBlock:
+    if(cycles <= 0)
+        goto finished;
+    block = &GetBlock(cpu.PC, bus, labels);
+    if(block->count == 0) {
+        uint8_t opcode = cpu.Fetch8Bits(cycles, memory);
+        CPU::LookupTable<Memory>()[opcode](cpu, cycles, memory);
+        goto nextBlock;
+    }
+    checkCycles = cycles <= block->maxCycles;
+    decoded = block->instructions;
+    goto *decoded->label;
+
+    FOR_EACH_OPCODE(OPCODE_LABEL)
+    MOS6502_FUSED_PAIRS(FUSED_LABEL)
+
+#undef FUSED_LABEL
+#undef OPCODE_LABEL
+#undef DISPATCH_NEXT
+
+finished:
+#else
+    //pairs are fused and operands taken from decoded instructions only by inlined handlers
+    const Labels labels{nullptr, nullptr, nullptr, 0};
+
+    while(cycles > 0){
+        const Block& block = GetBlock(cpu.PC, bus, labels);
+        if(block.count == 0) {
+            uint8_t opcode = cpu.Fetch8Bits(cycles, bus);
+            CPU::instructionsLookupTable[opcode](cpu, cycles, bus);
+            continue;
+        }
+        bool checkCycles = cycles <= block.maxCycles;
+
+        for(int32_t i = 0; i < block.count; i++){
+            const DecodedInstruction& decoded = block.instructions[i];
+            if(checkCycles && cycles <= 0)
+                break;
+
+            cpu.PC++;
+            cycles--;
+            decoded.handler(cpu, cycles, bus);
+
+            if(decoded.branches && cpu.PC != decoded.nextPC)
+                break;
+            if(decoded.writesMemory && !block.IsCodeUnchanged(bus))
+                break;
+        }
+    }
+#endif
+
+    cpu.StoreLazyFlags();
+
+    if(cpu.unknownInstructionTrapped){
+        cpu.unknownInstructionTrapped = false;
+        return -1;
+    }
+
+    return totalCycles - cycles;
+}
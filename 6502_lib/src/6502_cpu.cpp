@@ -1,8 +1,11 @@
 //
 // Created by Lukasz on 25.07.2022.
 //
-#include <stdexcept>
-#include "6502_cpu.h"
+#include "6502_cpu_instructions.h"
+#include "6502_profiler.h"
+#include "6502_trace.h"
+
+#include <algorithm>
 
 void MOS6502::CPU::Reset(int32_t& cycles, Bus& memory) {
     PC = 0xFFFC;
@@ -10,456 +13,362 @@ void MOS6502::CPU::Reset(int32_t& cycles, Bus& memory) {
     S = 0xFF;
     P.C = P.Z = P.I = P.D = P.B = P.V = P.N = 0;
     A = X = Y = 0;
+    //lines stay as devices hold them, NMI edge seen before reset is dropped
+    nmiPending = interruptPoll = interruptPollDelayed = false;
 
     uint16_t firstInstructionAddress = Fetch16Bits(cycles, memory);
     PC = firstInstructionAddress;
     cycles -= 5;
 }
 
-MOS6502::CPU::CPU() {
-    fillInstructionsLookupTable();
-}
-
 void MOS6502::CPU::Setup(Bus &memory, uint16_t resetVectorValue) {
     memory.Initialise();
     memory[0xFFFC] = resetVectorValue & 0xFF;
     memory[0xFFFD] = resetVectorValue >> 8;
 }
 
-uint16_t MOS6502::CPU::Fetch8Bits(int32_t& cycles, const Bus& memory){
-    uint8_t byte = memory[PC];
-    PC++;
-    cycles--;
-    return byte;
+MOS6502::CPUState MOS6502::CPU::SaveState() const {
+    //engines store lazy flags before returning, P is up to date between runs
+    return CPUState{PC, S, A, X, Y, P.PS};
 }
 
-uint16_t MOS6502::CPU::Fetch16Bits(int32_t& cycles, const Bus& memory){
-    uint8_t lowByte = memory.RAM[PC];
-    PC++;
-    uint8_t highByte = memory.RAM[PC];
-    PC++;
-
-    cycles -= 2;
-
-    uint16_t result = lowByte;
-    result |= (highByte << 8);
-
-    return result;
+void MOS6502::CPU::LoadState(const CPUState& state) {
+    PC = state.PC;
+    S = state.S;
+    A = state.A;
+    X = state.X;
+    Y = state.Y;
+    P.PS = state.P;
 }
 
-uint8_t MOS6502::CPU::Read8Bits(int32_t& cycles, const Bus& memory, uint16_t address){
-    uint8_t byte = memory.RAM[address];
-    cycles--;
-    return byte;
+void MOS6502::CPU::SetIRQ(bool asserted) {
+    irqLine = asserted;
+    if(asserted && !P.I)
+        RequestInterruptPoll(false);
 }
 
-uint16_t MOS6502::CPU::Read16Bits(int32_t& cycles, const Bus& memory, uint16_t address){
-    uint8_t lowByte = memory.RAM[address];
-    uint8_t highByte = memory.RAM[address + 1];
-
-    cycles -= 2;
-
-    uint16_t result = lowByte;
-    result |= (highByte << 8);
-
-    return result;
+void MOS6502::CPU::SetNMI(bool asserted) {
+    if(asserted && !nmiLine) {
+        nmiPending = true;
+        RequestInterruptPoll(false);
+    }
+    nmiLine = asserted;
 }
 
-void MOS6502::CPU::Write8Bits(int32_t& cycles, Bus& memory, uint16_t address, uint8_t value){
-    memory[address] = value;
-    cycles--;
-}
+void MOS6502::CPU::RequestInterruptPoll(bool delayed) {
+    interruptPoll = true;
+    interruptPollDelayed = delayed;
+    if(cycleCounter == nullptr)
+        return;
+    ForgetIdleLoop();
 
-void MOS6502::CPU::Write16Bits(int32_t& cycles, Bus& memory, uint16_t address, uint16_t value){
-    memory[address] = (value & 0xFF);
-    memory[address + 1] = (value >> 8);
-    cycles -= 2;
+    //one instruction is left in the counter when delayed
+    int32_t remaining = delayed ? 1 : 0;
+    deferredCycles += *cycleCounter - remaining;
+    *cycleCounter = remaining;
 }
 
-void MOS6502::CPU::StackPush8Bits(int32_t &cycles, MOS6502::Bus &memory, uint8_t value) {
-    Write8Bits(cycles, memory, stackLocation + S, value);
-    S -= 1;
-}
+void MOS6502::CPU::ShortenSlice(int32_t remainingCycles) {
+    if(cycleCounter == nullptr)
+        return;
 
-void MOS6502::CPU::StackPush16Bits(int32_t &cycles, MOS6502::Bus &memory, uint16_t value) {
-    Write16Bits(cycles, memory, stackLocation + S - 1, value);
-    S -= 2;
-}
+    int32_t excess = *cycleCounter + deferredCycles - remainingCycles;
+    if(excess <= 0)
+        return;
+    //counter jumps, cycles of the watched loop would be measured wrong
+    ForgetIdleLoop();
 
-uint8_t MOS6502::CPU::StackPop8Bits(int32_t &cycles, Bus& memory) {
-    S += 1;
-    uint8_t value = Read8Bits(cycles, memory, stackLocation + S);
-    return value;
+    //cycles set aside for an interrupt go first, so an instruction delaying the interrupt still runs
+    int32_t fromDeferred = std::min(excess, std::max(deferredCycles, 0));
+    deferredCycles -= fromDeferred;
+    *cycleCounter -= excess - fromDeferred;
+    sliceCycles -= excess;
 }
 
-uint16_t MOS6502::CPU::StackPop16Bits(int32_t &cycles, Bus& memory) {
-    S += 2;
-    uint16_t value = Read16Bits(cycles, memory, stackLocation + S - 1);
-    return value;
+int32_t MOS6502::CPU::Execute(int32_t cycles, Bus& memory){
+    if(tracer != nullptr) {
+        if(memory.flat) {
+            FlatBus flatMemory(memory);
+            TracingBus<FlatBus> tracingMemory{flatMemory, memory, *tracer};
+            return ExecuteTraced(cycles, tracingMemory);
+        }
+        TracingBus<Bus> tracingMemory{memory, memory, *tracer};
+        return ExecuteTraced(cycles, tracingMemory);
+    }
+#if MOS6502_PROFILER
+    //profiled loop is a separate instantiation, the usual one is left as it is
+    if(profiler != nullptr) {
+        if(memory.flat) {
+            FlatBus flatMemory(memory);
+            return ExecuteOn<FlatBus, true>(cycles, flatMemory);
+        }
+        return ExecuteOn<Bus, true>(cycles, memory);
+    }
+#endif
+    if(memory.flat) {
+        FlatBus flatMemory(memory);
+        return ExecuteOn(cycles, flatMemory);
+    }
+    return ExecuteOn(cycles, memory);
 }
 
+template<typename Memory, bool profiled>
+void MOS6502::CPU::EnterInterruptRecorded(int32_t& cycles, Memory& memory){
+    if constexpr(profiled || isTracingBus<Memory>) {
+        int32_t cyclesBefore = cycles;
+        //slot is reserved again by the next instruction when no interrupt is entered
+        if constexpr(isTracingBus<Memory>)
+            memory.BeginInstruction(PC, A, X, Y, S, GetStatus());
 
-uint8_t MOS6502::CPU::getZeroPageAddress(int32_t& cycles, const Bus &memory){
-    return Fetch8Bits(cycles, memory);
-}
-
-uint8_t MOS6502::CPU::getZeroPageAddressX(int32_t &cycles, const Bus &memory) {
-    cycles--; // add X register to address
-    return getZeroPageAddress(cycles, memory) + X;
-}
+        uint16_t vector = EnterInterrupt(cycles, memory);
+        if(vector == 0)
+            return;
 
-uint8_t MOS6502::CPU::getZeroPageAddressY(int32_t &cycles, const Bus &memory) {
-    cycles--; // add Y register to address
-    return getZeroPageAddress(cycles, memory) + Y;
+        if constexpr(isTracingBus<Memory>)
+            memory.EndInterrupt(vector, PC, uint32_t(cyclesBefore - cycles));
+        if constexpr(profiled)
+            profiler->Interrupt(vector, PC, uint32_t(cyclesBefore - cycles));
+    } else {
+        EnterInterrupt(cycles, memory);
+    }
 }
 
-uint16_t MOS6502::CPU::getAbsoluteAddress(int32_t& cycles, const Bus& memory){
-    return Fetch16Bits(cycles, memory);
-}
+template<typename Memory, bool profiled>
+int32_t MOS6502::CPU::ExecuteOn(int32_t cycles, Memory& memory){
+    sliceCycles = cycles;
+    LoadLazyFlags();
+    const auto& lookupTable = LookupTable<Memory>();
+
+    //loops are measured within one call, nothing observes single instructions when they are skipped
+    idleSkipping = skipIdleLoops && !profiled && !isTracingBus<Memory>;
+    ForgetIdleLoop();
+
+    //lines set outside of Execute are seen here, lines set by devices while it runs end the loop below
+    CycleCounterScope counterScope{*this, cycles};
+    while(true){
+        if(interruptPoll) [[unlikely]] {
+            cycles += deferredCycles;
+            deferredCycles = 0;
+            EnterInterruptRecorded<Memory, profiled>(cycles, memory);
+            ForgetIdleLoop();
+        }
 
-uint16_t MOS6502::CPU::getAbsoluteAddressX(int32_t& cycles, const Bus& memory, bool checkPageCrossing){
-    uint16_t absoluteAddress = getAbsoluteAddress(cycles, memory);
-    if(checkPageCrossing &&(absoluteAddress & 0xFF) + X > 0xFF)
-        cycles--; // page crossed
-    return absoluteAddress + X;
-}
+        while(cycles > 0){
+            if constexpr(profiled || isTracingBus<Memory>) {
+                uint16_t instructionPC = PC;
+                int32_t cyclesBefore = cycles;
+                if constexpr(isTracingBus<Memory>)
+                    memory.BeginInstruction(PC, A, X, Y, S, GetStatus());
+
+                uint8_t instruction = Fetch8Bits(cycles, memory);
+                lookupTable[instruction](*this, cycles, memory);
+
+                if constexpr(isTracingBus<Memory>)
+                    memory.EndInstruction(uint32_t(cyclesBefore - cycles));
+                if constexpr(profiled)
+                    profiler->Record(instructionPC, instruction, cyclesBefore - cycles, PC);
+            } else {
+                uint8_t instruction = Fetch8Bits(cycles, memory);
+                lookupTable[instruction](*this, cycles, memory);
+            }
+        }
 
-uint16_t MOS6502::CPU::getAbsoluteAddressY(int32_t& cycles, const Bus& memory, bool checkPageCrossing){
-    uint16_t absoluteAddress = getAbsoluteAddress(cycles, memory);
-    if(checkPageCrossing &&(absoluteAddress & 0xFF) + Y > 0xFF)
-        cycles--; // page crossed
-    return absoluteAddress + Y;
-}
+        //cycles > 0 is the only check made per instruction, interrupt request zeroes the counter
+        if(!interruptPoll || unknownInstructionTrapped)
+            break;
+    }
+    cycles += deferredCycles;
+    deferredCycles = 0;
 
-uint16_t MOS6502::CPU::getIndirectIndexedAddressX(int32_t &cycles, const MOS6502::Bus &memory) {
-    cycles--; // add X register to address
-    return Read16Bits(cycles, memory, uint8_t(getZeroPageAddress(cycles, memory) + X));
-}
+    StoreLazyFlags();
 
-uint16_t MOS6502::CPU::getIndexedIndirectAddressY(int32_t &cycles, const MOS6502::Bus &memory, bool checkPageCrossing) {
-    uint16_t targetAddress = Read16Bits(cycles, memory, Fetch8Bits(cycles, memory));
-    if(checkPageCrossing && (targetAddress & 0xFF) + Y >= 0xFF)
-        cycles--; //page crossed
-    return targetAddress + Y;
-}
+    if(unknownInstructionTrapped){
+        unknownInstructionTrapped = false;
+        cyclesBeforeTrap = sliceCycles - (cycles + cyclesLeftAtTrap);
+        return -1;
+    }
 
-void MOS6502::CPU::SetStatusNZ(uint8_t& reg){
-    P.Z = (reg == 0);
-    P.N = (reg & NegativeBitFlag) != 0;
+    return sliceCycles - cycles;
 }
 
-uint16_t MOS6502::CPU::GetAddress(ADDRESSING_MODE mode, int32_t& cycles, const Bus& memory, bool checkPageCrossing){
-    uint16_t address;
-
-    switch(mode){
-
-        case ZERO_PAGE: {
-            address = getZeroPageAddress(cycles, memory);
-            break;
-        }
-        case ZERO_PAGE_X: {
-            address = getZeroPageAddressX(cycles, memory);
-            break;
-        }
-        case ZERO_PAGE_Y: {
-            address = getZeroPageAddressY(cycles, memory);
-            break;
-        }
-        case ABSOLUTE: {
-            address = getAbsoluteAddress(cycles, memory);
-            break;
-        }
-        case ABSOLUTE_X: {
-            address = getAbsoluteAddressX(cycles, memory, checkPageCrossing);
-            break;
-        }
-        case ABSOLUTE_Y: {
-            address = getAbsoluteAddressY(cycles, memory, checkPageCrossing);
-            break;
-        }
-        case INDIRECT_X: {
-            address = getIndirectIndexedAddressX(cycles, memory);
-            break;
-        }
-        case INDIRECT_Y: {
-            address = getIndexedIndirectAddressY(cycles, memory, checkPageCrossing);
-            break;
+MOS6502::RunResult MOS6502::CPU::Run(const RunLimits& limits, Bus& memory) {
+    if(tracer != nullptr) {
+        if(memory.flat) {
+            FlatBus flatMemory(memory);
+            TracingBus<FlatBus> tracingMemory{flatMemory, memory, *tracer};
+            return RunTraced(limits, memory, tracingMemory);
         }
-        default: {
-            printf("Unhandled load addressing mode: %d", mode);
-            throw std::runtime_error("Unhandled load addressing mode");
+        TracingBus<Bus> tracingMemory{memory, memory, *tracer};
+        return RunTraced(limits, memory, tracingMemory);
+    }
+#if MOS6502_PROFILER
+    if(profiler != nullptr) {
+        if(memory.flat) {
+            FlatBus flatMemory(memory);
+            return RunOn<FlatBus, true>(limits, memory, flatMemory);
         }
+        return RunOn<Bus, true>(limits, memory, memory);
     }
-
-    return address;
+#endif
+    if(memory.flat) {
+        FlatBus flatMemory(memory);
+        return RunOn(limits, memory, flatMemory);
+    }
+    return RunOn(limits, memory, memory);
 }
 
-void MOS6502::CPU::LoadRegister(ADDRESSING_MODE mode, int32_t& cycles, const Bus& memory, uint8_t& reg){
-   if(mode == IMMEDIATE)
-       reg = Fetch8Bits(cycles, memory);
-   else
-       reg = Read8Bits(cycles, memory, GetAddress(mode, cycles, memory, true));
-    SetStatusNZ(reg);
+template<typename Memory>
+int32_t MOS6502::CPU::ExecuteTraced(int32_t cycles, Memory& memory){
+#if MOS6502_PROFILER
+    if(profiler != nullptr)
+        return ExecuteOn<Memory, true>(cycles, memory);
+#endif
+    return ExecuteOn(cycles, memory);
 }
 
-void MOS6502::CPU::StoreRegister(ADDRESSING_MODE mode, int32_t &cycles, Bus &memory, uint8_t &reg) {
-    Write8Bits(cycles, memory, GetAddress(mode, cycles, memory, false), reg);
-    if(mode == ABSOLUTE_X || mode == ABSOLUTE_Y || mode == INDIRECT_Y)
-        cycles--;
+template<typename Memory>
+MOS6502::RunResult MOS6502::CPU::RunTraced(const RunLimits& limits, const Bus& bus, Memory& memory){
+#if MOS6502_PROFILER
+    if(profiler != nullptr)
+        return RunOn<Memory, true>(limits, bus, memory);
+#endif
+    return RunOn(limits, bus, memory);
 }
 
+template<typename Memory, bool profiled>
+MOS6502::RunResult MOS6502::CPU::RunOn(const RunLimits& limits, const Bus& bus, Memory& memory) {
+    RunResult result{STOP_REASON::CYCLES, 0, 0, 0};
+    LoadLazyFlags();
+    const auto& lookupTable = LookupTable<Memory>();
 
-void MOS6502::CPU::PerformLogicalOnAccumulator(ADDRESSING_MODE mode, MOS6502::CPU::LOGICAL_OPERATION operation, int32_t &cycles,
-                                               MOS6502::Bus &memory) {
-    uint8_t value;
-    if(mode == IMMEDIATE)
-        value = Fetch8Bits(cycles, memory);
-    else
-        value = Read8Bits(cycles, memory, GetAddress(mode, cycles, memory, true));
-
-    switch (operation) {
-        case LOGICAL_OPERATION::AND: {
-            A = (A & value);
-            SetStatusNZ(A);
+    while(true){
+        if(limits.cycles != 0 && result.cycles >= limits.cycles) {
+            result.reason = STOP_REASON::CYCLES;
             break;
         }
-        case LOGICAL_OPERATION::XOR: {
-            A = (A ^ value);
-            SetStatusNZ(A);
+        if(limits.instructions != 0 && result.instructions >= limits.instructions) {
+            result.reason = STOP_REASON::INSTRUCTIONS;
             break;
         }
-        case LOGICAL_OPERATION::OR: {
-            A = (A | value);
-            SetStatusNZ(A);
+        if(limits.targetPC.has_value() && PC == *limits.targetPC) {
+            result.reason = STOP_REASON::TARGET_PC;
             break;
         }
-        case LOGICAL_OPERATION::BIT: {
-            P.Z = ((A & value) == 0);
-            P.V = (value & OverflowBitFlag) != 0;
-            P.N = (value & NegativeBitFlag) != 0;
-            break;
-        }
-        default: {
-            printf("Unhandled operation: %d", static_cast<int>(operation));
-            throw std::runtime_error("Unhandled load addressing mode");
-        }
-    }
-}
-
-void MOS6502::CPU::IncrementDecrementValue(MOS6502::ADDRESSING_MODE mode,
-                                                    MOS6502::CPU::MATH_OPERATION operation, int32_t &cycles,
-                                                    MOS6502::Bus &memory) {
-    if(mode == IMPLIED_X){
-        if(operation == MATH_OPERATION::INCREMENT)
-            X++;
-        else if(operation == MATH_OPERATION::DECREMENT)
-            X--;
-        else
-            throw std::runtime_error("INVALID MATH OPERATION FOR THIS METHOD");
-        cycles--;
-        SetStatusNZ(X);
-    } else if (mode == IMPLIED_Y) {
-        if(operation == MATH_OPERATION::INCREMENT)
-            Y++;
-        else if(operation == MATH_OPERATION::DECREMENT)
-            Y--;
-        else
-            throw std::runtime_error("INVALID MATH OPERATION FOR THIS METHOD");
-        cycles--;
-        SetStatusNZ(Y);
-    } else {
-        uint16_t address = GetAddress(mode, cycles, memory, false);
-        uint8_t value = Read8Bits(cycles, memory, address);
-        if(operation == MATH_OPERATION::INCREMENT)
-            value++;
-        else if(operation == MATH_OPERATION::DECREMENT)
-            value--;
-        else
-            throw std::runtime_error("INVALID MATH OPERATION FOR THIS METHOD");
-
-        cycles--;
-        if(mode == ABSOLUTE_X)
-            cycles--;
-        Write8Bits(cycles, memory, address, value);
-        SetStatusNZ(value);
-    }
-}
-
-//A - A register, M - operand, R - result, 0,1 - most significant bit of each component
-// A  M  R | V | A^R | A^M |~(A^M) |
-// 0  0  0 | 0 |  0  |  0  |   1   |
-// 0  0  1 | 1 |  1  |  0  |   1   |
-// 0  1  0 | 0 |  0  |  1  |   0   |
-// 0  1  1 | 0 |  1  |  1  |   0   |  so V = ~(A^M) & (A^R)
-// 1  0  0 | 0 |  1  |  1  |   0   |
-// 1  0  1 | 0 |  0  |  1  |   0   |
-// 1  1  0 | 1 |  1  |  0  |   1   |
-// 1  1  1 | 0 |  0  |  0  |   1   |
-
-void MOS6502::CPU::PerformAddSubtractOnAccumulator(MOS6502::ADDRESSING_MODE mode, MOS6502::CPU::MATH_OPERATION operation, int32_t &cycles, MOS6502::Bus &memory) {
-    uint16_t operand;
-    if (mode == IMMEDIATE)
-        operand = Fetch8Bits(cycles, memory);
-    else
-        operand = Read8Bits(cycles, memory, GetAddress(mode, cycles, memory, true));
-
-    uint16_t result;
-
-    if (P.D == 1) {
-        int m = 1;
-
-        if(operation == MATH_OPERATION::SUBTRACT) {
-            m = -1;
-            P.C = !P.C;
-        } else if(operation != MATH_OPERATION::ADD)
-            throw std::runtime_error("INVALID MATH OPERATION FOR THIS METHOD");
-
-        uint8_t accumulatorLow = LOW_NYBBLE(A) + LOW_NYBBLE(operand)*m + P.C*m;
-        uint8_t accumulatorHigh = HIGH_NYBBLE(A) + HIGH_NYBBLE(operand)*m;
-
-        if(accumulatorLow > 9) {
-            accumulatorLow += 6 * m;
-            accumulatorLow &= 0xF;
-            accumulatorHigh += 1*m;
+        if(limits.predicate) {
+            //predicate may read P
+            StoreLazyFlags();
+            if(limits.predicate(*this, bus)) {
+                result.reason = STOP_REASON::PREDICATE;
+                break;
+            }
         }
 
-        if(operation == MATH_OPERATION::ADD)
-            P.C = 0;
-        else
-            P.C = 1;
-
-        if(accumulatorHigh > 9) {
-            accumulatorHigh += 6 * m;
-            accumulatorHigh &= 0xF;
-            if(operation == MATH_OPERATION::ADD)
-                P.C = 1;
-            else
-                P.C = 0;
+        //handlers only count cycles down, so each instruction starts from 0
+        int32_t cycles = 0;
+        if(interruptPoll) [[unlikely]] {
+            if(interruptPollDelayed) {
+                //instruction after CLI or PLP runs before the interrupt
+                interruptPollDelayed = false;
+            }
+            else {
+                EnterInterruptRecorded<Memory, profiled>(cycles, memory);
+                result.cycles += uint32_t(-cycles);
+                continue;
+            }
         }
 
-        result = (accumulatorHigh << 4) + LOW_NYBBLE(accumulatorLow);
-    } else {
-        if(operation == MATH_OPERATION::SUBTRACT)
-            operand = operand ^ 0x00FF;
-        else if(operation != MATH_OPERATION::ADD)
-            throw std::runtime_error("INVALID MATH OPERATION FOR THIS METHOD");
-
-
-        result = A + operand + P.C;
-        P.C = (result & 0xFF00) > 0;
-    }
-
-    P.V = ((!(MSB(A)^MSB(operand))) & (MSB(A)^MSB(uint8_t(result))));
-    A = (result & 0xFF);
-    SetStatusNZ(A);
-}
+        uint16_t instructionPC = PC;
+        if constexpr(isTracingBus<Memory>)
+            memory.BeginInstruction(PC, A, X, Y, S, GetStatus());
 
-void MOS6502::CPU::BranchIf(int32_t &cycles, MOS6502::Bus &memory, bool flag, bool expectedState) {
-    auto offset = static_cast<int8_t>(Fetch8Bits(cycles, memory));
-
-    if(flag == expectedState){
-        cycles--;
-        if((PC >> 8) != ((PC + offset) >> 8))
-            cycles--; // page crossed
-        PC += offset;
-    }
-}
+        uint8_t instruction = Fetch8Bits(cycles, memory);
+        lookupTable[instruction](*this, cycles, memory);
 
-void MOS6502::CPU::CompareWithRegister(MOS6502::ADDRESSING_MODE mode, int32_t &cycles, MOS6502::Bus &memory, uint8_t &reg) {
-    uint8_t operand;
-    if(mode == IMMEDIATE)
-        operand = Fetch8Bits(cycles, memory);
-    else
-        operand = Read8Bits(cycles, memory, GetAddress(mode, cycles, memory, true));
-
-    uint8_t result = reg - operand;
-    P.N = (result & NegativeBitFlag) > 0;
-    P.Z = (reg == operand);
-    P.C = (reg >= operand);
-}
+        if constexpr(isTracingBus<Memory>)
+            memory.EndInstruction(uint32_t(-cycles));
+        if constexpr(profiled)
+            profiler->Record(instructionPC, instruction, uint32_t(-cycles), PC);
 
-void MOS6502::CPU::ShiftValue(MOS6502::ADDRESSING_MODE mode, MOS6502::CPU::MATH_OPERATION operation, int32_t &cycles, MOS6502::Bus &memory) {
-    uint8_t operand;
-    uint16_t address = 0;
+        result.cycles += uint32_t(-cycles);
+        result.instructions++;
 
-    if(mode == ACCUMULATOR)
-        operand = A;
-    else {
-        address = GetAddress(mode, cycles, memory, false);
-        operand = Read8Bits(cycles, memory, address);
+        if(unknownInstructionTrapped) {
+            unknownInstructionTrapped = false;
+            result.reason = STOP_REASON::UNKNOWN_INSTRUCTION;
+            break;
+        }
     }
 
-    if(operation == MATH_OPERATION::SHIFT_LEFT || operation == MATH_OPERATION::ROTATE_LEFT){
-        bool temp = (operand & NegativeBitFlag) > 0;
-        operand = operand << 1;
-
-        if(operation == MATH_OPERATION::ROTATE_LEFT)
-            operand += P.C;
-
-        P.C = temp;
-    } else if (operation == MATH_OPERATION::SHIFT_RIGHT || operation == MATH_OPERATION::ROTATE_RIGHT){
-        bool temp = (operand & CarryBitFlag) > 0;
-        operand = operand >> 1;
-
-        if(operation == MATH_OPERATION::ROTATE_RIGHT)
-            operand |= uint8_t(P.C) << 7;
-
-        P.C = temp;
-    } else
-        throw std::runtime_error("INVALID MATH OPERATION FOR THIS METHOD");
-
-    cycles--;
-    SetStatusNZ(operand);
-
-    if(mode == ABSOLUTE_X)
-        cycles--;
+    StoreLazyFlags();
 
-    if(mode == ACCUMULATOR)
-        A = operand;
-    else
-        Write8Bits(cycles, memory, address, operand);
+    if(limits.cycles != 0 && result.cycles > limits.cycles)
+        result.overshoot = uint32_t(result.cycles - limits.cycles);
+    return result;
 }
 
-MOS6502::instruction MOS6502::CPU::findInstructionInDataTable(MOS6502::INSTRUCTIONS opcode) {
-    int size = sizeof(MOS6502::InstructionsDataTable)/sizeof(MOS6502::instruction);
-    for(int i = 0; i < size; i++){
-        if(MOS6502::InstructionsDataTable[i].opcode == opcode)
-            return MOS6502::InstructionsDataTable[i];
+MOS6502::RunResult MOS6502::CPU::ExecuteInfinite(Bus& memory, const std::atomic<bool>& stop, ExecutionCounters* counters) {
+    if(memory.flat) {
+        FlatBus flatMemory(memory);
+        return ExecuteInfiniteOn(flatMemory, stop, counters);
     }
-    throw std::runtime_error("INVALID INSTRUCTION");
-}
-
-int32_t MOS6502::CPU::Execute(int32_t cycles, Bus& memory){
-    int32_t totalCycles = cycles;
-
-    while(cycles > 0){
-        uint8_t instruction = Fetch8Bits(cycles, memory);
-        if(instructionsLookupTable.find((INSTRUCTIONS)instruction) != instructionsLookupTable.end())
-            instructionsLookupTable[(INSTRUCTIONS)instruction](cycles, memory);
-        else {
-            printf("Unknown Instruction!");
-            return -1;
+    return ExecuteInfiniteOn(memory, stop, counters);
+}
+
+template<typename Memory>
+MOS6502::RunResult MOS6502::CPU::ExecuteInfiniteOn(Memory& memory, const std::atomic<bool>& stop, ExecutionCounters* counters) {
+    RunResult result{STOP_REASON::STOP_REQUESTED, 0, 0, 0};
+    LoadLazyFlags();
+    const auto& lookupTable = LookupTable<Memory>();
+
+    while(!stop.load(std::memory_order_relaxed)){
+        int32_t cycles = INFINITE_RUN_SLICE;
+        int32_t cyclesBefore = cycles;
+        uint64_t instructions = 0;
+        sliceCycles = cycles;
+
+        {
+            //interrupts are requested and entered the same way as in ExecuteOn
+            CycleCounterScope counterScope{*this, cycles};
+            while(true){
+                if(interruptPoll) [[unlikely]] {
+                    cycles += deferredCycles;
+                    deferredCycles = 0;
+                    EnterInterrupt(cycles, memory);
+                }
+
+                //handlers count their own cycles, no per-instruction lookup of the data table is needed
+                while(cycles > 0){
+                    cyclesBefore = cycles;
+                    uint8_t instruction = Fetch8Bits(cycles, memory);
+                    lookupTable[instruction](*this, cycles, memory);
+                    instructions++;
+                }
+
+                if(!interruptPoll || unknownInstructionTrapped)
+                    break;
+            }
+
+            //trap zeroes cycles, unknown instruction is counted without cycles like in Run
+            if(unknownInstructionTrapped)
+                cycles = cyclesBefore;
+            cycles += deferredCycles;
         }
-    }
-
-    return totalCycles - cycles;
-}
-
-void MOS6502::CPU::ExecuteInfinite(MOS6502::Bus &memory) {
 
-    int32_t cyclesLeft = 1;
-    uint8_t instruction = Fetch8Bits(cyclesLeft, memory);
+        result.cycles += uint32_t(sliceCycles - cycles);
+        result.instructions += instructions;
 
-    cyclesLeft = findInstructionInDataTable((MOS6502::INSTRUCTIONS)instruction).cycles;
-
-    while (cyclesLeft == 0) {
-        if(instructionsLookupTable.find((INSTRUCTIONS)instruction) != instructionsLookupTable.end())
-            instructionsLookupTable[(INSTRUCTIONS)instruction](cyclesLeft, memory);
+        if(counters != nullptr){
+            counters->cycles.store(result.cycles, std::memory_order_relaxed);
+            counters->instructions.store(result.instructions, std::memory_order_relaxed);
+        }
 
-        instruction = Fetch8Bits(cyclesLeft, memory);
-        cyclesLeft = findInstructionInDataTable((MOS6502::INSTRUCTIONS)instruction).cycles;
+        if(unknownInstructionTrapped){
+            unknownInstructionTrapped = false;
+            result.reason = STOP_REASON::UNKNOWN_INSTRUCTION;
+            break;
+        }
     }
-}
-
-
 
+    StoreLazyFlags();
+    return result;
+}
@@ -0,0 +1,56 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#include "6502_cpu_instructions.h"
+
+int32_t MOS6502::CPU::ExecuteThreaded(int32_t cycles, Bus& memory) {
+#if defined(__GNUC__) || defined(__clang__)
+    if(memory.flat) {
+        FlatBus flatMemory(memory);
+        return ExecuteThreadedOn(cycles, flatMemory);
+    }
+    return ExecuteThreadedOn(cycles, memory);
+#else
+    //labels-as-values are not available, fall back to portable engine
+    return Execute(cycles, memory);
+#endif
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+template<typename Memory>
+int32_t MOS6502::CPU::ExecuteThreadedOn(int32_t cycles, Memory& memory) {
+    int32_t totalCycles = cycles;
+    LoadLazyFlags();
+
+    //labels-as-values extension, every opcode gets its own label and its own indirect jump to the next one
+#define OPCODE_LABEL_ADDRESS(opcode) &&opcode_##opcode,
+    static void* const dispatchTable[256] = { FOR_EACH_OPCODE(OPCODE_LABEL_ADDRESS) };
+#undef OPCODE_LABEL_ADDRESS
+
+#define DISPATCH_NEXT() \
+    if(cycles <= 0) goto finished; \
+    goto *dispatchTable[Fetch8Bits(cycles, memory)];
+
+#define OPCODE_LABEL(opcode) \
+    opcode_##opcode: \
+    Instruction<opcode, Memory>(*this, cycles, memory); \
+    DISPATCH_NEXT()
+
+    DISPATCH_NEXT()
+    FOR_EACH_OPCODE(OPCODE_LABEL)
+
+#undef OPCODE_LABEL
+#undef DISPATCH_NEXT
+
+finished:
+    StoreLazyFlags();
+
+    if(unknownInstructionTrapped){
+        unknownInstructionTrapped = false;
+        return -1;
+    }
+
+    return totalCycles - cycles;
+}
+#endif
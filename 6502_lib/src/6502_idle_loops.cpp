@@ -0,0 +1,170 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_cpu_instructions.h"
+
+#include <array>
+#include <initializer_list>
+
+namespace {
+    /*what an instruction inside an idle loop may do*/
+    enum class IDLE_KIND : uint8_t {
+        //writes memory, uses the stack, jumps away or reads an address depending on registers
+        NONE,
+        //changes only registers and flags
+        REGISTERS,
+        //reads a fixed zero page or absolute address
+        READ,
+        BRANCH,
+        JUMP
+    };
+
+    constexpr bool IsOneOf(const char* name, std::initializer_list<const char*> names) {
+        for(const char* other : names)
+            if(MOS6502::IsSameMnemonic(name, other))
+                return true;
+        return false;
+    }
+
+    constexpr IDLE_KIND Classify(const MOS6502::instruction& ins) {
+        using namespace MOS6502;
+        if(ins.addressingMode == RELATIVE)
+            return IDLE_KIND::BRANCH;
+        if(IsSameMnemonic(ins.name, "JMP"))
+            return ins.addressingMode == ABSOLUTE ? IDLE_KIND::JUMP : IDLE_KIND::NONE;
+
+        //CLI and SEI are left out, they change which interrupts can end the loop
+        if(IsOneOf(ins.name, {"TAX", "TXA", "TAY", "TYA", "TSX", "TXS", "INX", "INY", "DEX", "DEY",
+                              "CLC", "SEC", "CLD", "SED", "CLV", "NOP"}))
+            return IDLE_KIND::REGISTERS;
+        if(IsOneOf(ins.name, {"ASL", "LSR", "ROL", "ROR"}))
+            return ins.addressingMode == ACCUMULATOR ? IDLE_KIND::REGISTERS : IDLE_KIND::NONE;
+
+        if(!IsOneOf(ins.name, {"LDA", "LDX", "LDY", "AND", "ORA", "EOR", "BIT", "ADC", "SBC", "CMP", "CPX", "CPY"}))
+            return IDLE_KIND::NONE;
+        switch(ins.addressingMode) {
+            case IMMEDIATE: return IDLE_KIND::REGISTERS;
+            case ZERO_PAGE: case ABSOLUTE: return IDLE_KIND::READ;
+            default: return IDLE_KIND::NONE;
+        }
+    }
+
+    struct IdleOpcode {
+        IDLE_KIND kind = IDLE_KIND::NONE;
+        uint8_t bytes = 1;
+    };
+
+    constexpr std::array<IdleOpcode, 256> fillIdleOpcodeTable() {
+        std::array<IdleOpcode, 256> table{};
+        for(const MOS6502::instruction& ins : MOS6502::InstructionsDataTable)
+            table[ins.opcode] = {Classify(ins), ins.bytes};
+        return table;
+    }
+
+    //indexed by opcode
+    constexpr std::array<IdleOpcode, 256> idleOpcodeTable = fillIdleOpcodeTable();
+
+    /*code of a loop is read without touching devices, false when the byte is not in host memory*/
+    bool PeekCode(const MOS6502::FlatBus& memory, uint16_t address, uint8_t& value) {
+        value = memory.RAM[address];
+        return true;
+    }
+
+    bool PeekCode(const MOS6502::Bus& memory, uint16_t address, uint8_t& value) {
+        if(!memory.IsHostMemory(address))
+            return false;
+        value = memory[address];
+        return true;
+    }
+
+    bool ReadIsStable(const MOS6502::FlatBus&, uint16_t) {
+        return true;
+    }
+
+    bool ReadIsStable(const MOS6502::Bus& memory, uint16_t address) {
+        if(memory.IsHostMemory(address))
+            return true;
+        //unmapped pages read as 0
+        const MOS6502::Device* device = memory.pages[address >> 8].device;
+        return device == nullptr || device->ReadIsStable(address);
+    }
+}
+
+template<typename Memory>
+bool MOS6502::CPU::IsIdleLoop(const Memory& memory, uint16_t start, uint16_t branch) {
+    uint32_t address = start;
+    while(address <= branch) {
+        uint8_t code[3]{};
+        if(!PeekCode(memory, uint16_t(address), code[0]))
+            return false;
+        const IdleOpcode& opcode = idleOpcodeTable[code[0]];
+        for(uint8_t i = 1; i < opcode.bytes; i++)
+            if(!PeekCode(memory, uint16_t(address + i), code[i]))
+                return false;
+
+        //the loop is closed by the instruction which called IdleBranch
+        if(address == branch)
+            return opcode.kind == IDLE_KIND::BRANCH || opcode.kind == IDLE_KIND::JUMP;
+
+        switch(opcode.kind) {
+            case IDLE_KIND::REGISTERS:
+                break;
+            case IDLE_KIND::READ: {
+                uint16_t operand = opcode.bytes == 3 ? uint16_t(code[1] | (code[2] << 8)) : code[1];
+                if(!ReadIsStable(memory, operand))
+                    return false;
+                break;
+            }
+            case IDLE_KIND::BRANCH: {
+                //only forward inside the loop, so it is left through its closing branch alone
+                uint32_t target = address + 2 + int8_t(code[1]);
+                if(target <= address || target > branch)
+                    return false;
+                break;
+            }
+            default:
+                return false;
+        }
+        address += opcode.bytes;
+    }
+    //decoding stepped over the closing branch
+    return false;
+}
+
+template<typename Memory>
+void MOS6502::CPU::IdleBranch(int32_t& cycles, const Memory& memory, uint16_t branch) {
+    uint64_t registers = A | (X << 8) | (Y << 16) | (uint64_t(S) << 24) |
+                         (uint64_t(flagResult) << 32) | (uint64_t(flagCarry) << 48) | (uint64_t(flagOverflow) << 56);
+    if(branch != idleBranch) {
+        idleBranch = branch;
+        idleRejected = false;
+        idleRegisters = registers;
+        idleStatus = P.PS;
+        idleCycles = cycles;
+        return;
+    }
+    if(idleRejected)
+        return;
+
+    int32_t period = idleCycles - cycles;
+    bool repeated = registers == idleRegisters && P.PS == idleStatus;
+    idleRegisters = registers;
+    idleStatus = P.PS;
+    idleCycles = cycles;
+    if(!repeated || period <= 0 || cycles <= period)
+        return;
+
+    if(!IsIdleLoop(memory, PC, branch)) {
+        idleRejected = true;
+        return;
+    }
+
+    //every further iteration is the same, whole ones are charged at once,
+    //at least one cycle is left so the last instructions run and the call ends where it would without skipping
+    cycles -= (cycles - 1) / period * period;
+    idleCycles = cycles;
+}
+
+template void MOS6502::CPU::IdleBranch<MOS6502::Bus>(int32_t&, const Bus&, uint16_t);
+template void MOS6502::CPU::IdleBranch<MOS6502::FlatBus>(int32_t&, const FlatBus&, uint16_t);
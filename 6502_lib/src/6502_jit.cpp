@@ -0,0 +1,962 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#include "6502_jit.h"
+#include "6502_cpu_instructions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define MOS6502_JIT_ENABLED 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define MOS6502_JIT_ENABLED 0
+#endif
+
+namespace {
+    //size of executable memory, whole cache is flushed when it gets full
+    constexpr size_t CODE_CACHE_SIZE = 4 * 1024 * 1024;
+
+#if MOS6502_JIT_ENABLED
+    /*changes protection of every host page touching size bytes at start*/
+    bool Protect(uint8_t* start, size_t size, int protection) {
+        uintptr_t pageSize = uintptr_t(sysconf(_SC_PAGESIZE));
+        uintptr_t first = reinterpret_cast<uintptr_t>(start) & ~(pageSize - 1);
+        uintptr_t end = (reinterpret_cast<uintptr_t>(start) + size + pageSize - 1) & ~(pageSize - 1);
+        return mprotect(reinterpret_cast<void*>(first), end - first, protection) == 0;
+    }
+#endif
+    //maximum number of 6502 instructions translated into one block
+    constexpr int MAX_BLOCK_INSTRUCTIONS = 64;
+
+    enum HostRegister : uint8_t {
+        RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+        R8, R9, R10, R11
+    };
+
+    //6502 state is kept in caller-saved registers (and rbx, rbp saved by the block) while translated code runs
+    constexpr HostRegister REG_A = R8;
+    constexpr HostRegister REG_X = R9;
+    constexpr HostRegister REG_Y = R10;
+    constexpr HostRegister REG_S = R11;
+    constexpr HostRegister REG_P = RDX;
+    constexpr HostRegister REG_CYCLES = RCX;
+    constexpr HostRegister REG_RAM = RSI;
+    constexpr HostRegister REG_STATE = RDI;
+
+    //scratch registers, effective address, operand and temporary value
+    constexpr HostRegister REG_ADDRESS = RAX;
+    constexpr HostRegister REG_VALUE = RBX;
+    constexpr HostRegister REG_TEMP = RBP;
+
+    //x86 condition codes
+    enum Condition : uint8_t {
+        COND_B = 0x2,
+        COND_E = 0x4,
+        COND_NE = 0x5,
+        COND_BE = 0x6,
+        COND_LE = 0xE
+    };
+
+    //x86 arithmetic operations, same encoding as /digit of 0x80, 0x81 and 0x83 opcodes
+    enum AluOperation : uint8_t {
+        ALU_ADD = 0,
+        ALU_OR = 1,
+        ALU_ADC = 2,
+        ALU_AND = 4,
+        ALU_SUB = 5,
+        ALU_XOR = 6,
+        ALU_CMP = 7
+    };
+
+    //x86 shift operations, /digit of 0xC1 and 0xD0 opcodes
+    enum ShiftOperation : uint8_t {
+        SHIFT_LEFT = 4,
+        SHIFT_RIGHT = 5
+    };
+
+    /*Encodes the small subset of x86-64 used by translated blocks, all operations are 32-bit unless stated otherwise*/
+    class Emitter {
+    public:
+        std::vector<uint8_t> code;
+
+        size_t Position() const { return code.size(); }
+
+        void Byte(uint8_t value) { code.push_back(value); }
+        void Dword(uint32_t value) {
+            for(int i = 0; i < 4; i++)
+                Byte(value >> (8 * i));
+        }
+
+        /*op dst, src*/
+        void Alu(AluOperation operation, HostRegister dst, HostRegister src) {
+            Rex(src, 0, dst, false);
+            Byte((operation << 3) | 0x01);
+            ModRM(src, dst);
+        }
+        /*op dst8, src8*/
+        void Alu8(AluOperation operation, HostRegister dst, HostRegister src) {
+            Rex(src, 0, dst, true);
+            Byte(operation << 3);
+            ModRM(src, dst);
+        }
+        /*op dst, immediate*/
+        void AluImmediate(AluOperation operation, HostRegister dst, int32_t immediate) {
+            Rex(0, 0, dst, false);
+            if(immediate >= -128 && immediate <= 127) {
+                Byte(0x83);
+                ModRM(operation, dst);
+                Byte(immediate);
+            } else {
+                Byte(0x81);
+                ModRM(operation, dst);
+                Dword(immediate);
+            }
+        }
+        /*op dst, immediate - always 32-bit immediate, returns its position so it can be patched*/
+        size_t AluImmediate32(AluOperation operation, HostRegister dst, int32_t immediate) {
+            Rex(0, 0, dst, false);
+            Byte(0x81);
+            ModRM(operation, dst);
+            Dword(immediate);
+            return Position() - 4;
+        }
+        /*op dst8, immediate8*/
+        void Alu8Immediate(AluOperation operation, HostRegister dst, uint8_t immediate) {
+            Rex(0, 0, dst, true);
+            Byte(0x80);
+            ModRM(operation, dst);
+            Byte(immediate);
+        }
+        /*mov dst, src*/
+        void Move(HostRegister dst, HostRegister src) {
+            Rex(src, 0, dst, false);
+            Byte(0x89);
+            ModRM(src, dst);
+        }
+        /*mov dst, immediate*/
+        void MoveImmediate(HostRegister dst, uint32_t immediate) {
+            Rex(0, 0, dst, false);
+            Byte(0xB8 + (dst & 7));
+            Dword(immediate);
+        }
+        /*test first, second*/
+        void Test(HostRegister first, HostRegister second) {
+            Rex(second, 0, first, false);
+            Byte(0x85);
+            ModRM(second, first);
+        }
+        /*test dst, immediate*/
+        void TestImmediate(HostRegister dst, uint32_t immediate) {
+            Rex(0, 0, dst, false);
+            Byte(0xF7);
+            ModRM(0, dst);
+            Dword(immediate);
+        }
+        /*not dst*/
+        void Not(HostRegister dst) {
+            Rex(0, 0, dst, false);
+            Byte(0xF7);
+            ModRM(2, dst);
+        }
+        /*shl/shr dst, count*/
+        void Shift(ShiftOperation operation, HostRegister dst, uint8_t count) {
+            Rex(0, 0, dst, false);
+            Byte(0xC1);
+            ModRM(operation, dst);
+            Byte(count);
+        }
+        /*shl/shr dst8, 1*/
+        void Shift8(ShiftOperation operation, HostRegister dst) {
+            Rex(0, 0, dst, true);
+            Byte(0xD0);
+            ModRM(operation, dst);
+        }
+        /*movzx dst, byte [REG_RAM + index + displacement]*/
+        void LoadByte(HostRegister dst, HostRegister index, int8_t displacement = 0) {
+            Rex(dst, index, REG_RAM, false);
+            Byte(0x0F);
+            Byte(0xB6);
+            MemoryOperand(dst, index, displacement);
+        }
+        /*mov byte [REG_RAM + index + displacement], src8*/
+        void StoreByte(HostRegister src, HostRegister index, int8_t displacement = 0) {
+            Rex(src, index, REG_RAM, true);
+            Byte(0x88);
+            MemoryOperand(src, index, displacement);
+        }
+        /*mov dst, [REG_STATE + offset]*/
+        void LoadState(HostRegister dst, uint8_t offset) {
+            Rex(dst, 0, REG_STATE, false);
+            Byte(0x8B);
+            StateOperand(dst, offset);
+        }
+        /*mov dst64, [REG_STATE + offset]*/
+        void LoadStatePointer(HostRegister dst, uint8_t offset) {
+            Byte(0x48 | ((dst >> 3) << 2));
+            Byte(0x8B);
+            StateOperand(dst, offset);
+        }
+        /*mov [REG_STATE + offset], src*/
+        void StoreState(HostRegister src, uint8_t offset) {
+            Rex(src, 0, REG_STATE, false);
+            Byte(0x89);
+            StateOperand(src, offset);
+        }
+        /*mov dword [REG_STATE + offset], immediate*/
+        void StoreStateImmediate(uint8_t offset, uint32_t immediate) {
+            Byte(0xC7);
+            StateOperand(0, offset);
+            Dword(immediate);
+        }
+        /*inc dword [base + index * 4]*/
+        void IncrementDword(HostRegister base, HostRegister index) {
+            Rex(0, index, base, false);
+            Byte(0xFF);
+            Byte(0x04);
+            Byte(0x80 | ((index & 7) << 3) | (base & 7));
+        }
+        void Push(HostRegister reg) { Byte(0x50 + reg); }
+        void Pop(HostRegister reg) { Byte(0x58 + reg); }
+        void Return() { Byte(0xC3); }
+
+        /*jmp rel32, returns position of the displacement for Patch*/
+        size_t Jump() {
+            Byte(0xE9);
+            Dword(0);
+            return Position() - 4;
+        }
+        /*jcc rel32, returns position of the displacement for Patch*/
+        size_t JumpIf(Condition condition) {
+            Byte(0x0F);
+            Byte(0x80 | condition);
+            Dword(0);
+            return Position() - 4;
+        }
+        /*points 32-bit displacement at target*/
+        void Patch(size_t displacement, size_t target) {
+            int32_t relative = int32_t(target) - int32_t(displacement + 4);
+            std::memcpy(&code[displacement], &relative, sizeof(relative));
+        }
+        /*short forward jcc, returns position of the displacement for PatchSkip*/
+        size_t SkipIf(Condition condition) {
+            Byte(0x70 | condition);
+            Byte(0);
+            return Position() - 1;
+        }
+        /*points short jump at current position*/
+        void PatchSkip(size_t displacement) {
+            code[displacement] = uint8_t(Position() - (displacement + 1));
+        }
+
+    private:
+        void Rex(uint8_t reg, uint8_t index, uint8_t base, bool byteRegisters) {
+            //rex prefix is always emitted for byte operations, so 4-7 encode spl-dil instead of ah-bh
+            uint8_t rex = 0x40 | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3);
+            if(rex != 0x40 || byteRegisters)
+                Byte(rex);
+        }
+        void ModRM(uint8_t reg, uint8_t rm) {
+            Byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+        }
+        void MemoryOperand(uint8_t reg, uint8_t index, int8_t displacement) {
+            Byte((displacement ? 0x44 : 0x04) | ((reg & 7) << 3));
+            Byte(((index & 7) << 3) | (REG_RAM & 7));
+            if(displacement)
+                Byte(displacement);
+        }
+        void StateOperand(uint8_t reg, uint8_t offset) {
+            Byte(0x40 | ((reg & 7) << 3) | (REG_STATE & 7));
+            Byte(offset);
+        }
+    };
+
+    /*Translates one block of 6502 code, stops at first instruction it can not translate or after a jump*/
+    class BlockCompiler {
+    public:
+        BlockCompiler(const MOS6502::Bus& memory, uint16_t start) : RAM(memory.RAM), start(start), end(start) {}
+
+        /*returns false if first instruction of the block can not be translated*/
+        bool Compile();
+
+        std::vector<uint8_t>& Code() { return e.code; }
+        uint16_t SourceLength() const { return end - start; }
+
+    private:
+        using State = MOS6502::JIT::State;
+
+        struct Exit {
+            size_t displacement;
+            uint16_t PC;
+            //instruction at PC has to be executed by the interpreter
+            bool bail;
+        };
+
+        static bool IsSupported(const MOS6502::instruction& ins);
+
+        /*returns true if instruction ends the block*/
+        bool EmitInstruction(uint16_t PC, const MOS6502::instruction& ins);
+
+        void EmitPrologue();
+        void EmitEpilogue();
+
+        /*REG_ADDRESS = effective address, takes page crossing cycle like the interpreter*/
+        void EmitAddress(MOS6502::ADDRESSING_MODE mode, uint16_t operand, bool checkPageCrossing);
+        /*REG_VALUE = operand value*/
+        void EmitOperand(MOS6502::ADDRESSING_MODE mode, uint16_t operand, bool checkPageCrossing);
+        void EmitSetNZ(HostRegister reg);
+
+        /*leaves the block if cycles ran out*/
+        void EmitCheckCycles(uint16_t nextPC);
+        /*bumps generation of the page REG_ADDRESS points to, like Bus::Write does*/
+        void EmitMarkPageWritten();
+        /*leaves the block if REG_ADDRESS points into source of the block*/
+        void EmitCheckSelfModification(uint16_t nextPC);
+        /*leaves the block, continues at PC*/
+        void EmitExit(uint16_t PC);
+        /*jumps to translated instruction at PC if block has it, leaves the block otherwise*/
+        void EmitJumpTo(uint16_t PC);
+
+        static HostRegister RegisterOf(const char* name);
+
+        Emitter e;
+        const uint8_t* RAM;
+        uint16_t start;
+        uint32_t end;
+
+        //code position of every translated instruction
+        std::vector<std::pair<uint16_t, size_t>> labels;
+        std::vector<Exit> exits;
+        //jumps to translated instructions, resolved when whole block is known
+        std::vector<std::pair<size_t, uint16_t>> jumps;
+        //32-bit immediates holding length of the block source
+        std::vector<size_t> sourceLengthImmediates;
+        //jumps to the epilogue
+        std::vector<size_t> epilogueJumps;
+    };
+
+    bool BlockCompiler::IsSupported(const MOS6502::instruction& ins) {
+        using MOS6502::IsSameMnemonic;
+        if(IsSameMnemonic(ins.name, "BRK") || IsSameMnemonic(ins.name, "RTI"))
+            return false;
+        if(IsSameMnemonic(ins.name, "JMP") && ins.addressingMode == MOS6502::INDIRECT)
+            return false;
+        return true;
+    }
+
+    HostRegister BlockCompiler::RegisterOf(const char* name) {
+        //last letter of LDA, STX, CPY, INX... names the register
+        switch(name[2]) {
+            case 'X': return REG_X;
+            case 'Y': return REG_Y;
+            default: return REG_A;
+        }
+    }
+
+    bool BlockCompiler::Compile() {
+        EmitPrologue();
+
+        uint16_t PC = start;
+        for(int count = 0; ; count++) {
+            const MOS6502::instruction* ins = MOS6502::FindInstruction(RAM[PC]);
+            bool supported = count < MAX_BLOCK_INSTRUCTIONS && ins != nullptr &&
+                             IsSupported(*ins) && PC + ins->bytes <= MOS6502::Bus::MAX_MEM;
+
+            if(!supported) {
+                if(count == 0)
+                    return false;
+                EmitExit(PC);
+                break;
+            }
+
+            labels.emplace_back(PC, e.Position());
+            bool endsBlock = EmitInstruction(PC, *ins);
+            PC += ins->bytes;
+            end = PC;
+
+            if(endsBlock)
+                break;
+        }
+
+        //exits taken in the middle of the block
+        for(const Exit& exit : exits) {
+            e.Patch(exit.displacement, e.Position());
+            if(exit.bail)
+                e.StoreStateImmediate(offsetof(State, bail), 1);
+            EmitExit(exit.PC);
+        }
+
+        for(const auto& [displacement, PC] : jumps) {
+            auto label = std::find_if(labels.begin(), labels.end(), [PC](const auto& l) { return l.first == PC; });
+            if(label != labels.end()) {
+                e.Patch(displacement, label->second);
+            } else {
+                e.Patch(displacement, e.Position());
+                EmitExit(PC);
+            }
+        }
+
+        size_t epilogue = e.Position();
+        EmitEpilogue();
+        for(size_t displacement : epilogueJumps)
+            e.Patch(displacement, epilogue);
+
+        uint32_t sourceLength = SourceLength();
+        for(size_t immediate : sourceLengthImmediates)
+            std::memcpy(&e.code[immediate], &sourceLength, sizeof(sourceLength));
+
+        return true;
+    }
+
+    void BlockCompiler::EmitPrologue() {
+        e.Push(RBX);
+        e.Push(RBP);
+        e.LoadStatePointer(REG_RAM, offsetof(State, RAM));
+        e.LoadState(REG_CYCLES, offsetof(State, cycles));
+        e.LoadState(REG_A, offsetof(State, A));
+        e.LoadState(REG_X, offsetof(State, X));
+        e.LoadState(REG_Y, offsetof(State, Y));
+        e.LoadState(REG_S, offsetof(State, S));
+        e.LoadState(REG_P, offsetof(State, P));
+    }
+
+    void BlockCompiler::EmitEpilogue() {
+        //REG_ADDRESS holds PC of next instruction
+        e.StoreState(REG_ADDRESS, offsetof(State, PC));
+        e.StoreState(REG_CYCLES, offsetof(State, cycles));
+        e.StoreState(REG_A, offsetof(State, A));
+        e.StoreState(REG_X, offsetof(State, X));
+        e.StoreState(REG_Y, offsetof(State, Y));
+        e.StoreState(REG_S, offsetof(State, S));
+        e.StoreState(REG_P, offsetof(State, P));
+        e.Pop(RBP);
+        e.Pop(RBX);
+        e.Return();
+    }
+
+    void BlockCompiler::EmitExit(uint16_t PC) {
+        e.MoveImmediate(REG_ADDRESS, PC);
+        epilogueJumps.push_back(e.Jump());
+    }
+
+    void BlockCompiler::EmitJumpTo(uint16_t PC) {
+        jumps.emplace_back(e.Jump(), PC);
+    }
+
+    void BlockCompiler::EmitCheckCycles(uint16_t nextPC) {
+        e.Test(REG_CYCLES, REG_CYCLES);
+        exits.push_back({e.JumpIf(COND_LE), nextPC, false});
+    }
+
+    void BlockCompiler::EmitMarkPageWritten() {
+        e.LoadStatePointer(REG_VALUE, offsetof(State, pageGeneration));
+        e.Move(REG_TEMP, REG_ADDRESS);
+        e.Shift(SHIFT_RIGHT, REG_TEMP, 8);
+        e.IncrementDword(REG_VALUE, REG_TEMP);
+    }
+
+    void BlockCompiler::EmitCheckSelfModification(uint16_t nextPC) {
+        e.Move(REG_TEMP, REG_ADDRESS);
+        e.AluImmediate32(ALU_SUB, REG_TEMP, start);
+        sourceLengthImmediates.push_back(e.AluImmediate32(ALU_CMP, REG_TEMP, 0));
+        exits.push_back({e.JumpIf(COND_B), nextPC, false});
+    }
+
+    void BlockCompiler::EmitSetNZ(HostRegister reg) {
+        e.AluImmediate(ALU_AND, REG_P, 0x7D);
+        e.Test(reg, reg);
+        size_t notZero = e.SkipIf(COND_NE);
+        e.AluImmediate(ALU_OR, REG_P, 0x02);
+        e.PatchSkip(notZero);
+        e.Move(REG_TEMP, reg);
+        e.AluImmediate(ALU_AND, REG_TEMP, 0x80);
+        e.Alu(ALU_OR, REG_P, REG_TEMP);
+    }
+
+    void BlockCompiler::EmitAddress(MOS6502::ADDRESSING_MODE mode, uint16_t operand, bool checkPageCrossing) {
+        using namespace MOS6502;
+        switch(mode) {
+            case ZERO_PAGE:
+            case ABSOLUTE:
+                e.MoveImmediate(REG_ADDRESS, operand);
+                break;
+            case ZERO_PAGE_X:
+            case ZERO_PAGE_Y:
+                e.Move(REG_ADDRESS, mode == ZERO_PAGE_X ? REG_X : REG_Y);
+                e.AluImmediate(ALU_ADD, REG_ADDRESS, operand);
+                e.AluImmediate(ALU_AND, REG_ADDRESS, 0xFF);
+                break;
+            case ABSOLUTE_X:
+            case ABSOLUTE_Y: {
+                HostRegister index = mode == ABSOLUTE_X ? REG_X : REG_Y;
+                if(checkPageCrossing) {
+                    e.AluImmediate(ALU_CMP, index, 0xFF - (operand & 0xFF));
+                    size_t samePage = e.SkipIf(COND_BE);
+                    e.AluImmediate(ALU_SUB, REG_CYCLES, 1);
+                    e.PatchSkip(samePage);
+                }
+                e.Move(REG_ADDRESS, index);
+                e.AluImmediate(ALU_ADD, REG_ADDRESS, operand);
+                e.AluImmediate(ALU_AND, REG_ADDRESS, 0xFFFF);
+                break;
+            }
+            case INDIRECT_X:
+                e.Move(REG_VALUE, REG_X);
+                e.AluImmediate(ALU_ADD, REG_VALUE, operand);
+                e.AluImmediate(ALU_AND, REG_VALUE, 0xFF);
+                e.LoadByte(REG_ADDRESS, REG_VALUE);
+                e.LoadByte(REG_VALUE, REG_VALUE, 1);
+                e.Shift(SHIFT_LEFT, REG_VALUE, 8);
+                e.Alu(ALU_OR, REG_ADDRESS, REG_VALUE);
+                break;
+            case INDIRECT_Y:
+                e.MoveImmediate(REG_VALUE, operand);
+                e.LoadByte(REG_ADDRESS, REG_VALUE);
+                e.LoadByte(REG_VALUE, REG_VALUE, 1);
+                e.Shift(SHIFT_LEFT, REG_VALUE, 8);
+                e.Alu(ALU_OR, REG_ADDRESS, REG_VALUE);
+                if(checkPageCrossing) {
+                    //same condition as the interpreter uses
+                    e.Move(REG_VALUE, REG_ADDRESS);
+                    e.AluImmediate(ALU_AND, REG_VALUE, 0xFF);
+                    e.Alu(ALU_ADD, REG_VALUE, REG_Y);
+                    e.AluImmediate(ALU_CMP, REG_VALUE, 0xFF);
+                    size_t samePage = e.SkipIf(COND_B);
+                    e.AluImmediate(ALU_SUB, REG_CYCLES, 1);
+                    e.PatchSkip(samePage);
+                }
+                e.Alu(ALU_ADD, REG_ADDRESS, REG_Y);
+                e.AluImmediate(ALU_AND, REG_ADDRESS, 0xFFFF);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void BlockCompiler::EmitOperand(MOS6502::ADDRESSING_MODE mode, uint16_t operand, bool checkPageCrossing) {
+        if(mode == MOS6502::IMMEDIATE) {
+            e.MoveImmediate(REG_VALUE, operand);
+        } else {
+            EmitAddress(mode, operand, checkPageCrossing);
+            e.LoadByte(REG_VALUE, REG_ADDRESS);
+        }
+    }
+
+    bool BlockCompiler::EmitInstruction(uint16_t PC, const MOS6502::instruction& ins) {
+        using namespace MOS6502;
+
+        const char* name = ins.name;
+        const ADDRESSING_MODE mode = ins.addressingMode;
+        const uint16_t nextPC = PC + ins.bytes;
+        const uint16_t operand = ins.bytes == 3 ? RAM[PC + 1] | (RAM[PC + 2] << 8) : RAM[PC + 1];
+        //REG_ADDRESS holds written address, checked once cycles of the instruction are taken
+        bool writesMemory = false;
+
+        /////////////////////////////////// LOAD/STORE REGISTERS ///////////////////////////////////////
+        if(IsSameMnemonic(name, "LDA") || IsSameMnemonic(name, "LDX") || IsSameMnemonic(name, "LDY")) {
+            HostRegister reg = RegisterOf(name);
+            if(mode == IMMEDIATE) {
+                e.MoveImmediate(reg, operand);
+            } else {
+                EmitAddress(mode, operand, true);
+                e.LoadByte(reg, REG_ADDRESS);
+            }
+            EmitSetNZ(reg);
+        }
+        else if(IsSameMnemonic(name, "STA") || IsSameMnemonic(name, "STX") || IsSameMnemonic(name, "STY")) {
+            EmitAddress(mode, operand, false);
+            e.StoreByte(RegisterOf(name), REG_ADDRESS);
+            writesMemory = true;
+        }
+
+        /////////////////////////////////// TRANSFER REGISTERS ///////////////////////////////////////
+        else if(IsSameMnemonic(name, "TAX")) { e.Move(REG_X, REG_A); EmitSetNZ(REG_X); }
+        else if(IsSameMnemonic(name, "TXA")) { e.Move(REG_A, REG_X); EmitSetNZ(REG_A); }
+        else if(IsSameMnemonic(name, "TAY")) { e.Move(REG_Y, REG_A); EmitSetNZ(REG_Y); }
+        else if(IsSameMnemonic(name, "TYA")) { e.Move(REG_A, REG_Y); EmitSetNZ(REG_A); }
+        else if(IsSameMnemonic(name, "TSX")) { e.Move(REG_X, REG_S); EmitSetNZ(REG_X); }
+        else if(IsSameMnemonic(name, "TXS")) { e.Move(REG_S, REG_X); }
+
+        /////////////////////////////////// STACK OPERATIONS ///////////////////////////////////////
+        else if(IsSameMnemonic(name, "PHA") || IsSameMnemonic(name, "PHP")) {
+            HostRegister value = REG_A;
+            if(IsSameMnemonic(name, "PHP")) {
+                value = REG_VALUE;
+                e.Move(REG_VALUE, REG_P);
+                e.AluImmediate(ALU_OR, REG_VALUE, 0x30);
+            }
+            e.Move(REG_ADDRESS, REG_S);
+            e.AluImmediate32(ALU_ADD, REG_ADDRESS, 0x0100);
+            e.StoreByte(value, REG_ADDRESS);
+            e.Alu8Immediate(ALU_SUB, REG_S, 1);
+            writesMemory = true;
+        }
+        else if(IsSameMnemonic(name, "PLA") || IsSameMnemonic(name, "PLP")) {
+            e.Alu8Immediate(ALU_ADD, REG_S, 1);
+            e.Move(REG_ADDRESS, REG_S);
+            e.AluImmediate32(ALU_ADD, REG_ADDRESS, 0x0100);
+            if(IsSameMnemonic(name, "PLA")) {
+                e.LoadByte(REG_A, REG_ADDRESS);
+                EmitSetNZ(REG_A);
+            } else {
+                //break and unused flags are not changed by PLP
+                e.LoadByte(REG_VALUE, REG_ADDRESS);
+                e.AluImmediate(ALU_AND, REG_VALUE, 0xCF);
+                e.AluImmediate(ALU_AND, REG_P, 0x30);
+                e.Alu(ALU_OR, REG_P, REG_VALUE);
+            }
+        }
+
+        /////////////////////////////////// LOGICAL OPERATIONS ///////////////////////////////////////
+        else if(IsSameMnemonic(name, "AND") || IsSameMnemonic(name, "ORA") || IsSameMnemonic(name, "EOR")) {
+            EmitOperand(mode, operand, true);
+            AluOperation operation = IsSameMnemonic(name, "AND") ? ALU_AND : IsSameMnemonic(name, "ORA") ? ALU_OR : ALU_XOR;
+            e.Alu(operation, REG_A, REG_VALUE);
+            EmitSetNZ(REG_A);
+        }
+        else if(IsSameMnemonic(name, "BIT")) {
+            EmitOperand(mode, operand, true);
+            e.AluImmediate(ALU_AND, REG_P, 0x3D);
+            e.Move(REG_TEMP, REG_VALUE);
+            e.AluImmediate(ALU_AND, REG_TEMP, 0xC0);
+            e.Alu(ALU_OR, REG_P, REG_TEMP);
+            e.Test(REG_A, REG_VALUE);
+            size_t notZero = e.SkipIf(COND_NE);
+            e.AluImmediate(ALU_OR, REG_P, 0x02);
+            e.PatchSkip(notZero);
+        }
+
+        ////////////////////////////////// JUMPS //////////////////////////////////
+        else if(IsSameMnemonic(name, "JSR")) {
+            uint16_t returnAddress = nextPC - 1;
+            e.Move(REG_ADDRESS, REG_S);
+            e.AluImmediate32(ALU_ADD, REG_ADDRESS, 0x00FF);
+            e.MoveImmediate(REG_VALUE, returnAddress & 0xFF);
+            e.StoreByte(REG_VALUE, REG_ADDRESS);
+            e.MoveImmediate(REG_VALUE, returnAddress >> 8);
+            e.StoreByte(REG_VALUE, REG_ADDRESS, 1);
+            e.Alu8Immediate(ALU_SUB, REG_S, 2);
+            e.AluImmediate(ALU_SUB, REG_CYCLES, ins.cycles);
+            EmitMarkPageWritten();
+            e.AluImmediate(ALU_ADD, REG_ADDRESS, 1);
+            EmitMarkPageWritten();
+            EmitExit(operand);
+            return true;
+        }
+        else if(IsSameMnemonic(name, "RTS")) {
+            e.Alu8Immediate(ALU_ADD, REG_S, 2);
+            e.Move(REG_ADDRESS, REG_S);
+            e.AluImmediate32(ALU_ADD, REG_ADDRESS, 0x00FF);
+            e.LoadByte(REG_VALUE, REG_ADDRESS, 1);
+            e.Shift(SHIFT_LEFT, REG_VALUE, 8);
+            e.LoadByte(REG_ADDRESS, REG_ADDRESS);
+            e.Alu(ALU_OR, REG_ADDRESS, REG_VALUE);
+            e.AluImmediate(ALU_ADD, REG_ADDRESS, 1);
+            e.AluImmediate(ALU_AND, REG_ADDRESS, 0xFFFF);
+            e.AluImmediate(ALU_SUB, REG_CYCLES, ins.cycles);
+            epilogueJumps.push_back(e.Jump());
+            return true;
+        }
+        else if(IsSameMnemonic(name, "JMP")) {
+            e.AluImmediate(ALU_SUB, REG_CYCLES, ins.cycles);
+            EmitCheckCycles(operand);
+            EmitJumpTo(operand);
+            return true;
+        }
+
+        ////////////////////////////////// INCREMENT/DECREMENT //////////////////////////////////
+        else if(IsSameMnemonic(name, "INX") || IsSameMnemonic(name, "INY") ||
+                IsSameMnemonic(name, "DEX") || IsSameMnemonic(name, "DEY")) {
+            HostRegister reg = RegisterOf(name);
+            e.Alu8Immediate(name[0] == 'I' ? ALU_ADD : ALU_SUB, reg, 1);
+            EmitSetNZ(reg);
+        }
+        else if(IsSameMnemonic(name, "INC") || IsSameMnemonic(name, "DEC")) {
+            EmitAddress(mode, operand, false);
+            e.LoadByte(REG_VALUE, REG_ADDRESS);
+            e.Alu8Immediate(name[0] == 'I' ? ALU_ADD : ALU_SUB, REG_VALUE, 1);
+            e.StoreByte(REG_VALUE, REG_ADDRESS);
+            EmitSetNZ(REG_VALUE);
+            writesMemory = true;
+        }
+
+        ////////////////////////////////// BRANCHES //////////////////////////////////
+        else if(mode == RELATIVE) {
+            uint8_t flag;
+            switch(name[1]) {
+                case 'E': case 'N': flag = 0x02; break; //BEQ, BNE
+                case 'M': case 'P': flag = 0x80; break; //BMI, BPL
+                case 'C': flag = 0x01; break;           //BCS, BCC
+                default: flag = 0x40; break;            //BVS, BVC
+            }
+            bool expectedState = IsSameMnemonic(name, "BEQ") || IsSameMnemonic(name, "BMI") ||
+                                 IsSameMnemonic(name, "BCS") || IsSameMnemonic(name, "BVS");
+
+            auto offset = static_cast<int8_t>(operand);
+            uint16_t target = nextPC + offset;
+            int32_t takenCycles = 1 + ((nextPC >> 8) != ((nextPC + offset) >> 8));
+
+            e.AluImmediate(ALU_SUB, REG_CYCLES, ins.cycles);
+            e.TestImmediate(REG_P, flag);
+            size_t notTaken = e.JumpIf(expectedState ? COND_E : COND_NE);
+            e.AluImmediate(ALU_SUB, REG_CYCLES, takenCycles);
+            EmitCheckCycles(target);
+            EmitJumpTo(target);
+            e.Patch(notTaken, e.Position());
+            EmitCheckCycles(nextPC);
+            return false;
+        }
+
+        ////////////////////////////////// SET/CLEAR FLAGS //////////////////////////////////
+        else if(IsSameMnemonic(name, "CLC")) { e.AluImmediate(ALU_AND, REG_P, ~0x01); }
+        else if(IsSameMnemonic(name, "SEC")) { e.AluImmediate(ALU_OR, REG_P, 0x01); }
+        else if(IsSameMnemonic(name, "CLD")) { e.AluImmediate(ALU_AND, REG_P, ~0x08); }
+        else if(IsSameMnemonic(name, "SED")) { e.AluImmediate(ALU_OR, REG_P, 0x08); }
+        else if(IsSameMnemonic(name, "CLI")) { e.AluImmediate(ALU_AND, REG_P, ~0x04); }
+        else if(IsSameMnemonic(name, "SEI")) { e.AluImmediate(ALU_OR, REG_P, 0x04); }
+        else if(IsSameMnemonic(name, "CLV")) { e.AluImmediate(ALU_AND, REG_P, ~0x40); }
+
+        ////////////////////////////////// ADD/SUBTRACT WITH CARRY //////////////////////////////////
+        else if(IsSameMnemonic(name, "ADC") || IsSameMnemonic(name, "SBC")) {
+            //decimal mode is left to the interpreter
+            e.TestImmediate(REG_P, 0x08);
+            exits.push_back({e.JumpIf(COND_NE), PC, true});
+
+            EmitOperand(mode, operand, true);
+            if(IsSameMnemonic(name, "SBC"))
+                e.AluImmediate(ALU_XOR, REG_VALUE, 0xFF);
+
+            //REG_ADDRESS = A + M + C
+            e.Move(REG_ADDRESS, REG_P);
+            e.AluImmediate(ALU_AND, REG_ADDRESS, 0x01);
+            e.Alu(ALU_ADD, REG_ADDRESS, REG_A);
+            e.Alu(ALU_ADD, REG_ADDRESS, REG_VALUE);
+
+            //V = ~(A^M) & (A^R)
+            e.Move(REG_TEMP, REG_A);
+            e.Alu(ALU_XOR, REG_TEMP, REG_VALUE);
+            e.Not(REG_TEMP);
+            e.Move(REG_VALUE, REG_A);
+            e.Alu(ALU_XOR, REG_VALUE, REG_ADDRESS);
+            e.Alu(ALU_AND, REG_TEMP, REG_VALUE);
+            e.AluImmediate(ALU_AND, REG_TEMP, 0x80);
+            e.Shift(SHIFT_RIGHT, REG_TEMP, 1);
+            e.AluImmediate(ALU_AND, REG_P, 0x3C);
+            e.Alu(ALU_OR, REG_P, REG_TEMP);
+
+            //C = bit 8 of the result
+            e.Move(REG_VALUE, REG_ADDRESS);
+            e.Shift(SHIFT_RIGHT, REG_VALUE, 8);
+            e.Alu(ALU_OR, REG_P, REG_VALUE);
+
+            e.AluImmediate(ALU_AND, REG_ADDRESS, 0xFF);
+            e.Move(REG_A, REG_ADDRESS);
+            EmitSetNZ(REG_A);
+        }
+
+        ////////////////////////////////// COMPARE //////////////////////////////////
+        else if(IsSameMnemonic(name, "CMP") || IsSameMnemonic(name, "CPX") || IsSameMnemonic(name, "CPY")) {
+            HostRegister reg = IsSameMnemonic(name, "CMP") ? REG_A : RegisterOf(name);
+            EmitOperand(mode, operand, true);
+            e.AluImmediate(ALU_AND, REG_P, 0x7C);
+
+            e.Alu(ALU_CMP, reg, REG_VALUE);
+            size_t notEqual = e.SkipIf(COND_NE);
+            e.AluImmediate(ALU_OR, REG_P, 0x02);
+            e.PatchSkip(notEqual);
+
+            e.Alu(ALU_CMP, reg, REG_VALUE);
+            size_t lower = e.SkipIf(COND_B);
+            e.AluImmediate(ALU_OR, REG_P, 0x01);
+            e.PatchSkip(lower);
+
+            e.Move(REG_TEMP, reg);
+            e.Alu(ALU_SUB, REG_TEMP, REG_VALUE);
+            e.AluImmediate(ALU_AND, REG_TEMP, 0x80);
+            e.Alu(ALU_OR, REG_P, REG_TEMP);
+        }
+
+        ////////////////////////////////// SHIFT AND ROTATE //////////////////////////////////
+        else if(IsSameMnemonic(name, "ASL") || IsSameMnemonic(name, "LSR") ||
+                IsSameMnemonic(name, "ROL") || IsSameMnemonic(name, "ROR")) {
+            bool rotate = name[0] == 'R';
+            bool left = name[2] == 'L';
+            HostRegister value = mode == ACCUMULATOR ? REG_A : REG_VALUE;
+
+            if(mode != ACCUMULATOR) {
+                EmitAddress(mode, operand, false);
+                e.LoadByte(REG_VALUE, REG_ADDRESS);
+            }
+            if(rotate) {
+                //old carry goes into the bit freed by the shift
+                e.Move(REG_TEMP, REG_P);
+                e.AluImmediate(ALU_AND, REG_TEMP, 0x01);
+                if(!left)
+                    e.Shift(SHIFT_LEFT, REG_TEMP, 7);
+            }
+            e.AluImmediate(ALU_AND, REG_P, ~0x01);
+            if(left)
+                e.Alu8(ALU_ADD, value, value);
+            else
+                e.Shift8(SHIFT_RIGHT, value);
+            //shifted out bit is in host carry
+            e.AluImmediate(ALU_ADC, REG_P, 0);
+            if(rotate)
+                e.Alu(ALU_OR, value, REG_TEMP);
+            EmitSetNZ(value);
+
+            if(mode != ACCUMULATOR) {
+                e.StoreByte(REG_VALUE, REG_ADDRESS);
+                writesMemory = true;
+            }
+        }
+
+        ////////////////////////////////// SYSTEM FUNCTIONS //////////////////////////////////
+        else if(IsSameMnemonic(name, "NOP")) { }
+
+        e.AluImmediate(ALU_SUB, REG_CYCLES, ins.cycles);
+        if(writesMemory) {
+            EmitMarkPageWritten();
+            EmitCheckSelfModification(nextPC);
+        }
+        EmitCheckCycles(nextPC);
+        return false;
+    }
+}
+
+bool MOS6502::JIT::IsSupported() {
+    return MOS6502_JIT_ENABLED;
+}
+
+MOS6502::JIT::JIT() : blocks(0x10000) {
+#if MOS6502_JIT_ENABLED
+    //never writable and executable at once (W^X), pages are made writable only while Commit copies a block
+    void* memory = mmap(nullptr, CODE_CACHE_SIZE, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED)
+        return;
+
+    //without executable memory (hardened kernel, execmem policy) every instruction is interpreted
+    if(!Protect(static_cast<uint8_t*>(memory), CODE_CACHE_SIZE, PROT_READ | PROT_EXEC)) {
+        munmap(memory, CODE_CACHE_SIZE);
+        return;
+    }
+    codeCache = static_cast<uint8_t*>(memory);
+#endif
+}
+
+MOS6502::JIT::~JIT() {
+#if MOS6502_JIT_ENABLED
+    if(codeCache != nullptr)
+        munmap(codeCache, CODE_CACHE_SIZE);
+#endif
+}
+
+void MOS6502::JIT::Flush() {
+    for(auto& block : blocks)
+        block.reset();
+    codeCacheUsed = 0;
+}
+
+MOS6502::JIT::BlockFunction MOS6502::JIT::Commit(const std::vector<uint8_t>& code) {
+    //blocks start at 16 byte boundary
+    size_t size = (code.size() + 15) & ~size_t(15);
+    if(codeCacheUsed + size > CODE_CACHE_SIZE)
+        return nullptr;
+
+    uint8_t* destination = codeCache + codeCacheUsed;
+#if MOS6502_JIT_ENABLED
+    //pages shared with blocks committed before stop being executable for the copy, no block runs meanwhile
+    if(!Protect(destination, size, PROT_READ | PROT_WRITE))
+        return nullptr;
+    std::memcpy(destination, code.data(), code.size());
+    if(!Protect(destination, size, PROT_READ | PROT_EXEC))
+        return nullptr;
+#endif
+    codeCacheUsed += size;
+    return reinterpret_cast<BlockFunction>(destination);
+}
+
+MOS6502::JIT::Block* MOS6502::JIT::GetBlock(uint16_t address, const Bus& memory) {
+    if(codeCache == nullptr || address >= Bus::MAX_MEM)
+        return nullptr;
+
+    std::unique_ptr<Block>& block = blocks[address];
+    if(block != nullptr) {
+        if(block->IsUnwritten(memory))
+            return block.get();
+        //data stored next to the code bumps the same pages, translation is kept while its bytes stay the same
+        if(std::memcmp(memory.RAM + address, block->source.data(), block->source.size()) == 0) {
+            block->Validated(memory);
+            return block.get();
+        }
+    }
+
+    BlockCompiler compiler(memory, address);
+    bool translated = compiler.Compile();
+
+    BlockFunction code = nullptr;
+    if(translated) {
+        code = Commit(compiler.Code());
+        if(code == nullptr) {
+            Flush();
+            code = Commit(compiler.Code());
+        }
+    }
+
+    if(block == nullptr)
+        block = std::make_unique<Block>();
+    block->code = code;
+    //untranslated block remembers its first opcode, so decision is repeated only when it changes
+    size_t sourceLength = translated ? compiler.SourceLength() : 1;
+    block->source.assign(memory.RAM + address, memory.RAM + address + sourceLength);
+    block->firstPage = address >> 8;
+    block->lastPage = (address + sourceLength - 1) >> 8;
+    block->Validated(memory);
+    return block.get();
+}
+
+int32_t MOS6502::JIT::Execute(CPU& cpu, int32_t cycles, Bus& memory) {
+    //translated code addresses RAM directly, mapped pages and devices are left to the interpreter
+    if(!memory.flat)
+        return cpu.Execute(cycles, memory);
+
+    int32_t totalCycles = cycles;
+
+    while(cycles > 0){
+        Block* block = GetBlock(cpu.PC, memory);
+
+        bool interpret = true;
+        if(block != nullptr && block->code != nullptr) {
+            State state{memory.RAM, memory.pageGeneration, cycles, cpu.PC, cpu.A, cpu.X, cpu.Y, cpu.S, cpu.P.PS, 0};
+            block->code(&state);
+
+            cycles = state.cycles;
+            cpu.PC = state.PC;
+            cpu.A = state.A;
+            cpu.X = state.X;
+            cpu.Y = state.Y;
+            cpu.S = state.S;
+            cpu.P.PS = state.P;
+            interpret = state.bail;
+        }
+
+        //translated code keeps flags in P, handlers keep them lazy
+        if(interpret) {
+            cpu.LoadLazyFlags();
+            uint8_t instruction = cpu.Fetch8Bits(cycles, memory);
+            CPU::instructionsLookupTable[instruction](cpu, cycles, memory);
+            cpu.StoreLazyFlags();
+        }
+    }
+
+    if(cpu.unknownInstructionTrapped){
+        cpu.unknownInstructionTrapped = false;
+        return -1;
+    }
+
+    return totalCycles - cycles;
+}
@@ -0,0 +1,180 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_jobs.h"
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    /*decimal, 0x or $ prefixed hex, throws std::invalid_argument when text is not a number up to max*/
+    uint64_t ParseNumber(const std::string& text, uint64_t max) {
+        std::string digits = text;
+        int base = 10;
+        if(digits.starts_with("$")) {
+            digits = digits.substr(1);
+            base = 16;
+        } else if(digits.starts_with("0x") || digits.starts_with("0X")) {
+            digits = digits.substr(2);
+            base = 16;
+        }
+
+        size_t parsed = 0;
+        uint64_t value = 0;
+        //stoull would accept a sign and wrap negative numbers around
+        if(!digits.empty() && (digits[0] == '-' || digits[0] == '+'))
+            digits.clear();
+        try {
+            value = std::stoull(digits, &parsed, base);
+        } catch(const std::exception&) {
+            parsed = 0;
+        }
+        if(digits.empty() || parsed != digits.size() || value > max)
+            throw std::invalid_argument("'" + text + "' is not a valid number");
+        return value;
+    }
+}
+
+MOS6502::JobRunner::JobRunner(size_t threadCount) {
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for(size_t i = 0; i < threadCount; i++)
+        workers.push_back(std::make_unique<Worker>());
+}
+
+std::vector<MOS6502::JobResult> MOS6502::JobRunner::Run(const std::vector<Job>& jobs) {
+    //every image is opened once, workers only read it
+    std::map<std::string, std::unique_ptr<ROMImage>> opened;
+    std::vector<const ROMImage*> images;
+    for(const Job& job : jobs){
+        std::unique_ptr<ROMImage>& image = opened[job.romPath];
+        if(!image)
+            image = std::make_unique<ROMImage>(job.romPath);
+        images.push_back(image.get());
+    }
+
+    //neighbouring jobs usually share an image, contiguous ranges keep it warm in the cache of one core
+    for(size_t i = 0; i < workers.size(); i++){
+        size_t first = jobs.size() * i / workers.size();
+        size_t last = jobs.size() * (i + 1) / workers.size();
+        for(size_t job = first; job < last; job++)
+            workers[i]->queue.push_back(job);
+    }
+
+    std::vector<JobResult> results(jobs.size());
+    std::vector<std::exception_ptr> errors(workers.size());
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < workers.size(); i++){
+        threads.emplace_back([&, i]() {
+            try {
+                Work(i, jobs, images, results);
+            } catch(...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+
+    for(std::exception_ptr& error : errors){
+        if(error)
+            std::rethrow_exception(error);
+    }
+    return results;
+}
+
+void MOS6502::JobRunner::Work(size_t self, const std::vector<Job>& jobs, const std::vector<const ROMImage*>& images,
+                              std::vector<JobResult>& results) {
+    Worker& worker = *workers[self];
+    size_t index;
+    while(NextJob(self, index)){
+        const Job& job = jobs[index];
+
+        worker.bus.Reset();
+        worker.bus.Load(job.loadAddress, images[index]->Data(), images[index]->Size());
+        worker.cpu.LoadState(job.state);
+
+        RunResult run = worker.cpu.Run(job.limits, worker.bus);
+        results[index] = JobResult{run, worker.cpu.SaveState()};
+    }
+}
+
+bool MOS6502::JobRunner::NextJob(size_t self, size_t& job) {
+    {
+        Worker& worker = *workers[self];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        if(!worker.queue.empty()) {
+            job = worker.queue.front();
+            worker.queue.pop_front();
+            return true;
+        }
+    }
+
+    //jobs do not create new jobs, once every queue is empty there is nothing left to wait for
+    for(size_t i = 1; i < workers.size(); i++){
+        Worker& victim = *workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if(!victim.queue.empty()) {
+            job = victim.queue.back();
+            victim.queue.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<MOS6502::Job> MOS6502::JobRunner::ParseJobList(std::istream& input) {
+    std::vector<Job> jobs;
+    std::string line;
+    for(size_t lineNumber = 1; std::getline(input, line); lineNumber++){
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+
+        Job job{};
+        if(!(tokens >> job.romPath))
+            continue;
+
+        try {
+            bool hasPC = false;
+            std::string token;
+            while(tokens >> token){
+                size_t equals = token.find('=');
+                if(equals == std::string::npos)
+                    throw std::invalid_argument("expected key=value, got '" + token + "'");
+                std::string key = token.substr(0, equals);
+                std::string value = token.substr(equals + 1);
+
+                if(key == "pc") {
+                    job.state.PC = ParseNumber(value, 0xFFFF);
+                    hasPC = true;
+                }
+                else if(key == "load") job.loadAddress = ParseNumber(value, 0xFFFF);
+                else if(key == "a") job.state.A = ParseNumber(value, 0xFF);
+                else if(key == "x") job.state.X = ParseNumber(value, 0xFF);
+                else if(key == "y") job.state.Y = ParseNumber(value, 0xFF);
+                else if(key == "s") job.state.S = ParseNumber(value, 0xFF);
+                else if(key == "p") job.state.P = ParseNumber(value, 0xFF);
+                else if(key == "cycles") job.limits.cycles = ParseNumber(value, UINT64_MAX);
+                else if(key == "instructions") job.limits.instructions = ParseNumber(value, UINT64_MAX);
+                else if(key == "target") job.limits.targetPC = ParseNumber(value, 0xFFFF);
+                else throw std::invalid_argument("unknown key '" + key + "'");
+            }
+
+            if(!hasPC)
+                throw std::invalid_argument("missing pc");
+            //a job which never stops would block the runner, target alone is never reached by a program that goes astray
+            if(job.limits.cycles == 0 && job.limits.instructions == 0)
+                throw std::invalid_argument("missing cycles or instructions limit");
+        } catch(const std::invalid_argument& error) {
+            throw std::invalid_argument("JobRunner: line " + std::to_string(lineNumber) + ": " + error.what());
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
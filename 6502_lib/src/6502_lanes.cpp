@@ -0,0 +1,285 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_lanes.h"
+#include "6502_cpu_instructions.h"
+
+#include <bit>
+#include <stdexcept>
+
+namespace {
+    constexpr uint8_t FLAG_N = 0b10000000;
+    constexpr uint8_t FLAG_V = 0b01000000;
+    constexpr uint8_t FLAG_D = 0b00001000;
+    constexpr uint8_t FLAG_I = 0b00000100;
+    constexpr uint8_t FLAG_Z = 0b00000010;
+    constexpr uint8_t FLAG_C = 0b00000001;
+
+    constexpr size_t LANES = MOS6502::CPULanes::MAX_LANES;
+
+    /*a where mask is set, b elsewhere*/
+    inline uint8_t Blend(uint8_t mask, uint8_t a, uint8_t b) {
+        return (a & mask) | (b & ~mask);
+    }
+}
+
+size_t MOS6502::CPULanes::AddLane(const CPUState& state, Bus& bus) {
+    if(laneCount == MAX_LANES)
+        throw std::length_error("CPULanes: every lane is taken");
+
+    size_t lane = laneCount++;
+    PC[lane] = state.PC;
+    A[lane] = state.A;
+    X[lane] = state.X;
+    Y[lane] = state.Y;
+    S[lane] = state.S;
+    P[lane] = state.P;
+    memory[lane] = &bus;
+    trapped[lane] = false;
+    cyclesLeft[lane] = 0;
+    return lane;
+}
+
+void MOS6502::CPULanes::Clear() {
+    laneCount = 0;
+}
+
+MOS6502::CPUState MOS6502::CPULanes::GetState(size_t lane) const {
+    return CPUState{PC[lane], S[lane], A[lane], X[lane], Y[lane], P[lane]};
+}
+
+int32_t MOS6502::CPULanes::CyclesUsed(size_t lane) const {
+    return trapped[lane] ? -1 : budget - cyclesLeft[lane];
+}
+
+void MOS6502::CPULanes::Execute(int32_t cycles) {
+    budget = cycles;
+    for(size_t lane = 0; lane < laneCount; lane++){
+        cyclesLeft[lane] = cycles;
+        trapped[lane] = false;
+    }
+
+    while(true){
+        uint32_t running = 0;
+        for(size_t lane = 0; lane < laneCount; lane++){
+            if(cyclesLeft[lane] > 0 && !trapped[lane]) {
+                running |= 1u << lane;
+                opcode[lane] = memory[lane]->Read(PC[lane]);
+            }
+        }
+        if(running == 0)
+            break;
+
+        //lanes waiting on another opcode are masked off
+        uint8_t leader = opcode[std::countr_zero(running)];
+        uint32_t group = 0;
+        for(size_t lane = 0; lane < LANES; lane++){
+            bool member = (running >> lane) & 1u && opcode[lane] == leader;
+            mask[lane] = member ? 0xFF : 0x00;
+            group |= uint32_t(member) << lane;
+        }
+
+        if(ExecuteVector(leader, group)) {
+            vectorInstructions++;
+            continue;
+        }
+        for(uint32_t lanes = group; lanes != 0; lanes &= lanes - 1)
+            ExecuteScalar(std::countr_zero(lanes));
+    }
+}
+
+void MOS6502::CPULanes::ExecuteScalar(size_t lane) {
+    scalar.LoadState(GetState(lane));
+    scalar.LoadLazyFlags();
+
+    //handlers count cycles down from 0
+    int32_t cycles = 0;
+    uint8_t instruction = scalar.Fetch8Bits(cycles, *memory[lane]);
+    CPU::instructionsLookupTable[instruction](scalar, cycles, *memory[lane]);
+
+    scalar.StoreLazyFlags();
+    CPUState state = scalar.SaveState();
+    PC[lane] = state.PC;
+    A[lane] = state.A;
+    X[lane] = state.X;
+    Y[lane] = state.Y;
+    S[lane] = state.S;
+    P[lane] = state.P;
+    cyclesLeft[lane] += cycles;
+
+    if(scalar.unknownInstructionTrapped) {
+        scalar.unknownInstructionTrapped = false;
+        trapped[lane] = true;
+    }
+    scalarInstructions++;
+}
+
+bool MOS6502::CPULanes::ExecuteVector(uint8_t instruction, uint32_t group) {
+    switch(instruction) {
+        case INS_LDA_IM: FetchOperands(group); Load(A, operand); Retire(2, 2); return true;
+        case INS_LDX_IM: FetchOperands(group); Load(X, operand); Retire(2, 2); return true;
+        case INS_LDY_IM: FetchOperands(group); Load(Y, operand); Retire(2, 2); return true;
+
+        case INS_TAX: Load(X, A); Retire(1, 2); return true;
+        case INS_TAY: Load(Y, A); Retire(1, 2); return true;
+        case INS_TXA: Load(A, X); Retire(1, 2); return true;
+        case INS_TYA: Load(A, Y); Retire(1, 2); return true;
+        case INS_TSX: Load(X, S); Retire(1, 2); return true;
+        case INS_TXS:
+            for(size_t lane = 0; lane < LANES; lane++)
+                S[lane] = Blend(mask[lane], X[lane], S[lane]);
+            Retire(1, 2);
+            return true;
+
+        case INS_INX:
+        case INS_DEX:
+        case INS_INY:
+        case INS_DEY: {
+            uint8_t* reg = (instruction == INS_INX || instruction == INS_DEX) ? X : Y;
+            uint8_t step = (instruction == INS_INX || instruction == INS_INY) ? 0x01 : 0xFF;
+            for(size_t lane = 0; lane < LANES; lane++)
+                reg[lane] = Blend(mask[lane], reg[lane] + step, reg[lane]);
+            SetNZ(reg);
+            Retire(1, 2);
+            return true;
+        }
+
+        case INS_CLC: SetFlags(FLAG_C, false); Retire(1, 2); return true;
+        case INS_SEC: SetFlags(FLAG_C, true); Retire(1, 2); return true;
+        case INS_CLD: SetFlags(FLAG_D, false); Retire(1, 2); return true;
+        case INS_SED: SetFlags(FLAG_D, true); Retire(1, 2); return true;
+        case INS_CLI: SetFlags(FLAG_I, false); Retire(1, 2); return true;
+        case INS_SEI: SetFlags(FLAG_I, true); Retire(1, 2); return true;
+        case INS_CLV: SetFlags(FLAG_V, false); Retire(1, 2); return true;
+        case INS_NOP: Retire(1, 2); return true;
+
+        case INS_AND_IM:
+        case INS_ORA_IM:
+        case INS_EOR_IM:
+            FetchOperands(group);
+            Logical(instruction);
+            Retire(2, 2);
+            return true;
+
+        case INS_ADC_IM:
+        case INS_SBC_IM: {
+            //decimal mode lanes run on the cpu
+            uint32_t decimal = 0;
+            for(uint32_t lanes = group; lanes != 0; lanes &= lanes - 1){
+                size_t lane = std::countr_zero(lanes);
+                if(P[lane] & FLAG_D) {
+                    decimal |= 1u << lane;
+                    mask[lane] = 0x00;
+                }
+            }
+            group &= ~decimal;
+            FetchOperands(group);
+            AddWithCarry(instruction == INS_SBC_IM);
+            Retire(2, 2);
+            for(; decimal != 0; decimal &= decimal - 1)
+                ExecuteScalar(std::countr_zero(decimal));
+            return true;
+        }
+
+        case INS_CMP_IM: FetchOperands(group); Compare(A); Retire(2, 2); return true;
+        case INS_CPX_IM: FetchOperands(group); Compare(X); Retire(2, 2); return true;
+        case INS_CPY_IM: FetchOperands(group); Compare(Y); Retire(2, 2); return true;
+
+        case INS_BEQ: FetchOperands(group); Branch(FLAG_Z, true); return true;
+        case INS_BNE: FetchOperands(group); Branch(FLAG_Z, false); return true;
+        case INS_BMI: FetchOperands(group); Branch(FLAG_N, true); return true;
+        case INS_BPL: FetchOperands(group); Branch(FLAG_N, false); return true;
+        case INS_BCS: FetchOperands(group); Branch(FLAG_C, true); return true;
+        case INS_BCC: FetchOperands(group); Branch(FLAG_C, false); return true;
+        case INS_BVS: FetchOperands(group); Branch(FLAG_V, true); return true;
+        case INS_BVC: FetchOperands(group); Branch(FLAG_V, false); return true;
+
+        default:
+            return false;
+    }
+}
+
+void MOS6502::CPULanes::FetchOperands(uint32_t group) {
+    //every lane reads its own memory, gathered one lane at a time
+    for(; group != 0; group &= group - 1){
+        size_t lane = std::countr_zero(group);
+        operand[lane] = memory[lane]->Read(uint16_t(PC[lane] + 1));
+    }
+}
+
+void MOS6502::CPULanes::Retire(uint8_t bytes, uint8_t cycles) {
+    for(size_t lane = 0; lane < LANES; lane++){
+        PC[lane] += mask[lane] & bytes;
+        cyclesLeft[lane] -= mask[lane] & cycles;
+    }
+}
+
+void MOS6502::CPULanes::Load(uint8_t* reg, const uint8_t* value) {
+    for(size_t lane = 0; lane < LANES; lane++)
+        reg[lane] = Blend(mask[lane], value[lane], reg[lane]);
+    SetNZ(reg);
+}
+
+void MOS6502::CPULanes::SetFlags(uint8_t flags, bool set) {
+    for(size_t lane = 0; lane < LANES; lane++)
+        P[lane] = Blend(mask[lane], set ? (P[lane] | flags) : (P[lane] & ~flags), P[lane]);
+}
+
+void MOS6502::CPULanes::SetNZ(const uint8_t* value) {
+    for(size_t lane = 0; lane < LANES; lane++){
+        uint8_t nz = (value[lane] & FLAG_N) | (value[lane] == 0 ? FLAG_Z : 0);
+        P[lane] = Blend(mask[lane], (P[lane] & ~(FLAG_N | FLAG_Z)) | nz, P[lane]);
+    }
+}
+
+void MOS6502::CPULanes::Logical(uint8_t instruction) {
+    for(size_t lane = 0; lane < LANES; lane++){
+        uint8_t result;
+        if(instruction == INS_AND_IM)
+            result = A[lane] & operand[lane];
+        else if(instruction == INS_ORA_IM)
+            result = A[lane] | operand[lane];
+        else
+            result = A[lane] ^ operand[lane];
+        A[lane] = Blend(mask[lane], result, A[lane]);
+    }
+    SetNZ(A);
+}
+
+void MOS6502::CPULanes::AddWithCarry(bool subtract) {
+    //SBC adds complement of the operand, same as the binary path of the cpu
+    uint8_t complement = subtract ? 0xFF : 0x00;
+    for(size_t lane = 0; lane < LANES; lane++){
+        uint8_t value = operand[lane] ^ complement;
+        uint16_t sum = A[lane] + value + (P[lane] & FLAG_C);
+        uint8_t result = uint8_t(sum);
+        uint8_t overflow = (~(A[lane] ^ value) & (A[lane] ^ result) & 0x80) ? FLAG_V : 0;
+        uint8_t flags = (sum > 0xFF ? FLAG_C : 0) | overflow | (result & FLAG_N) | (result == 0 ? FLAG_Z : 0);
+
+        P[lane] = Blend(mask[lane], (P[lane] & ~(FLAG_N | FLAG_V | FLAG_Z | FLAG_C)) | flags, P[lane]);
+        A[lane] = Blend(mask[lane], result, A[lane]);
+    }
+}
+
+void MOS6502::CPULanes::Compare(const uint8_t* reg) {
+    for(size_t lane = 0; lane < LANES; lane++){
+        uint8_t difference = reg[lane] - operand[lane];
+        uint8_t flags = (reg[lane] >= operand[lane] ? FLAG_C : 0) | (difference & FLAG_N) | (difference == 0 ? FLAG_Z : 0);
+        P[lane] = Blend(mask[lane], (P[lane] & ~(FLAG_N | FLAG_Z | FLAG_C)) | flags, P[lane]);
+    }
+}
+
+void MOS6502::CPULanes::Branch(uint8_t flag, bool expectedState) {
+    for(size_t lane = 0; lane < LANES; lane++){
+        uint16_t next = PC[lane] + 2;
+        uint16_t target = next + int8_t(operand[lane]);
+        bool taken = ((P[lane] & flag) != 0) == expectedState;
+        bool pageCrossed = (next >> 8) != (target >> 8);
+
+        uint8_t cycles = 2 + taken + (taken & pageCrossed);
+        uint16_t pc = taken ? target : next;
+        PC[lane] = mask[lane] ? pc : PC[lane];
+        cyclesLeft[lane] -= mask[lane] & cycles;
+    }
+}
@@ -0,0 +1,132 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace {
+    std::string Hex16(uint16_t value) {
+        char text[8];
+        std::snprintf(text, sizeof(text), "$%04X", value);
+        return text;
+    }
+
+    /*percent of total, 0 when nothing was recorded*/
+    double Percent(uint64_t part, uint64_t total) {
+        return total == 0 ? 0.0 : 100.0 * double(part) / double(total);
+    }
+}
+
+const std::array<uint8_t, 256> MOS6502::Profiler::baseCycles = [](){
+    std::array<uint8_t, 256> cycles{};
+    for(const instruction& ins : InstructionsDataTable)
+        cycles[ins.opcode] = ins.cycles;
+    return cycles;
+}();
+
+const std::array<bool, 256> MOS6502::Profiler::isBranch = [](){
+    std::array<bool, 256> branches{};
+    for(const instruction& ins : InstructionsDataTable)
+        branches[ins.opcode] = ins.addressingMode == RELATIVE;
+    return branches;
+}();
+
+MOS6502::Profiler::Profiler() : pcCycles(0x10000) {
+    nodes.push_back(Node{0, 0, 0, 0});
+}
+
+void MOS6502::Profiler::Clear() {
+    opcodeCount.fill(0);
+    opcodeCycles.fill(0);
+    std::fill(pcCycles.begin(), pcCycles.end(), 0);
+    pageCrossings = branchesTaken = branchesNotTaken = 0;
+    irqs = nmis = interruptCycles = 0;
+
+    nodes.resize(1);
+    nodes[0].cycles = 0;
+    children.clear();
+    current = 0;
+    overflowDepth = 0;
+}
+
+void MOS6502::Profiler::Call(uint16_t target) {
+    if(nodes[current].depth >= MAX_DEPTH) {
+        overflowDepth++;
+        return;
+    }
+
+    uint64_t key = (uint64_t(current) << 16) | target;
+    auto [child, inserted] = children.try_emplace(key, uint32_t(nodes.size()));
+    if(inserted)
+        nodes.push_back(Node{target, current, nodes[current].depth + 1, 0});
+    current = child->second;
+}
+
+void MOS6502::Profiler::WriteFlatProfile(std::ostream& output, size_t addressCount) const {
+    uint64_t totalCycles = interruptCycles;
+    uint64_t totalInstructions = 0;
+    for(size_t opcode = 0; opcode < 256; opcode++){
+        totalCycles += opcodeCycles[opcode];
+        totalInstructions += opcodeCount[opcode];
+    }
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "instructions: %llu, cycles: %llu\n",
+                  (unsigned long long)totalInstructions, (unsigned long long)totalCycles);
+    output << line;
+    std::snprintf(line, sizeof(line), "page crossings: %llu, branches taken: %llu, not taken: %llu\n",
+                  (unsigned long long)pageCrossings, (unsigned long long)branchesTaken, (unsigned long long)branchesNotTaken);
+    output << line;
+    std::snprintf(line, sizeof(line), "interrupts: IRQ %llu, NMI %llu, entry cycles %llu\n\n",
+                  (unsigned long long)irqs, (unsigned long long)nmis, (unsigned long long)interruptCycles);
+    output << line;
+
+    std::vector<uint8_t> opcodes;
+    for(size_t opcode = 0; opcode < 256; opcode++){
+        if(opcodeCount[opcode] != 0)
+            opcodes.push_back(uint8_t(opcode));
+    }
+    std::sort(opcodes.begin(), opcodes.end(), [this](uint8_t first, uint8_t second) {
+        return opcodeCycles[first] != opcodeCycles[second] ? opcodeCycles[first] > opcodeCycles[second] : first < second;
+    });
+
+    output << "  %cycles        cycles         count  opcode\n";
+    for(uint8_t opcode : opcodes){
+        const instruction* ins = FindInstruction(opcode);
+        std::snprintf(line, sizeof(line), "%8.2f  %12llu  %12llu  $%02X %s\n",
+                      Percent(opcodeCycles[opcode], totalCycles), (unsigned long long)opcodeCycles[opcode],
+                      (unsigned long long)opcodeCount[opcode], opcode, ins != nullptr ? ins->name : "???");
+        output << line;
+    }
+
+    std::vector<uint16_t> addresses;
+    for(uint32_t address = 0; address < pcCycles.size(); address++){
+        if(pcCycles[address] != 0)
+            addresses.push_back(uint16_t(address));
+    }
+    size_t shown = std::min(addressCount, addresses.size());
+    std::partial_sort(addresses.begin(), addresses.begin() + shown, addresses.end(), [this](uint16_t first, uint16_t second) {
+        return pcCycles[first] != pcCycles[second] ? pcCycles[first] > pcCycles[second] : first < second;
+    });
+
+    output << "\n  %cycles        cycles  address\n";
+    for(size_t i = 0; i < shown; i++){
+        std::snprintf(line, sizeof(line), "%8.2f  %12llu  %s\n", Percent(pcCycles[addresses[i]], totalCycles),
+                      (unsigned long long)pcCycles[addresses[i]], Hex16(addresses[i]).c_str());
+        output << line;
+    }
+}
+
+void MOS6502::Profiler::WriteCollapsedStacks(std::ostream& output) const {
+    //nodes are created after their parents, so names can be built in a single pass
+    std::vector<std::string> names(nodes.size());
+    for(size_t i = 0; i < nodes.size(); i++){
+        names[i] = i == 0 ? "root" : names[nodes[i].parent] + ";" + Hex16(nodes[i].address);
+        if(nodes[i].cycles != 0)
+            output << names[i] << ' ' << nodes[i].cycles << '\n';
+    }
+}
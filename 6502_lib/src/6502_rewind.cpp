@@ -0,0 +1,159 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_rewind.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+MOS6502::RewindBuffer::RewindBuffer(uint64_t captureInterval, size_t memoryCap)
+    : captureInterval(captureInterval), memoryCap(memoryCap) {
+    if(captureInterval == 0)
+        throw std::invalid_argument("RewindBuffer: capture interval can not be 0");
+}
+
+MOS6502::RunResult MOS6502::RewindBuffer::Run(CPU& cpu, Bus& bus, uint64_t cycles) {
+    RunResult result{STOP_REASON::CYCLES, 0, 0, 0};
+    uint64_t end = now + cycles;
+
+    if(frames.empty() || now >= nextCapture)
+        Capture(cpu, bus);
+
+    while(now < end){
+        RunLimits limits{};
+        limits.cycles = std::min(nextCapture, end) - now;
+        RunResult slice = cpu.Run(limits, bus);
+
+        now += slice.cycles;
+        result.cycles += slice.cycles;
+        result.instructions += slice.instructions;
+
+        //instruction crossing the boundary is captured after it ends
+        if(now >= nextCapture)
+            Capture(cpu, bus);
+
+        if(slice.reason != STOP_REASON::CYCLES) {
+            result.reason = slice.reason;
+            return result;
+        }
+    }
+
+    if(now > end)
+        result.overshoot = uint32_t(now - end);
+    return result;
+}
+
+void MOS6502::RewindBuffer::Capture(const CPU& cpu, const Bus& bus) {
+    //deltas of another bus can not be applied
+    if(newest.size() != bus.RAM_SIZE)
+        frames.clear();
+
+    Frame frame{now, cpu.SaveState(), {}};
+    if(frames.empty()) {
+        newest.assign(bus.RAM, bus.RAM + bus.RAM_SIZE);
+        memoryUsed = newest.size();
+    } else {
+        scratch.clear();
+        EncodeDelta(newest.data(), bus.RAM, bus.RAM_SIZE, scratch);
+        frame.delta.assign(scratch.begin(), scratch.end());
+        std::memcpy(newest.data(), bus.RAM, bus.RAM_SIZE);
+    }
+
+    memoryUsed += sizeof(Frame) + frame.delta.size();
+    frames.push_back(std::move(frame));
+    //frames stay on multiples of the interval, overshoot of an instruction does not accumulate
+    nextCapture = (now / captureInterval + 1) * captureInterval;
+    DropOldFrames();
+}
+
+uint64_t MOS6502::RewindBuffer::StepBack(uint64_t cycles, CPU& cpu, Bus& bus) {
+    if(frames.empty())
+        return now;
+
+    uint64_t target = now > cycles ? now - cycles : 0;
+    size_t index = frames.size() - 1;
+    while(index > 0 && frames[index].cycle > target){
+        //RAM of the previous frame
+        ApplyDelta(newest.data(), frames[index].delta);
+        memoryUsed -= sizeof(Frame) + frames[index].delta.size();
+        frames.pop_back();
+        index--;
+    }
+
+    const Frame& frame = frames.back();
+    cpu.LoadState(frame.cpu);
+    std::memcpy(bus.RAM, newest.data(), std::min<size_t>(bus.RAM_SIZE, newest.size()));
+    //decoded code and snapshots can not see this write
+    bus.hostWriteEpoch++;
+
+    now = frame.cycle;
+    nextCapture = (now / captureInterval + 1) * captureInterval;
+    return now;
+}
+
+void MOS6502::RewindBuffer::Clear() {
+    frames.clear();
+    newest.clear();
+    memoryUsed = 0;
+    now = 0;
+    nextCapture = 0;
+}
+
+void MOS6502::RewindBuffer::DropOldFrames() {
+    while(frames.size() > 1 && memoryUsed > memoryCap){
+        memoryUsed -= sizeof(Frame) + frames.front().delta.size();
+        frames.pop_front();
+
+        //oldest frame has nothing to go back to
+        Frame& oldest = frames.front();
+        memoryUsed -= oldest.delta.size();
+        std::vector<uint8_t>().swap(oldest.delta);
+    }
+}
+
+void MOS6502::RewindBuffer::EncodeDelta(const uint8_t* from, const uint8_t* to, uint32_t size, std::vector<uint8_t>& out) {
+    uint32_t i = 0;
+    uint32_t runStart = 0;
+    while(true){
+        while(i < size && from[i] == to[i])
+            i++;
+        if(i == size)
+            break;
+
+        //literal run ends before MIN_EQUAL_RUN equal bytes, short equal runs are cheaper to store inside it
+        uint32_t literalEnd = i;
+        for(uint32_t j = i; j < size && j - i < MAX_RUN; j++){
+            if(from[j] != to[j])
+                literalEnd = j + 1;
+            else if(j + 1 - literalEnd >= MIN_EQUAL_RUN)
+                break;
+        }
+
+        uint32_t skip = i - runStart;
+        uint32_t count = literalEnd - i;
+        out.push_back(skip & 0xFF);
+        out.push_back(skip >> 8);
+        out.push_back(count & 0xFF);
+        out.push_back(count >> 8);
+        for(uint32_t j = i; j < literalEnd; j++)
+            out.push_back(from[j] ^ to[j]);
+
+        i = literalEnd;
+        runStart = literalEnd;
+    }
+}
+
+void MOS6502::RewindBuffer::ApplyDelta(uint8_t* memory, const std::vector<uint8_t>& delta) {
+    size_t position = 0;
+    size_t i = 0;
+    while(i + 4 <= delta.size()){
+        position += delta[i] | (delta[i + 1] << 8);
+        uint32_t count = delta[i + 2] | (delta[i + 3] << 8);
+        i += 4;
+
+        for(uint32_t j = 0; j < count; j++)
+            memory[position++] ^= delta[i++];
+    }
+}
@@ -0,0 +1,121 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_scheduler.h"
+
+#include <algorithm>
+
+MOS6502::Scheduler::EventId MOS6502::Scheduler::ScheduleAt(uint64_t cycle, Callback callback) {
+    uint32_t slot;
+    if(!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = uint32_t(slots.size());
+        slots.emplace_back();
+    }
+
+    Slot& entry = slots[slot];
+    entry.callback = std::move(callback);
+    entry.generation++;
+    entry.active = true;
+    pending++;
+
+    heap.push_back(Event{cycle, sequence++, slot, entry.generation});
+    std::push_heap(heap.begin(), heap.end(), Later);
+
+    //event scheduled by a device while an instruction runs, the cpu stops in time for it
+    uint64_t current = Now();
+    if(cycle < current + MAX_SLICE)
+        cpu.ShortenSlice(cycle > current ? int32_t(cycle - current) : 0);
+
+    return (uint64_t(entry.generation) << 32) | slot;
+}
+
+bool MOS6502::Scheduler::Cancel(EventId id) {
+    uint32_t slot = uint32_t(id);
+    uint32_t generation = uint32_t(id >> 32);
+    if(slot >= slots.size() || !slots[slot].active || slots[slot].generation != generation)
+        return false;
+
+    //event stays in the heap until it reaches the top or the heap is compacted, its slot is freed then
+    slots[slot].active = false;
+    slots[slot].callback = nullptr;
+    pending--;
+
+    //devices cancel and reschedule on register accesses, heap follows live events and not the access count
+    if(heap.size() > COMPACT_THRESHOLD && heap.size() - pending > pending)
+        Compact();
+    return true;
+}
+
+void MOS6502::Scheduler::Compact() {
+    auto cancelled = [this](const Event& event) {
+        const Slot& entry = slots[event.slot];
+        return !entry.active || entry.generation != event.generation;
+    };
+    for(const Event& event : heap)
+        if(cancelled(event))
+            freeSlots.push_back(event.slot);
+
+    heap.erase(std::remove_if(heap.begin(), heap.end(), cancelled), heap.end());
+    std::make_heap(heap.begin(), heap.end(), Later);
+}
+
+void MOS6502::Scheduler::SkipCancelled() {
+    while(!heap.empty()) {
+        const Event& top = heap.front();
+        const Slot& entry = slots[top.slot];
+        if(entry.active && entry.generation == top.generation)
+            return;
+
+        freeSlots.push_back(top.slot);
+        std::pop_heap(heap.begin(), heap.end(), Later);
+        heap.pop_back();
+    }
+}
+
+uint64_t MOS6502::Scheduler::NextEventCycle() {
+    SkipCancelled();
+    return heap.empty() ? UINT64_MAX : heap.front().cycle;
+}
+
+void MOS6502::Scheduler::FireDueEvents() {
+    //callbacks may schedule new events, due ones fire in this loop as well
+    while(NextEventCycle() <= now) {
+        Event event = heap.front();
+        std::pop_heap(heap.begin(), heap.end(), Later);
+        heap.pop_back();
+
+        Slot& entry = slots[event.slot];
+        Callback callback = std::move(entry.callback);
+        entry.callback = nullptr;
+        entry.active = false;
+        pending--;
+        freeSlots.push_back(event.slot);
+
+        callback(event.cycle);
+    }
+}
+
+MOS6502::STOP_REASON MOS6502::Scheduler::RunFor(uint64_t cycles) {
+    uint64_t end = now + cycles;
+
+    while(true) {
+        FireDueEvents();
+        if(now >= end)
+            return STOP_REASON::CYCLES;
+
+        uint64_t deadline = std::min(end, NextEventCycle());
+        int32_t slice = int32_t(std::min<uint64_t>(deadline - now, MAX_SLICE));
+
+        int32_t executed = cpu.Execute(slice, bus);
+        if(executed < 0) {
+            //time of the instructions before the trap has passed too
+            now += uint64_t(cpu.CyclesBeforeTrap());
+            return STOP_REASON::UNKNOWN_INSTRUCTION;
+        }
+        now += uint64_t(executed);
+    }
+}
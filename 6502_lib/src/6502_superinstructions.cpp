@@ -0,0 +1,63 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#include "6502_superinstructions.h"
+
+#include <algorithm>
+
+MOS6502::OpcodeProfile::OpcodeProfile() : pairs(0x10000) {}
+
+void MOS6502::OpcodeProfile::Clear() {
+    std::fill(pairs.begin(), pairs.end(), 0);
+    triples.clear();
+    history = 0;
+    historyLength = 0;
+}
+
+int32_t MOS6502::OpcodeProfile::Record(CPU& cpu, int32_t cycles, Bus& memory) {
+    int32_t totalCycles = cycles;
+
+    while(cycles > 0){
+        const Bus& bus = memory;
+        uint8_t opcode = bus[cpu.PC];
+
+        if(historyLength >= 1)
+            pairs[((history & 0xFF) << 8) | opcode]++;
+        if(historyLength >= 2)
+            triples[(uint32_t(history) << 8) | opcode]++;
+        history = (history << 8) | opcode;
+        historyLength = std::min<uint8_t>(historyLength + 1, 2);
+
+        //budget of one cycle runs exactly one instruction
+        int32_t cyclesUsed = cpu.Execute(1, memory);
+        if(cyclesUsed < 0)
+            return -1;
+        cycles -= cyclesUsed;
+    }
+
+    return totalCycles - cycles;
+}
+
+std::vector<MOS6502::OpcodeProfile::NGram> MOS6502::OpcodeProfile::Hottest(uint8_t length, size_t count) const {
+    std::vector<NGram> result;
+
+    if(length == 2) {
+        for(uint32_t index = 0; index < pairs.size(); index++){
+            if(pairs[index] != 0)
+                result.push_back({{uint8_t(index >> 8), uint8_t(index), 0}, 2, pairs[index]});
+        }
+    } else if(length == 3) {
+        for(const auto& [index, hits] : triples)
+            result.push_back({{uint8_t(index >> 16), uint8_t(index >> 8), uint8_t(index)}, 3, hits});
+    }
+
+    std::sort(result.begin(), result.end(), [](const NGram& first, const NGram& second) {
+        if(first.count != second.count)
+            return first.count > second.count;
+        return first.opcodes < second.opcodes;
+    });
+    if(result.size() > count)
+        result.resize(count);
+    return result;
+}
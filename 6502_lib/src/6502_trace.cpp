@@ -0,0 +1,159 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_trace.h"
+#include "Instructions.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    //largest chunk handed to fwrite at once, ring buffer wraps around in at most two chunks
+    constexpr size_t WRITE_CHUNK = 4096;
+
+    const std::array<const MOS6502::instruction*, 256> descriptions = [](){
+        std::array<const MOS6502::instruction*, 256> table{};
+        for(const MOS6502::instruction& ins : MOS6502::InstructionsDataTable)
+            table[ins.opcode] = &ins;
+        return table;
+    }();
+
+    std::string FormatOperand(const MOS6502::TraceRecord& record, MOS6502::ADDRESSING_MODE mode) {
+        using namespace MOS6502;
+
+        char text[16] = "";
+        uint8_t low = record.operands[0];
+        uint16_t word = record.operands[0] | (record.operands[1] << 8);
+        switch(mode) {
+            case ACCUMULATOR: std::snprintf(text, sizeof(text), "A"); break;
+            case RELATIVE: std::snprintf(text, sizeof(text), "$%04X", uint16_t(record.PC + 2 + int8_t(low))); break;
+            case IMMEDIATE: std::snprintf(text, sizeof(text), "#$%02X", low); break;
+            case ZERO_PAGE: std::snprintf(text, sizeof(text), "$%02X", low); break;
+            case ZERO_PAGE_X: std::snprintf(text, sizeof(text), "$%02X,X", low); break;
+            case ZERO_PAGE_Y: std::snprintf(text, sizeof(text), "$%02X,Y", low); break;
+            case ABSOLUTE: std::snprintf(text, sizeof(text), "$%04X", word); break;
+            case ABSOLUTE_X: std::snprintf(text, sizeof(text), "$%04X,X", word); break;
+            case ABSOLUTE_Y: std::snprintf(text, sizeof(text), "$%04X,Y", word); break;
+            case INDIRECT_X: std::snprintf(text, sizeof(text), "($%02X,X)", low); break;
+            case INDIRECT_Y: std::snprintf(text, sizeof(text), "($%02X),Y", low); break;
+            case INDIRECT: std::snprintf(text, sizeof(text), "($%04X)", word); break;
+            default: break;
+        }
+        return text;
+    }
+}
+
+MOS6502::TraceRecorder::TraceRecorder(const std::string& path) : ring(new TraceRecord[CAPACITY]) {
+    file = std::fopen(path.c_str(), "wb");
+    if(file == nullptr)
+        throw std::runtime_error("TraceRecorder: can not create " + path);
+
+    uint32_t recordSize = sizeof(TraceRecord);
+    std::fwrite(MAGIC, 1, sizeof(MAGIC), file);
+    std::fwrite(&recordSize, sizeof(recordSize), 1, file);
+
+    writer = std::thread(&TraceRecorder::WriteLoop, this);
+}
+
+MOS6502::TraceRecorder::~TraceRecorder() {
+    Close();
+}
+
+void MOS6502::TraceRecorder::Close() {
+    if(file == nullptr)
+        return;
+
+    closing.store(true, std::memory_order_release);
+    WakeWriter();
+    writer.join();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void MOS6502::TraceRecorder::WriteLoop() {
+    while(true){
+        //wake ups are read before head, so a batch pushed after this point always ends the wait below
+        uint32_t seen = wakeups.load(std::memory_order_acquire);
+        //read closing first, records pushed before Close are then visible in head
+        bool last = closing.load(std::memory_order_acquire);
+        uint64_t end = head.load(std::memory_order_acquire);
+        uint64_t position = tail.load(std::memory_order_relaxed);
+
+        if(position == end) {
+            if(last)
+                return;
+            wakeups.wait(seen, std::memory_order_acquire);
+            continue;
+        }
+
+        while(position != end){
+            size_t index = position & (CAPACITY - 1);
+            size_t count = std::min<uint64_t>({end - position, CAPACITY - index, WRITE_CHUNK});
+            std::fwrite(&ring[index], sizeof(TraceRecord), count, file);
+            position += count;
+            tail.store(position, std::memory_order_release);
+            //Push may be waiting for room
+            tail.notify_one();
+        }
+    }
+}
+
+std::string MOS6502::DecodeTraceRecord(const TraceRecord& record, uint64_t cycle) {
+    bool interrupt = record.flags & (TRACE_IRQ | TRACE_NMI);
+    const instruction* ins = interrupt ? nullptr : descriptions[record.opcode];
+    uint8_t length = ins != nullptr ? ins->bytes : 1;
+
+    char bytes[12];
+    if(interrupt)
+        bytes[0] = '\0';
+    else if(length == 1)
+        std::snprintf(bytes, sizeof(bytes), "%02X", record.opcode);
+    else if(length == 2)
+        std::snprintf(bytes, sizeof(bytes), "%02X %02X", record.opcode, record.operands[0]);
+    else
+        std::snprintf(bytes, sizeof(bytes), "%02X %02X %02X", record.opcode, record.operands[0], record.operands[1]);
+
+    std::string assembly = ins != nullptr ? ins->name : "???";
+    std::string operand = ins != nullptr ? FormatOperand(record, ins->addressingMode) : "";
+    if(interrupt) {
+        assembly = (record.flags & TRACE_NMI) ? "NMI" : "IRQ";
+        operand = "-> " + FormatOperand(record, ABSOLUTE);
+    }
+    if(!operand.empty())
+        assembly += " " + operand;
+
+    char line[128];
+    int size = std::snprintf(line, sizeof(line), "%10llu %04X  %-8s  %-13s A:%02X X:%02X Y:%02X S:%02X P:%02X",
+                             (unsigned long long)cycle, record.PC, bytes, assembly.c_str(),
+                             record.A, record.X, record.Y, record.S, record.P);
+    if(record.writeCount == 1)
+        std::snprintf(line + size, sizeof(line) - size, "  [$%04X]=$%02X", record.writeAddress, record.writeValue);
+    else if(record.writeCount > 1)
+        std::snprintf(line + size, sizeof(line) - size, "  [$%04X]=$%02X (%u writes)", record.writeAddress,
+                      record.writeValue, record.writeCount);
+    return line;
+}
+
+void MOS6502::DecodeTrace(std::istream& input, std::ostream& output) {
+    char magic[sizeof(TraceRecorder::MAGIC)];
+    uint32_t recordSize = 0;
+    input.read(magic, sizeof(magic));
+    input.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));
+    if(!input || std::memcmp(magic, TraceRecorder::MAGIC, sizeof(magic)) != 0 || recordSize != sizeof(TraceRecord))
+        throw std::runtime_error("DecodeTrace: input is not a trace file");
+
+    uint64_t cycle = 0;
+    std::vector<TraceRecord> records(WRITE_CHUNK);
+    while(input){
+        input.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(TraceRecord));
+        size_t count = input.gcount() / sizeof(TraceRecord);
+        for(size_t i = 0; i < count; i++){
+            output << DecodeTraceRecord(records[i], cycle) << '\n';
+            cycle += records[i].cycles;
+        }
+    }
+}
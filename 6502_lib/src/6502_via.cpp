@@ -0,0 +1,427 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "6502_via.h"
+
+#include <algorithm>
+
+MOS6502::VIA6522::VIA6522(Scheduler& scheduler) : scheduler(scheduler) {
+    t1Anchor = t2Anchor = scheduler.Now();
+}
+
+MOS6502::VIA6522::~VIA6522() {
+    if(event != 0)
+        scheduler.Cancel(event);
+}
+
+void MOS6502::VIA6522::Reset() {
+    CatchUp(scheduler.Now());
+    ora = orb = ddra = ddrb = 0;
+    acr = pcr = ifr = ier = 0;
+    t1Armed = t2Armed = shifting = false;
+    t1NextUnderflow = t2NextUnderflow = UINT64_MAX;
+    Update();
+}
+
+uint16_t MOS6502::VIA6522::T1Counter(uint64_t cycle, bool* reloading) const {
+    if(reloading != nullptr)
+        *reloading = false;
+    if(cycle < t1Anchor)
+        return t1Value;
+
+    uint64_t elapsed = cycle - t1Anchor;
+    if(elapsed <= t1Value)
+        return uint16_t(t1Value - elapsed);
+    //one shot timer keeps counting down through $FFFF
+    if(!T1FreeRun())
+        return uint16_t(t1Value - elapsed);
+
+    //after the first underflow: $FFFF for one cycle, then latch down to 0, period is latch + 2
+    uint64_t phase = (elapsed - t1Value - 1) % (uint64_t(t1Latch) + 2);
+    if(phase == 0) {
+        if(reloading != nullptr)
+            *reloading = true;
+        return 0xFFFF;
+    }
+    return uint16_t(t1Latch - (phase - 1));
+}
+
+uint16_t MOS6502::VIA6522::T2Counter(uint64_t cycle) const {
+    if(T2CountsPulses())
+        return uint16_t(t2Value - t2Pulses);
+    if(cycle < t2Anchor)
+        return t2Value;
+    return uint16_t(t2Value - (cycle - t2Anchor));
+}
+
+uint32_t MOS6502::VIA6522::ShiftPeriod() const {
+    switch(ShiftMode()) {
+        case 1: case 4: case 5: return 2 * (uint32_t(t2LatchLow) + 2);
+        case 2: case 6: return 2;
+        default: return 0;
+    }
+}
+
+void MOS6502::VIA6522::UpdateT1Underflow() {
+    t1NextUnderflow = T1FreeRun() || t1Armed ? t1Anchor + t1Value + 1 : UINT64_MAX;
+}
+
+void MOS6502::VIA6522::UpdateT2Underflow() {
+    t2NextUnderflow = !T2CountsPulses() && t2Armed ? t2Anchor + t2Value + 1 : UINT64_MAX;
+}
+
+void MOS6502::VIA6522::RebaseT1(uint64_t now) {
+    if(now < t1Anchor)
+        return;
+
+    bool reloading = false;
+    uint16_t value = T1Counter(now, &reloading);
+    if(reloading) {
+        t1Anchor = now + 1;
+        t1Value = t1Latch;
+    } else {
+        t1Anchor = now;
+        t1Value = value;
+    }
+    UpdateT1Underflow();
+}
+
+void MOS6502::VIA6522::RebaseT2(uint64_t now) {
+    t2Value = T2Counter(now);
+    t2Anchor = std::max(now, t2Anchor);
+    t2Pulses = 0;
+    UpdateT2Underflow();
+}
+
+void MOS6502::VIA6522::CatchUp(uint64_t now) {
+    if(now >= t1NextUnderflow) {
+        if(T1FreeRun()) {
+            uint64_t period = uint64_t(t1Latch) + 2;
+            uint64_t underflows = 1 + (now - t1NextUnderflow) / period;
+            t1NextUnderflow += underflows * period;
+            //PB7 toggles on every underflow
+            pb7 ^= (underflows & 1) != 0;
+        } else {
+            t1NextUnderflow = UINT64_MAX;
+            t1Armed = false;
+            pb7 = true;
+        }
+        ifr |= IRQ_T1;
+    }
+
+    if(now >= t2NextUnderflow) {
+        t2NextUnderflow = UINT64_MAX;
+        t2Armed = false;
+        ifr |= IRQ_T2;
+    }
+
+    CatchUpShiftRegister(now);
+}
+
+void MOS6502::VIA6522::ShiftBits(uint32_t count) {
+    if(count == 0)
+        return;
+
+    if(ShiftMode() <= 3) {
+        //shift in, every bit is the level of CB2
+        uint8_t fill = cb2 ? 0xFF : 0x00;
+        sr = count >= 8 ? fill : uint8_t((sr << count) | (fill & ((1 << count) - 1)));
+    } else {
+        //shift out rotates, bit 7 goes to CB2 and back to bit 0
+        count %= 8;
+        sr = uint8_t((sr << count) | (sr >> ((8 - count) % 8)));
+    }
+}
+
+void MOS6502::VIA6522::CatchUpShiftRegister(uint64_t now) {
+    uint32_t period = ShiftPeriod();
+    if(!shifting || period == 0 || now < shiftStart)
+        return;
+
+    uint64_t bits = (now - shiftStart) / period;
+    bool freeRunning = ShiftMode() == 4;
+    if(!freeRunning)
+        bits = std::min<uint64_t>(bits, shiftRemaining);
+
+    ShiftBits(uint32_t(freeRunning ? bits % 8 : bits));
+    shiftStart += bits * period;
+    if(freeRunning)
+        return;
+
+    shiftRemaining -= uint32_t(bits);
+    if(shiftRemaining == 0) {
+        shifting = false;
+        ifr |= IRQ_SR;
+    }
+}
+
+void MOS6502::VIA6522::StartShift(uint64_t now) {
+    ifr &= ~IRQ_SR;
+    shifting = ShiftMode() != 0;
+    shiftStart = now + 1;
+    shiftRemaining = 8;
+}
+
+uint8_t MOS6502::VIA6522::ReadPortA() const {
+    return (ora & ddra) | (portAInput & ~ddra);
+}
+
+bool MOS6502::VIA6522::PB7(uint64_t now) const {
+    if(now < t1NextUnderflow)
+        return pb7;
+    //underflows not caught up yet
+    if(!T1FreeRun())
+        return true;
+    uint64_t underflows = 1 + (now - t1NextUnderflow) / (uint64_t(t1Latch) + 2);
+    return pb7 ^ ((underflows & 1) != 0);
+}
+
+uint8_t MOS6502::VIA6522::ReadPortB() const {
+    uint8_t value = (orb & ddrb) | (portBInput & ~ddrb);
+    if(T1DrivesPB7())
+        value = (value & 0x7F) | (PB7(scheduler.Now()) ? 0x80 : 0x00);
+    return value;
+}
+
+uint8_t MOS6502::VIA6522::PortAOutput() const {
+    return (ora & ddra) | ~ddra;
+}
+
+uint8_t MOS6502::VIA6522::PortBOutput() const {
+    uint8_t value = (orb & ddrb) | ~ddrb;
+    if(T1DrivesPB7())
+        value = (value & 0x7F) | (PB7(scheduler.Now()) ? 0x80 : 0x00);
+    return value;
+}
+
+uint8_t MOS6502::VIA6522::Read(uint16_t address) {
+    uint64_t now = scheduler.Now();
+    CatchUp(now);
+
+    uint8_t value = 0;
+    switch(address & 0x0F) {
+        case ORB:
+            value = ReadPortB();
+            ifr &= CB2Independent() ? ~IRQ_CB1 : ~(IRQ_CB1 | IRQ_CB2);
+            break;
+        case ORA:
+            value = ReadPortA();
+            ifr &= CA2Independent() ? ~IRQ_CA1 : ~(IRQ_CA1 | IRQ_CA2);
+            break;
+        case DDRB: value = ddrb; break;
+        case DDRA: value = ddra; break;
+        case T1CL:
+            value = uint8_t(T1Counter(now));
+            ifr &= ~IRQ_T1;
+            break;
+        case T1CH: value = uint8_t(T1Counter(now) >> 8); break;
+        case T1LL: value = uint8_t(t1Latch); break;
+        case T1LH: value = uint8_t(t1Latch >> 8); break;
+        case T2CL:
+            value = uint8_t(T2Counter(now));
+            ifr &= ~IRQ_T2;
+            break;
+        case T2CH: value = uint8_t(T2Counter(now) >> 8); break;
+        case SR:
+            value = sr;
+            StartShift(now);
+            break;
+        case ACR: value = acr; break;
+        case PCR: value = pcr; break;
+        case IFR: value = ifr | ((ifr & ier & 0x7F) != 0 ? 0x80 : 0x00); break;
+        case IER: value = ier | 0x80; break;
+        case ORA_NO_HANDSHAKE: value = ReadPortA(); break;
+    }
+
+    Update();
+    return value;
+}
+
+bool MOS6502::VIA6522::ReadIsStable(uint16_t address) const {
+    switch(address & 0x0F) {
+        //reads clear handshake flags
+        case ORB: return !T1DrivesPB7() && !(ifr & (IRQ_CB1 | IRQ_CB2));
+        case ORA: return !(ifr & (IRQ_CA1 | IRQ_CA2));
+        case T1CL: case T1CH: case T2CL: case T2CH: case SR:
+            return false;
+        case IFR: {
+            //flags already set or enabled in IER (found by the scheduler event) can not appear unnoticed
+            uint8_t watched = ifr | ier;
+            bool t1 = (watched & IRQ_T1) || t1NextUnderflow == UINT64_MAX;
+            bool t2 = (watched & IRQ_T2) || t2NextUnderflow == UINT64_MAX;
+            bool shift = (watched & IRQ_SR) || !shifting || ShiftPeriod() == 0 || ShiftMode() == 4;
+            return t1 && t2 && shift;
+        }
+        default: return true;
+    }
+}
+
+void MOS6502::VIA6522::Write(uint16_t address, uint8_t value) {
+    uint64_t now = scheduler.Now();
+    CatchUp(now);
+
+    switch(address & 0x0F) {
+        case ORB:
+            orb = value;
+            ifr &= CB2Independent() ? ~IRQ_CB1 : ~(IRQ_CB1 | IRQ_CB2);
+            break;
+        case ORA:
+            ora = value;
+            ifr &= CA2Independent() ? ~IRQ_CA1 : ~(IRQ_CA1 | IRQ_CA2);
+            break;
+        case DDRB: ddrb = value; break;
+        case DDRA: ddra = value; break;
+        case T1CL:
+        case T1LL:
+            //new latch is used from the next reload
+            RebaseT1(now);
+            t1Latch = (t1Latch & 0xFF00) | value;
+            break;
+        case T1CH:
+            //counter is loaded from the latch on the cycle after the write
+            t1Latch = (t1Latch & 0x00FF) | (value << 8);
+            t1Anchor = now + 1;
+            t1Value = t1Latch;
+            t1Armed = true;
+            ifr &= ~IRQ_T1;
+            if(T1DrivesPB7())
+                pb7 = false;
+            UpdateT1Underflow();
+            break;
+        case T1LH:
+            RebaseT1(now);
+            t1Latch = (t1Latch & 0x00FF) | (value << 8);
+            ifr &= ~IRQ_T1;
+            break;
+        case T2CL:
+            t2LatchLow = value;
+            break;
+        case T2CH:
+            t2Anchor = now + 1;
+            t2Value = t2LatchLow | (value << 8);
+            t2Pulses = 0;
+            t2Armed = true;
+            ifr &= ~IRQ_T2;
+            UpdateT2Underflow();
+            break;
+        case SR:
+            sr = value;
+            StartShift(now);
+            break;
+        case ACR:
+            //counters keep their values, only the way they count from now on changes
+            RebaseT1(now);
+            RebaseT2(now);
+            acr = value;
+            UpdateT1Underflow();
+            UpdateT2Underflow();
+            shiftStart = std::max(shiftStart, now + 1);
+            if(ShiftMode() == 0)
+                shifting = false;
+            break;
+        case PCR: pcr = value; break;
+        case IFR: ifr &= ~(value & 0x7F); break;
+        case IER:
+            if(value & 0x80)
+                ier |= value & 0x7F;
+            else
+                ier &= ~value;
+            break;
+        case ORA_NO_HANDSHAKE: ora = value; break;
+    }
+
+    Update();
+}
+
+void MOS6502::VIA6522::SetCA1(bool level) {
+    CatchUp(scheduler.Now());
+    //PCR bit 0 selects the active edge, 1 for rising
+    if(level != ca1 && level == bool(pcr & 0x01))
+        ifr |= IRQ_CA1;
+    ca1 = level;
+    Update();
+}
+
+void MOS6502::VIA6522::SetCA2(bool level) {
+    CatchUp(scheduler.Now());
+    //CA2 is an input while PCR bit 3 is clear, bit 2 selects the active edge
+    if(!(pcr & 0x08) && level != ca2 && level == bool(pcr & 0x04))
+        ifr |= IRQ_CA2;
+    ca2 = level;
+    Update();
+}
+
+void MOS6502::VIA6522::SetCB1(bool level) {
+    CatchUp(scheduler.Now());
+    if(level != cb1 && level == bool(pcr & 0x10))
+        ifr |= IRQ_CB1;
+
+    uint8_t mode = ShiftMode();
+    if(level && !cb1 && shifting && (mode == 3 || mode == 7)) {
+        ShiftBits(1);
+        if(--shiftRemaining == 0) {
+            shifting = false;
+            ifr |= IRQ_SR;
+        }
+    }
+    cb1 = level;
+    Update();
+}
+
+void MOS6502::VIA6522::SetCB2(bool level) {
+    //bits shifted in so far saw the old level
+    CatchUp(scheduler.Now());
+    if(!(pcr & 0x80) && level != cb2 && level == bool(pcr & 0x40))
+        ifr |= IRQ_CB2;
+    cb2 = level;
+    Update();
+}
+
+void MOS6502::VIA6522::PulsePB6() {
+    CatchUp(scheduler.Now());
+    if(T2CountsPulses()) {
+        t2Pulses++;
+        if(t2Armed && t2Pulses == uint32_t(t2Value) + 1) {
+            t2Armed = false;
+            ifr |= IRQ_T2;
+        }
+    }
+    Update();
+}
+
+void MOS6502::VIA6522::Update() {
+    bool level = (ifr & ier & 0x7F) != 0;
+    if(level != irqLevel) {
+        irqLevel = level;
+        if(irqOutput)
+            irqOutput(level);
+    }
+
+    //flags already set need no event, the next one is found again when they are cleared
+    uint8_t waiting = ier & ~ifr;
+    uint64_t next = UINT64_MAX;
+    if(waiting & IRQ_T1)
+        next = std::min(next, t1NextUnderflow);
+    if(waiting & IRQ_T2)
+        next = std::min(next, t2NextUnderflow);
+    uint32_t period = ShiftPeriod();
+    if((waiting & IRQ_SR) && shifting && period != 0 && ShiftMode() != 4)
+        next = std::min(next, shiftStart + uint64_t(shiftRemaining) * period);
+
+    if(next == eventCycle)
+        return;
+    if(event != 0)
+        scheduler.Cancel(event);
+    event = 0;
+    eventCycle = next;
+    if(next == UINT64_MAX)
+        return;
+
+    event = scheduler.ScheduleAt(next, [this](uint64_t){
+        event = 0;
+        eventCycle = UINT64_MAX;
+        CatchUp(scheduler.Now());
+        Update();
+    });
+}
@@ -0,0 +1,108 @@
+//
+// Created by Lukasz on 17.10.2026.
+//
+
+#include "Bus.h"
+
+void MOS6502::Bus::MapMemory(uint8_t firstPage, uint16_t pageCount, uint8_t* memory, uint32_t size, bool writable,
+                             Device* registers) {
+    CheckRegion(firstPage, pageCount);
+    if(memory == nullptr || size == 0 || size % PAGE_SIZE != 0 || (pageCount * PAGE_SIZE) % size != 0)
+        throw std::invalid_argument("Bus::MapMemory: size has to be a multiple of page size dividing the region");
+
+    uint16_t memoryPages = size / PAGE_SIZE;
+    for(uint16_t i = 0; i < pageCount; i++){
+        Page& page = pages[firstPage + i];
+        page.read = memory + (i % memoryPages) * PAGE_SIZE;
+        page.write = writable ? page.read : nullptr;
+        page.device = writable ? nullptr : registers;
+        page.mirrorFirstPage = firstPage;
+        page.mirrorPageCount = pageCount;
+        page.mirrorStride = memoryPages < pageCount ? memoryPages : 0;
+    }
+    Remapped(firstPage, pageCount);
+}
+
+void MOS6502::Bus::MapDevice(uint8_t firstPage, uint16_t pageCount, Device* device) {
+    CheckRegion(firstPage, pageCount);
+    if(device == nullptr)
+        throw std::invalid_argument("Bus::MapDevice: device can not be null");
+
+    for(uint16_t i = 0; i < pageCount; i++)
+        pages[firstPage + i] = Page{nullptr, nullptr, device};
+    Remapped(firstPage, pageCount);
+}
+
+void MOS6502::Bus::Unmap(uint8_t firstPage, uint16_t pageCount) {
+    CheckRegion(firstPage, pageCount);
+    for(uint16_t i = 0; i < pageCount; i++)
+        pages[firstPage + i] = Page{};
+    Remapped(firstPage, pageCount);
+}
+
+void MOS6502::Bus::CheckRegion(uint8_t firstPage, uint16_t pageCount) {
+    if(pageCount == 0 || firstPage + pageCount > PAGE_COUNT)
+        throw std::invalid_argument("Bus: region has to lie within the address space");
+}
+
+void MOS6502::Bus::Remapped(uint8_t firstPage, uint16_t pageCount) {
+    flat = false;
+    for(uint16_t i = 0; i < pageCount; i++)
+        pageGeneration[firstPage + i]++;
+}
+
+uint8_t MOS6502::Bus::ReadDevice(uint16_t address) const {
+    Device* device = pages[address >> 8].device;
+    return device != nullptr ? device->Read(address) : 0;
+}
+
+void MOS6502::Bus::WriteDevice(uint16_t address, uint8_t value) {
+    //read only memory passes writes to its registers, unmapped pages ignore them
+    Device* device = pages[address >> 8].device;
+    if(device != nullptr)
+        device->Write(address, value);
+}
+
+MOS6502::Bus::Snapshot MOS6502::Bus::TakeSnapshot() {
+    for(uint32_t i = 0; i < PAGE_COUNT; i++){
+        const Page& page = pages[i];
+        if(page.write == nullptr) {
+            baseline.pages[i].reset();
+            continue;
+        }
+
+        //mirrors share the copy of the first page showing the same memory
+        if(page.mirrorStride != 0 && i - page.mirrorFirstPage >= page.mirrorStride) {
+            baseline.pages[i] = baseline.pages[i - page.mirrorStride];
+        } else if(ChangedSinceBaseline(i)) {
+            auto copy = std::make_shared<PageCopy>();
+            std::memcpy(copy->data(), page.write, PAGE_SIZE);
+            baseline.pages[i] = std::move(copy);
+        }
+        baselineGeneration[i] = pageGeneration[i];
+    }
+    baselineEpoch = hostWriteEpoch;
+    return baseline;
+}
+
+void MOS6502::Bus::RestoreSnapshot(const Snapshot& snapshot) {
+    for(uint32_t i = 0; i < PAGE_COUNT; i++){
+        const Page& page = pages[i];
+        const std::shared_ptr<const PageCopy>& copy = snapshot.pages[i];
+        if(page.write == nullptr || copy == nullptr)
+            continue;
+        if(page.mirrorStride != 0 && i - page.mirrorFirstPage >= page.mirrorStride)
+            continue;
+
+        //page still holds what the snapshot shares with the baseline
+        if(copy == baseline.pages[i] && !ChangedSinceBaseline(i))
+            continue;
+
+        std::memcpy(page.write, copy->data(), PAGE_SIZE);
+        MarkModified(i);
+    }
+
+    baseline = snapshot;
+    std::copy(std::begin(pageGeneration), std::end(pageGeneration), std::begin(baselineGeneration));
+    baselineEpoch = hostWriteEpoch;
+}
@@ -0,0 +1,264 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "NES_mappers.h"
+
+#include <string>
+
+namespace {
+    constexpr uint32_t PRG_BANK_8K = 0x2000;
+    constexpr uint32_t PRG_BANK_16K = 0x4000;
+    constexpr uint32_t PRG_BANK_32K = 0x8000;
+}
+
+MOS6502::PPURegisterMirror::PPURegisterMirror(Bus& bus, Device& ppu) : ppu(ppu) {
+    bus.MapDevice(0x20, 0x20, this);
+}
+
+uint8_t MOS6502::PPURegisterMirror::Read(uint16_t address) {
+    return ppu.Read(0x2000 | (address & 0x07));
+}
+
+void MOS6502::PPURegisterMirror::Write(uint16_t address, uint8_t value) {
+    ppu.Write(0x2000 | (address & 0x07), value);
+}
+
+MOS6502::Mapper::Mapper(Bus& bus, uint8_t* prg, uint32_t prgSize, uint32_t bankSize, uint32_t minSize,
+                        uint32_t maxSize, MIRRORING mirroring)
+    : bus(bus), prg(prg), prgSize(prgSize), mirroring(mirroring) {
+    if(prg == nullptr || prgSize == 0 || prgSize % bankSize != 0)
+        throw std::invalid_argument("Mapper: PRG-ROM size has to be a multiple of the bank size");
+    if(prgSize < minSize || prgSize > maxSize)
+        throw std::invalid_argument("Mapper: PRG-ROM of " + std::to_string(prgSize) + " bytes, mapper takes " +
+                                    std::to_string(minSize) + " - " + std::to_string(maxSize) + " bytes");
+    MapPRGRAM(true, true);
+}
+
+MOS6502::Mapper::~Mapper() {
+    //bus must not point at prgRAM or PRG-ROM banks of a mapper which is gone
+    bus.Unmap(0x60, 0xA0);
+}
+
+void MOS6502::Mapper::MapPRG(uint8_t firstPage, uint32_t bankSize, uint32_t bank) {
+    uint32_t banks = PRGBanks(bankSize);
+    //window larger than PRG-ROM shows it mirrored
+    uint8_t* memory = banks == 0 ? prg : prg + (bank % banks) * bankSize;
+    uint32_t size = banks == 0 ? prgSize : bankSize;
+
+    //remapping invalidates code decoded from the window, same bank is left alone
+    uint16_t pageCount = bankSize / Bus::PAGE_SIZE;
+    const Bus::Page& first = bus.pages[firstPage];
+    const Bus::Page& last = bus.pages[firstPage + pageCount - 1];
+    if(first.read == memory && first.device == this &&
+       last.read == memory + ((pageCount - 1) * Bus::PAGE_SIZE) % size && last.device == this)
+        return;
+    bus.MapMemory(firstPage, pageCount, memory, size, false, this);
+}
+
+void MOS6502::Mapper::MapPRGRAM(bool enabled, bool writable) {
+    if(enabled)
+        bus.MapMemory(0x60, 0x20, prgRAM, PRG_RAM_SIZE, writable);
+    else
+        bus.Unmap(0x60, 0x20);
+}
+
+/////////// NROM ///////////
+
+MOS6502::NROM::NROM(Bus& bus, uint8_t* prg, uint32_t prgSize, MIRRORING mirroring)
+    : Mapper(bus, prg, prgSize, PRG_BANK_16K, PRG_BANK_16K, PRG_BANK_32K, mirroring) {
+    MapPRG(0x80, PRG_BANK_32K, 0);
+}
+
+/////////// MMC1 ///////////
+
+MOS6502::MMC1::MMC1(Bus& bus, uint8_t* prg, uint32_t prgSize, MIRRORING mirroring)
+    : Mapper(bus, prg, prgSize, PRG_BANK_16K, PRG_BANK_16K, UINT32_MAX, mirroring) {
+    UpdateBanks();
+}
+
+void MOS6502::MMC1::Write(uint16_t address, uint8_t value) {
+    //bit 7 clears shift register and fixes last bank at 0xC000
+    if(value & 0x80) {
+        shift = 0x10;
+        control |= 0x0C;
+        UpdateBanks();
+        return;
+    }
+
+    bool lastBit = shift & 0x01;
+    shift = (shift >> 1) | ((value & 0x01) << 4);
+    if(!lastBit)
+        return;
+
+    //fifth write selects register by address
+    switch((address >> 13) & 0x03) {
+        case 0:
+            control = shift;
+            break;
+        case 1:
+            chrBank[0] = shift;
+            break;
+        case 2:
+            chrBank[1] = shift;
+            break;
+        case 3:
+            prgBank = shift;
+            break;
+    }
+    shift = 0x10;
+    UpdateBanks();
+}
+
+void MOS6502::MMC1::UpdateBanks() {
+    static constexpr MIRRORING mirroringModes[4] = {SINGLE_SCREEN_LOWER, SINGLE_SCREEN_UPPER, VERTICAL, HORIZONTAL};
+    mirroring = mirroringModes[control & 0x03];
+
+    uint8_t bank = prgBank & 0x0F;
+    switch((control >> 2) & 0x03) {
+        case 0:
+        case 1:
+            //32 KiB mode ignores lowest bit of the bank
+            MapPRG(0x80, PRG_BANK_32K, bank >> 1);
+            break;
+        case 2:
+            MapPRG(0x80, PRG_BANK_16K, 0);
+            MapPRG(0xC0, PRG_BANK_16K, bank);
+            break;
+        case 3:
+            MapPRG(0x80, PRG_BANK_16K, bank);
+            MapPRG(0xC0, PRG_BANK_16K, PRGBanks(PRG_BANK_16K) - 1);
+            break;
+    }
+
+    bool ramEnabled = !(prgBank & 0x10);
+    if(ramEnabled != bus.IsHostMemory(0x6000))
+        MapPRGRAM(ramEnabled, true);
+}
+
+/////////// UxROM ///////////
+
+MOS6502::UxROM::UxROM(Bus& bus, uint8_t* prg, uint32_t prgSize, MIRRORING mirroring)
+    : Mapper(bus, prg, prgSize, PRG_BANK_16K, PRG_BANK_16K, UINT32_MAX, mirroring) {
+    MapPRG(0x80, PRG_BANK_16K, 0);
+    MapPRG(0xC0, PRG_BANK_16K, PRGBanks(PRG_BANK_16K) - 1);
+}
+
+void MOS6502::UxROM::Write(uint16_t, uint8_t value) {
+    MapPRG(0x80, PRG_BANK_16K, value);
+}
+
+/////////// MMC3 ///////////
+
+MOS6502::MMC3::MMC3(Bus& bus, uint8_t* prg, uint32_t prgSize, MIRRORING mirroring)
+    : Mapper(bus, prg, prgSize, PRG_BANK_8K, 2 * PRG_BANK_8K, UINT32_MAX, mirroring) {
+    UpdateBanks();
+}
+
+void MOS6502::MMC3::Write(uint16_t address, uint8_t value) {
+    //registers are selected by address range and by its lowest bit
+    switch(address & 0xE001) {
+        case 0x8000:
+            bankSelect = value;
+            UpdateBanks();
+            break;
+        case 0x8001:
+            bankRegisters[bankSelect & 0x07] = value;
+            if((bankSelect & 0x07) >= 6)
+                UpdateBanks();
+            break;
+        case 0xA000:
+            mirroring = (value & 0x01) ? HORIZONTAL : VERTICAL;
+            break;
+        case 0xA001:
+            MapPRGRAM(value & 0x80, !(value & 0x40));
+            break;
+        case 0xC000:
+            irqLatch = value;
+            break;
+        case 0xC001:
+            irqCounter = 0;
+            irqReload = true;
+            break;
+        case 0xE000:
+            irqEnabled = false;
+            SetIRQPending(false);
+            break;
+        case 0xE001:
+            irqEnabled = true;
+            break;
+    }
+}
+
+void MOS6502::MMC3::ClockScanline() {
+    if(irqCounter == 0 || irqReload) {
+        irqCounter = irqLatch;
+        irqReload = false;
+    } else {
+        irqCounter--;
+    }
+
+    if(irqCounter == 0 && irqEnabled)
+        SetIRQPending(true);
+}
+
+void MOS6502::MMC3::SetIRQPending(bool pending) {
+    if(pending == irqPending)
+        return;
+    irqPending = pending;
+    if(irqOutput)
+        irqOutput(pending);
+}
+
+void MOS6502::MMC3::UpdateBanks() {
+    uint32_t secondLast = PRGBanks(PRG_BANK_8K) - 2;
+    uint8_t r6 = bankRegisters[6] & 0x3F;
+    uint8_t r7 = bankRegisters[7] & 0x3F;
+
+    //bit 6 swaps windows at 0x8000 and 0xC000
+    if(bankSelect & 0x40) {
+        MapPRG(0x80, PRG_BANK_8K, secondLast);
+        MapPRG(0xC0, PRG_BANK_8K, r6);
+    } else {
+        MapPRG(0x80, PRG_BANK_8K, r6);
+        MapPRG(0xC0, PRG_BANK_8K, secondLast);
+    }
+    MapPRG(0xA0, PRG_BANK_8K, r7);
+    MapPRG(0xE0, PRG_BANK_8K, secondLast + 1);
+}
+
+std::unique_ptr<MOS6502::Mapper> MOS6502::CreateMapper(uint8_t mapperNumber, Bus& bus, uint8_t* prg, uint32_t prgSize,
+                                                       MIRRORING mirroring) {
+    switch(mapperNumber) {
+        case 0:
+            return std::make_unique<NROM>(bus, prg, prgSize, mirroring);
+        case 1:
+            return std::make_unique<MMC1>(bus, prg, prgSize, mirroring);
+        case 2:
+            return std::make_unique<UxROM>(bus, prg, prgSize, mirroring);
+        case 4:
+            return std::make_unique<MMC3>(bus, prg, prgSize, mirroring);
+        default:
+            throw std::invalid_argument("CreateMapper: mapper " + std::to_string(mapperNumber) + " is not implemented");
+    }
+}
+
+MOS6502::Cartridge::Cartridge(Bus& bus, const std::string& path) : image(path) {
+    const uint8_t* header = image.Data();
+    if(image.Size() < HEADER_SIZE || header[0] != 'N' || header[1] != 'E' || header[2] != 'S' || header[3] != 0x1A)
+        throw std::runtime_error("Cartridge: " + path + " is not an iNES image");
+
+    uint32_t prgSize = header[4] * PRG_UNIT;
+    chrSize = header[5] * CHR_UNIT;
+    //flags 6: mirroring in bit 0, trainer in bit 2, low nibble of mapper in bits 4-7, flags 7: high nibble
+    MIRRORING mirroring = (header[6] & 0x01) ? VERTICAL : HORIZONTAL;
+    uint32_t prgOffset = HEADER_SIZE + ((header[6] & 0x04) ? TRAINER_SIZE : 0);
+    mapperNumber = (header[7] & 0xF0) | (header[6] >> 4);
+
+    if(uint64_t(prgOffset) + prgSize + chrSize > image.Size())
+        throw std::runtime_error("Cartridge: " + path + " is shorter than its header says");
+    if(chrSize > 0)
+        chr = image.Data() + prgOffset + prgSize;
+
+    mapper = CreateMapper(mapperNumber, bus, image.Data() + prgOffset, prgSize, mirroring);
+}
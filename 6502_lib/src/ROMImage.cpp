@@ -0,0 +1,80 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#include "ROMImage.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MOS6502_ROM_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MOS6502::ROMImage::ROMImage(const std::string& path) {
+#ifdef MOS6502_ROM_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("ROMImage: can not open " + path);
+
+    struct stat status{};
+    if(fstat(fd, &status) != 0 || status.st_size <= 0 || status.st_size > UINT32_MAX) {
+        close(fd);
+        throw std::runtime_error("ROMImage: " + path + " is empty or too large");
+    }
+
+    //private writable mapping, host patches of ROM get a private copy of the page instead of a fault
+    void* mapping = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping != MAP_FAILED) {
+        data = static_cast<uint8_t*>(mapping);
+        size = uint32_t(status.st_size);
+        return;
+    }
+#endif
+
+    //mmap is not available, image is read instead
+    FILE* file = fopen(path.c_str(), "rb");
+    if(file == nullptr)
+        throw std::runtime_error("ROMImage: can not open " + path);
+
+    uint8_t chunk[4096];
+    size_t bytesRead;
+    while((bytesRead = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        buffer.insert(buffer.end(), chunk, chunk + bytesRead);
+    fclose(file);
+
+    if(buffer.empty() || buffer.size() > UINT32_MAX)
+        throw std::runtime_error("ROMImage: " + path + " is empty or too large");
+    data = buffer.data();
+    size = uint32_t(buffer.size());
+}
+
+MOS6502::ROMImage::~ROMImage() {
+#ifdef MOS6502_ROM_MMAP
+    if(buffer.empty() && data != nullptr)
+        munmap(data, size);
+#endif
+}
+
+void MOS6502::ROMImage::MapTo(Bus& bus, uint8_t firstPage, uint32_t offset, uint32_t size, Device* registers) {
+    if(offset >= this->size)
+        throw std::invalid_argument("ROMImage::MapTo: offset lies outside the image");
+    if(size == 0)
+        size = this->size - offset;
+    if(size > this->size - offset)
+        throw std::invalid_argument("ROMImage::MapTo: region lies outside the image");
+    //pages point straight into the image, a partial page can not be mapped
+    if(size % Bus::PAGE_SIZE != 0)
+        throw std::invalid_argument("ROMImage::MapTo: size " + std::to_string(size) + " is not a multiple of " +
+                                    std::to_string(Bus::PAGE_SIZE) + " bytes");
+    if(size / Bus::PAGE_SIZE > Bus::PAGE_COUNT - firstPage)
+        throw std::invalid_argument("ROMImage::MapTo: region does not fit in the address space");
+
+    bus.MapMemory(firstPage, size / Bus::PAGE_SIZE, data + offset, size, false, registers);
+}
@@ -0,0 +1,174 @@
+#include "6502_cpu.h"
+#include "6502_scheduler.h"
+#include "6502_acia.h"
+#include "machine_test.h"
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace MOS6502;
+
+class M6502ACIATest : public M6502MachineTest {
+public:
+    Scheduler scheduler{cpu, mem};
+    std::unique_ptr<ACIA6551> acia{};
+    //host writes to toACIA[1], reads from fromACIA[0]
+    int toACIA[2] = {-1, -1};
+    int fromACIA[2] = {-1, -1};
+
+    virtual void SetUp(){
+        mem.Initialise();
+        ASSERT_EQ(pipe(toACIA), 0);
+        ASSERT_EQ(pipe(fromACIA), 0);
+        fcntl(fromACIA[0], F_SETFL, fcntl(fromACIA[0], F_GETFL) | O_NONBLOCK);
+
+        acia = std::make_unique<ACIA6551>(scheduler, toACIA[0], fromACIA[1]);
+        mem.MapDevice(0x50, 1, acia.get());
+        acia->irqOutput = [this](bool asserted){ cpu.SetIRQ(asserted); };
+
+        LoadNopSled();
+    }
+
+    virtual void TearDown(){
+        acia.reset();
+        for(int fd : {toACIA[0], toACIA[1], fromACIA[0], fromACIA[1]})
+            if(fd >= 0)
+                close(fd);
+    }
+
+    void Send(const std::string& text){
+        ASSERT_EQ(write(toACIA[1], text.data(), text.size()), ssize_t(text.size()));
+    }
+
+    std::string Received(){
+        std::string text;
+        char chunk[4096];
+        ssize_t size;
+        while((size = read(fromACIA[0], chunk, sizeof(chunk))) > 0)
+            text.append(chunk, size);
+        return text;
+    }
+
+    uint8_t Register(ACIA6551::REGISTER reg){
+        return acia->Read(0x5000 + reg);
+    }
+
+    void SetRegister(ACIA6551::REGISTER reg, uint8_t value){
+        acia->Write(0x5000 + reg, value);
+    }
+};
+
+TEST_F(M6502ACIATest, ReceivedBytesArriveWithPoll){
+    //given: terminal ready, receiver interrupt disabled
+    Send("HI");
+    SetRegister(ACIA6551::COMMAND, 0x0B);
+
+    //then: host is not read before the poll
+    EXPECT_EQ(Register(ACIA6551::STATUS) & ACIA6551::RX_FULL, 0);
+
+    //when:
+    scheduler.RunFor(ACIA6551::DEFAULT_POLL_CYCLES);
+
+    //then: both bytes came in one read, next one is loaded as the previous is read
+    EXPECT_EQ(Register(ACIA6551::STATUS), ACIA6551::RX_FULL | ACIA6551::TX_EMPTY);
+    EXPECT_EQ(Register(ACIA6551::DATA), 'H');
+    EXPECT_EQ(Register(ACIA6551::STATUS) & ACIA6551::RX_FULL, ACIA6551::RX_FULL);
+    EXPECT_EQ(Register(ACIA6551::DATA), 'I');
+    EXPECT_EQ(Register(ACIA6551::STATUS) & ACIA6551::RX_FULL, 0);
+}
+
+TEST_F(M6502ACIATest, TransmittedBytesReachHostOnPoll){
+    //given:
+    SetRegister(ACIA6551::COMMAND, 0x0B);
+
+    //when:
+    SetRegister(ACIA6551::DATA, 'O');
+    SetRegister(ACIA6551::DATA, 'K');
+
+    //then:
+    EXPECT_EQ(Received(), "");
+    scheduler.RunFor(ACIA6551::DEFAULT_POLL_CYCLES);
+    EXPECT_EQ(Received(), "OK");
+}
+
+TEST_F(M6502ACIATest, ProgramEchoesMoreThanABufferOfInput){
+    //given:
+    /*
+     * * = $1000
+     *
+     * lda #$0B
+     * sta $5002
+     * loop lda $5001
+     * and #$08
+     * beq loop
+     * lda $5000
+     * sta $5000
+     * jmp loop
+     * */
+    Place(0x1000, {0xA9, 0x0B, 0x8D, 0x02, 0x50,
+                   0xAD, 0x01, 0x50, 0x29, 0x08, 0xF0, 0xF9,
+                   0xAD, 0x00, 0x50, 0x8D, 0x00, 0x50, 0x4C, 0x05, 0x10});
+    std::string text;
+    for(int i = 0; i < 6000; i++)
+        text += char('a' + i % 26);
+    Send(text);
+
+    //when: bytes wrap around the end of both rings
+    scheduler.RunFor(6000 * 30 + 4 * ACIA6551::DEFAULT_POLL_CYCLES);
+
+    //then:
+    EXPECT_EQ(Received(), text);
+}
+
+TEST_F(M6502ACIATest, ReceiverInterruptIsClearedByStatusRead){
+    //given: terminal ready, receiver interrupt enabled
+    SetRegister(ACIA6551::COMMAND, 0x09);
+    Send("A");
+
+    //when:
+    scheduler.RunFor(ACIA6551::DEFAULT_POLL_CYCLES);
+
+    //then:
+    EXPECT_TRUE(acia->IRQ());
+    EXPECT_TRUE(cpu.IRQLine());
+    EXPECT_EQ(Register(ACIA6551::STATUS), ACIA6551::IRQ_FLAG | ACIA6551::RX_FULL | ACIA6551::TX_EMPTY);
+    EXPECT_FALSE(cpu.IRQLine());
+    EXPECT_EQ(Register(ACIA6551::DATA), 'A');
+}
+
+TEST_F(M6502ACIATest, InputClosesAfterEndOfFileIsRead){
+    //given:
+    SetRegister(ACIA6551::COMMAND, 0x0B);
+    Send("x");
+    close(toACIA[1]);
+    toACIA[1] = -1;
+
+    //when:
+    scheduler.RunFor(ACIA6551::DEFAULT_POLL_CYCLES);
+
+    //then: byte is still waiting for the program
+    EXPECT_FALSE(acia->InputClosed());
+
+    //when:
+    Register(ACIA6551::DATA);
+    scheduler.RunFor(ACIA6551::DEFAULT_POLL_CYCLES);
+
+    //then:
+    EXPECT_TRUE(acia->InputClosed());
+}
+
+TEST_F(M6502ACIATest, ProgrammedResetKeepsParityBits){
+    //given:
+    SetRegister(ACIA6551::COMMAND, 0xEB);
+    SetRegister(ACIA6551::CONTROL, 0x1F);
+
+    //when:
+    SetRegister(ACIA6551::STATUS, 0x00);
+
+    //then:
+    EXPECT_EQ(Register(ACIA6551::COMMAND), 0xE0);
+    EXPECT_EQ(Register(ACIA6551::CONTROL), 0x1F);
+}
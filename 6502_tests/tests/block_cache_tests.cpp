@@ -0,0 +1,243 @@
+#include "6502_block_cache.h"
+#include "ROMImage.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+using namespace MOS6502;
+
+class M6502BlockCacheTest : public testing::Test {
+public:
+    Bus mem{};
+    CPU cpu{};
+    BlockCache cache{};
+
+    virtual void SetUp(){
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    static void LoadFunctionalTest(Bus& memory, const char* path){
+        memory.Initialise();
+
+        const size_t TOTAL_BYTES = 65526;
+
+        ROMImage image{path};
+        memory.Load(0x000A, image.Data(), image.Size());
+
+        ASSERT_EQ(image.Size(), TOTAL_BYTES);
+    }
+
+    /*runs interpreter and block cache side by side in small slices until PC reaches successAddress*/
+    void RunInLockstep(const char* path, uint16_t successAddress){
+        Bus interpreterMem{};
+        LoadFunctionalTest(mem, path);
+        LoadFunctionalTest(interpreterMem, path);
+
+        cpu.PC = 0x0400;
+        CPU interpreterCPU = cpu;
+
+        //odd slice, so blocks are left in the middle
+        constexpr int32_t SLICE = 97;
+        //functional tests take about 100M cycles
+        constexpr int32_t MAX_SLICES = 4'000'000;
+
+        int32_t slice = 0;
+        for(; slice < MAX_SLICES && cpu.PC != successAddress; slice++){
+            int32_t cyclesUsed = cache.Execute(cpu, SLICE, mem);
+            int32_t interpreterCyclesUsed = interpreterCPU.Execute(SLICE, interpreterMem);
+
+            ASSERT_EQ(cyclesUsed, interpreterCyclesUsed) << "slice " << slice;
+            ASSERT_EQ(cpu.PC, interpreterCPU.PC) << "slice " << slice;
+            ASSERT_EQ(cpu.A, interpreterCPU.A) << "slice " << slice;
+            ASSERT_EQ(cpu.X, interpreterCPU.X) << "slice " << slice;
+            ASSERT_EQ(cpu.Y, interpreterCPU.Y) << "slice " << slice;
+            ASSERT_EQ(cpu.S, interpreterCPU.S) << "slice " << slice;
+            ASSERT_EQ(cpu.P.PS, interpreterCPU.P.PS) << "slice " << slice;
+        }
+
+        EXPECT_LT(slice, MAX_SLICES);
+        EXPECT_EQ(cpu.PC, successAddress);
+        EXPECT_EQ(std::memcmp(mem.RAM, interpreterMem.RAM, Bus::MAX_MEM), 0);
+    }
+};
+
+TEST_F(M6502BlockCacheTest, BlockCacheCanRunForLoopProgram){
+    //given:
+    int32_t c = 7;
+
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x00, 0x18, 0x69,
+                         0x08, 0xC9, 0x18, 0xD0, 0xFA, 0xA2,
+                         0x14};
+
+    mem.LoadProgram( program, 13);
+    cpu.Reset(c, mem);
+    CPU CPUCopy = cpu;
+
+    //when:
+    int32_t cyclesUsed = cache.Execute(cpu, 40, mem);
+    int32_t cyclesUsedCopy = CPUCopy.Execute(40, mem);
+
+    //then:
+    EXPECT_EQ(cpu.A, 24);
+    EXPECT_EQ(cpu.X, 20);
+    EXPECT_EQ(cyclesUsed, cyclesUsedCopy);
+    EXPECT_EQ(cpu.PC, CPUCopy.PC);
+}
+
+TEST_F(M6502BlockCacheTest, BlockCacheReturnsErrorWhenExecutingUnknownInstruction){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, 0xFF};
+    mem.LoadProgram( program, 5);
+
+    cpu.Reset(c, mem);
+
+    //when:
+    int32_t cyclesUsed = cache.Execute(cpu, 10, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, -1);
+    EXPECT_EQ(cpu.A, 0x84);
+}
+
+TEST_F(M6502BlockCacheTest, BlockCacheUsesSameCyclesAsExecute){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, INSTRUCTIONS::INS_STA_ABS_X, 0x00, 0x20};
+    mem.LoadProgram( program, 7);
+
+    cpu.Reset(c, mem);
+    CPU CPUCopy = cpu;
+
+    //when:
+    int32_t cyclesUsed = cache.Execute(cpu, 3, mem);
+    int32_t cyclesUsedCopy = CPUCopy.Execute(3, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, 7);
+    EXPECT_EQ(cyclesUsed, cyclesUsedCopy);
+    EXPECT_EQ(cpu.PC, CPUCopy.PC);
+}
+
+TEST_F(M6502BlockCacheTest, BlockCacheExecutesCodeModifiedByTheSameBlock){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $1000
+     *
+     * lda #$42
+     * sta $1005   ; operand of ldx below
+     * ldx #$00
+     * */
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x42, 0x8D, 0x06,
+                         0x10, 0xA2, 0x00};
+    mem.LoadProgram( program, 9);
+    cpu.Reset(c, mem);
+
+    //when:
+    cache.Execute(cpu, 8, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x42);
+    EXPECT_EQ(cpu.PC, 0x1007);
+}
+
+TEST_F(M6502BlockCacheTest, BlockCacheDecodesAgainCodeModifiedFromOutside){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x10, 0xA2, 0x01, 0x4C, 0x00, 0x10};
+    mem.LoadProgram( program, 7);
+    cpu.Reset(c, mem);
+    cache.Execute(cpu, 5, mem);
+
+    //when:
+    mem[0x1001] = 0x33;
+    cache.Execute(cpu, 5, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x33);
+}
+
+TEST_F(M6502BlockCacheTest, BlockCacheTakesOperandsFromDecodedInstructions){
+    //given:
+    /*
+     * * = $8000
+     *
+     * ldx #$02
+     * lda $0300,x
+     * sta $10
+     * cmp #$07
+     * bne skip
+     * jsr sub
+     * skip jmp ($0330)
+     *
+     * * = $8020
+     * sub inx
+     * rts
+     *
+     * * = $8040
+     * brk
+     *
+     * * = $8050
+     * end jmp end
+     * */
+    uint8_t rom[Bus::PAGE_SIZE]{};
+    const uint8_t program[] = {0xA2, 0x02, 0xBD, 0x00, 0x03, 0x85, 0x10, 0xC9, 0x07, 0xD0, 0x03,
+                               0x20, 0x20, 0x80, 0x6C, 0x30, 0x03};
+    std::memcpy(rom, program, sizeof(program));
+    rom[0x20] = 0xE8;
+    rom[0x21] = 0x60;
+    rom[0x40] = 0x00;
+    rom[0x50] = 0x4C;
+    rom[0x51] = 0x50;
+    rom[0x52] = 0x80;
+
+    mem.Initialise();
+    //read only page, bus is not flat
+    mem.MapMemory(0x80, 1, rom, sizeof(rom), false);
+    mem[0x0302] = 0x07;
+    mem[0x0330] = 0x40;
+    mem[0x0331] = 0x80;
+    mem[0xFFFE] = 0x50;
+    mem[0xFFFF] = 0x80;
+    cpu.LoadState(CPUState{0x8000, 0xFF, 0, 0, 0, 0x20});
+    CPU CPUCopy = cpu;
+
+    //when:
+    int32_t cyclesUsed = cache.Execute(cpu, 100, mem);
+    int32_t cyclesUsedCopy = CPUCopy.Execute(100, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x03);
+    EXPECT_EQ(cpu.PC, 0x8050);
+    EXPECT_EQ(mem[0x0010], 0x07);
+    EXPECT_EQ(cyclesUsed, cyclesUsedCopy);
+    EXPECT_EQ(cpu.SaveState(), CPUCopy.SaveState());
+}
+
+TEST_F(M6502BlockCacheTest, BlockCacheMatchesInterpreterOnEveryInstructionProgramWithoutDecimalMode){
+    RunInLockstep("bin_programs/6502_functional_test.bin", 0x336d);
+}
+
+TEST_F(M6502BlockCacheTest, BlockCacheMatchesInterpreterOnEveryInstructionProgramWithDecimalMode){
+    RunInLockstep("bin_programs/6502_functional_test_decimal_mode.bin", 0x3469);
+}
+
+TEST_F(M6502BlockCacheTest, BusWriteMarksOnlyItsPageAsModified){
+    //given:
+    uint32_t generation = mem.pageGeneration[0x12];
+    uint32_t otherGeneration = mem.pageGeneration[0x13];
+    uint32_t epoch = mem.hostWriteEpoch;
+
+    //when:
+    mem.Write(0x12FF, 0x42);
+
+    //then:
+    EXPECT_EQ(mem.RAM[0x12FF], 0x42);
+    EXPECT_NE(mem.pageGeneration[0x12], generation);
+    EXPECT_EQ(mem.pageGeneration[0x13], otherGeneration);
+    EXPECT_EQ(mem.hostWriteEpoch, epoch);
+}
@@ -0,0 +1,255 @@
+#include "6502_cpu.h"
+#include "6502_block_cache.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace MOS6502;
+
+/*device remembering every access*/
+class RecordingDevice : public Device {
+public:
+    uint8_t value = 0;
+    std::vector<uint16_t> reads{};
+    std::vector<std::pair<uint16_t, uint8_t>> writes{};
+
+    uint8_t Read(uint16_t address) override {
+        reads.push_back(address);
+        return value;
+    }
+
+    void Write(uint16_t address, uint8_t data) override {
+        writes.emplace_back(address, data);
+    }
+};
+
+class M6502BusTest : public testing::Test {
+public:
+    Bus mem{};
+    CPU cpu{};
+
+    virtual void SetUp(){
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    /*copies program to memory and points cpu at it*/
+    static void Place(Bus& memory, CPU& processor, uint16_t address, const std::vector<uint8_t>& program){
+        for(size_t i = 0; i < program.size(); i++)
+            memory[address + i] = program[i];
+        processor.PC = address;
+        processor.S = 0xFF;
+    }
+};
+
+TEST_F(M6502BusTest, RamOnlyBusIsFlatUntilSomethingIsMapped){
+    //given:
+    RecordingDevice device{};
+
+    //then:
+    EXPECT_TRUE(mem.flat);
+    EXPECT_TRUE(mem.IsHostMemory(0x6000));
+
+    //when:
+    mem.MapDevice(0x60, 1, &device);
+
+    //then:
+    EXPECT_FALSE(mem.flat);
+    EXPECT_FALSE(mem.IsHostMemory(0x6000));
+    EXPECT_TRUE(mem.IsHostMemory(0x6100));
+}
+
+TEST_F(M6502BusTest, NESLayoutMirrorsInternalRam){
+    //given:
+    Bus nes{NES};
+
+    /*
+     * * = $0200
+     *
+     * lda #$42
+     * sta $0805
+     * ldx $1805
+     * */
+    Place(nes, cpu, 0x0200, {INSTRUCTIONS::INS_LDA_IM, 0x42, INSTRUCTIONS::INS_STA_ABS, 0x05, 0x08,
+                             INSTRUCTIONS::INS_LDX_ABS, 0x05, 0x18});
+
+    //when:
+    int32_t cyclesUsed = cpu.Execute(10, nes);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, 10);
+    EXPECT_EQ(cpu.X, 0x42);
+    EXPECT_EQ(nes.RAM[0x0005], 0x42);
+    EXPECT_EQ(nes[0x0005], 0x42);
+    EXPECT_EQ(nes[0x1005], 0x42);
+    EXPECT_EQ(nes[0x2005], 0x00);
+}
+
+TEST_F(M6502BusTest, WriteThroughMirrorMarksEveryMirroredPageAsModified){
+    //given:
+    Bus nes{NES};
+    uint32_t generations[4];
+    for(int i = 0; i < 4; i++)
+        generations[i] = nes.pageGeneration[0x03 + i * 0x08];
+    uint32_t otherPageGeneration = nes.pageGeneration[0x02];
+
+    //when:
+    nes.Write(0x0B10, 0x01);
+
+    //then:
+    for(int i = 0; i < 4; i++)
+        EXPECT_EQ(nes.pageGeneration[0x03 + i * 0x08], generations[i] + 1) << "mirror " << i;
+    EXPECT_EQ(nes.pageGeneration[0x02], otherPageGeneration);
+}
+
+TEST_F(M6502BusTest, BlockCacheExecutesCodeModifiedThroughMirror){
+    //given:
+    Bus nes{NES};
+    BlockCache cache{};
+
+    /*
+     * * = $0200
+     *
+     * lda #$42
+     * sta $0A06   ; mirror of operand of ldx below
+     * ldx #$00
+     * */
+    Place(nes, cpu, 0x0200, {INSTRUCTIONS::INS_LDA_IM, 0x42, INSTRUCTIONS::INS_STA_ABS, 0x06, 0x0A,
+                             INSTRUCTIONS::INS_LDX_IM, 0x00});
+
+    //when:
+    cache.Execute(cpu, 8, nes);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x42);
+    EXPECT_EQ(cpu.PC, 0x0207);
+}
+
+TEST_F(M6502BusTest, CpuCanNotWriteToRom){
+    //given:
+    uint8_t rom[Bus::PAGE_SIZE] = {0x11, 0x22};
+    mem.MapMemory(0xF0, 1, rom, sizeof(rom), false);
+
+    Place(mem, cpu, 0x0200, {INSTRUCTIONS::INS_LDA_IM, 0x42, INSTRUCTIONS::INS_STA_ABS, 0x00, 0xF0,
+                             INSTRUCTIONS::INS_LDX_ABS, 0x01, 0xF0});
+
+    //when:
+    cpu.Execute(10, mem);
+
+    //then:
+    EXPECT_EQ(rom[0], 0x11);
+    EXPECT_EQ(mem[0xF000], 0x11);
+    EXPECT_EQ(cpu.X, 0x22);
+}
+
+TEST_F(M6502BusTest, CpuAccessesToDevicePagesGoToDevice){
+    //given:
+    RecordingDevice device{};
+    device.value = 0x37;
+    mem.MapDevice(0x60, 2, &device);
+
+    Place(mem, cpu, 0x0200, {INSTRUCTIONS::INS_LDA_ABS, 0x01, 0x61, INSTRUCTIONS::INS_STA_ABS, 0x02, 0x60});
+
+    //when:
+    cpu.Execute(8, mem);
+
+    //then:
+    EXPECT_EQ(cpu.A, 0x37);
+    ASSERT_EQ(device.reads.size(), 1);
+    EXPECT_EQ(device.reads[0], 0x6101);
+    ASSERT_EQ(device.writes.size(), 1);
+    EXPECT_EQ(device.writes[0].first, 0x6002);
+    EXPECT_EQ(device.writes[0].second, 0x37);
+}
+
+TEST_F(M6502BusTest, HostReadOfDevicePageHasNoSideEffects){
+    //given:
+    RecordingDevice device{};
+    device.value = 0x37;
+    mem.MapDevice(0x60, 1, &device);
+    const Bus& constMem = mem;
+
+    //when:
+    uint8_t value = constMem[0x6000];
+
+    //then:
+    EXPECT_EQ(value, 0x00);
+    EXPECT_TRUE(device.reads.empty());
+}
+
+TEST_F(M6502BusTest, BlockCacheInterpretsCodeOnDevicePages){
+    //given:
+    RecordingDevice device{};
+    //every byte of the device reads as INX
+    device.value = INSTRUCTIONS::INS_INX;
+    mem.MapDevice(0x60, 1, &device);
+    BlockCache cache{};
+    cpu.PC = 0x6000;
+
+    //when:
+    int32_t cyclesUsed = cache.Execute(cpu, 6, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, 6);
+    EXPECT_EQ(cpu.X, 3);
+    EXPECT_EQ(device.reads.size(), 3);
+}
+
+TEST_F(M6502BusTest, MappingRejectsRegionsOutsideAddressSpace){
+    //given:
+    uint8_t memory[0x300]{};
+    RecordingDevice device{};
+
+    //then:
+    EXPECT_THROW(mem.MapMemory(0xF0, 0x20, memory, 0x100, true), std::invalid_argument);
+    EXPECT_THROW(mem.MapMemory(0x10, 0x04, memory, 0x300, true), std::invalid_argument);
+    EXPECT_THROW(mem.MapDevice(0x10, 0, &device), std::invalid_argument);
+    EXPECT_THROW(mem.MapDevice(0x10, 1, nullptr), std::invalid_argument);
+    EXPECT_NO_THROW(mem.MapMemory(0x10, 0x06, memory, 0x300, true));
+}
+
+TEST_F(M6502BusTest, BusesTakeTheirRamFromArena){
+    //given:
+    MemoryArena arena{2 * Bus::MAX_MEM + Bus::NES_RAM_SIZE + 128};
+
+    //when:
+    Bus first{arena};
+    Bus second{arena};
+    Bus nes{arena, NES};
+    first.Initialise();
+    second.Initialise();
+    first[0x1234] = 0x42;
+
+    //then:
+    EXPECT_TRUE(first.flat);
+    EXPECT_FALSE(nes.flat);
+    EXPECT_EQ(second[0x1234], 0x00);
+    EXPECT_GE(second.RAM, first.RAM + Bus::MAX_MEM);
+    EXPECT_GE(nes.RAM, second.RAM + Bus::MAX_MEM);
+    EXPECT_EQ(uintptr_t(first.RAM) % 64, 0);
+    EXPECT_EQ(uintptr_t(second.RAM) % 64, 0);
+    EXPECT_EQ(uintptr_t(nes.RAM) % 64, 0);
+    EXPECT_EQ(arena.Used(), 2 * Bus::MAX_MEM + Bus::NES_RAM_SIZE);
+    EXPECT_THROW(Bus{arena}, std::bad_alloc);
+}
+
+TEST_F(M6502BusTest, ResetRestoresMemoryMapOfLayout){
+    //given:
+    RecordingDevice device{};
+    uint8_t rom[0x100]{};
+    mem[0x0200] = 0x42;
+    mem.MapDevice(0x60, 1, &device);
+    mem.MapMemory(0x80, 1, rom, 0x100, false);
+
+    //when:
+    mem.Reset();
+
+    //then:
+    EXPECT_TRUE(mem.flat);
+    EXPECT_TRUE(mem.IsHostMemory(0x6000));
+    EXPECT_EQ(mem[0x0200], 0x00);
+    mem.Write(0x8000, 0x17);
+    EXPECT_EQ(mem.RAM[0x8000], 0x17);
+    EXPECT_EQ(rom[0], 0x00);
+}
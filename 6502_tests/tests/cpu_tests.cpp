@@ -1,7 +1,9 @@
 #include "6502_cpu.h"
+#include "ROMImage.h"
 #include <gtest/gtest.h>
 #include <fstream>
 #include <iostream>
+#include <thread>
 
 using namespace MOS6502;
 
@@ -47,6 +49,40 @@ TEST_F(M6502CPUTest, CPUCanExecuteMoreCyclesThanRequestedIfRequiredByTheInstruct
     EXPECT_EQ(cpu.A, 0x84);
 }
 
+TEST_F(M6502CPUTest, CPUReturnsErrorWhenExecutingUnknownInstruction){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, 0xFF};
+    mem.LoadProgram( program, 5);
+
+    cpu.Reset(c, mem);
+
+    //when:
+    int32_t cyclesUsed = cpu.Execute(10, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, -1);
+    EXPECT_EQ(cpu.A, 0x84);
+}
+
+TEST_F(M6502CPUTest, CopiedCPUExecutesOnItsOwnRegisters){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84};
+    mem.LoadProgram( program, 4);
+
+    cpu.Reset(c, mem);
+
+    //when:
+    CPU CPUCopy = cpu;
+    CPUCopy.Execute(2, mem);
+
+    //then:
+    EXPECT_EQ(CPUCopy.A, 0x84);
+    EXPECT_EQ(cpu.A, 0x00);
+    EXPECT_EQ(cpu.PC, 0x8000);
+}
+
 TEST_F(M6502CPUTest, CPUCanRunSimpleProgram){
     //given:
     int32_t c = 7;
@@ -116,19 +152,21 @@ TEST_F(M6502CPUTest, TestEveryInstructionProgramWithoutDecimalMode){
 
     const size_t TOTAL_BYTES = 65526;
 
-    FILE* file = fopen("bin_programs/6502_functional_test.bin", "rb");
-    size_t bytes_read = fread(&mem[0x000A], 1, TOTAL_BYTES, file);
-    fclose(file);
+    //program writes its own memory, so it is copied to RAM instead of being mapped as ROM
+    ROMImage image{"bin_programs/6502_functional_test.bin"};
+    mem.Load(0x000A, image.Data(), image.Size());
 
-    EXPECT_EQ(bytes_read, TOTAL_BYTES);
+    EXPECT_EQ(image.Size(), TOTAL_BYTES);
 
     cpu.PC = 0x0400;
 
-    while ( true ){
-        cpu.Execute(1, mem);
-        if(cpu.PC == 0x336d)
-            break;
-    }
+    RunLimits limits{};
+    limits.targetPC = 0x336d;
+    //program takes about 100M cycles, deadline only stops it when it hangs in a failed test
+    limits.cycles = 200'000'000;
+    RunResult result = cpu.Run(limits, mem);
+
+    EXPECT_EQ(result.reason, STOP_REASON::TARGET_PC);
     EXPECT_EQ(cpu.PC, 0x336d);
 }
 
@@ -137,18 +175,325 @@ TEST_F(M6502CPUTest, TestEveryInstructionProgramWithDecimalMode){
 
     const size_t TOTAL_BYTES = 65526;
 
-    FILE* file = fopen("bin_programs/6502_functional_test_decimal_mode.bin", "rb");
-    size_t bytes_read = fread(&mem[0x000A], 1, TOTAL_BYTES, file);
-    fclose(file);
+    //program writes its own memory, so it is copied to RAM instead of being mapped as ROM
+    ROMImage image{"bin_programs/6502_functional_test_decimal_mode.bin"};
+    mem.Load(0x000A, image.Data(), image.Size());
 
-    EXPECT_EQ(bytes_read, TOTAL_BYTES);
+    EXPECT_EQ(image.Size(), TOTAL_BYTES);
+
+    cpu.PC = 0x0400;
+
+    RunLimits limits{};
+    limits.targetPC = 0x3469;
+    //program takes about 100M cycles, deadline only stops it when it hangs in a failed test
+    limits.cycles = 200'000'000;
+    RunResult result = cpu.Run(limits, mem);
+
+    EXPECT_EQ(result.reason, STOP_REASON::TARGET_PC);
+    EXPECT_EQ(cpu.PC, 0x3469);
+}
+
+TEST_F(M6502CPUTest, ThreadedEngineCanRunForLoopProgram){
+    //given:
+    int32_t c = 7;
+
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x00, 0x18, 0x69,
+                         0x08, 0xC9, 0x18, 0xD0, 0xFA, 0xA2,
+                         0x14};
+
+    mem.LoadProgram( program, 13);
+    cpu.Reset(c, mem);
+
+    //when:
+    cpu.ExecuteThreaded( 40,mem);
+
+    //then:
+    EXPECT_EQ(cpu.A, 24);
+    EXPECT_EQ(cpu.X, 20);
+}
+
+TEST_F(M6502CPUTest, ThreadedEngineReturnsErrorWhenExecutingUnknownInstruction){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, 0xFF};
+    mem.LoadProgram( program, 5);
+
+    cpu.Reset(c, mem);
+
+    //when:
+    int32_t cyclesUsed = cpu.ExecuteThreaded(10, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, -1);
+    EXPECT_EQ(cpu.A, 0x84);
+}
+
+TEST_F(M6502CPUTest, ThreadedEngineUsesSameCyclesAsExecute){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, INSTRUCTIONS::INS_STA_ABS_X, 0x00, 0x20};
+    mem.LoadProgram( program, 7);
+
+    cpu.Reset(c, mem);
+    CPU CPUCopy = cpu;
+
+    //when:
+    int32_t cyclesUsed = cpu.ExecuteThreaded(3, mem);
+    int32_t cyclesUsedCopy = CPUCopy.Execute(3, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, 7);
+    EXPECT_EQ(cyclesUsed, cyclesUsedCopy);
+    EXPECT_EQ(cpu.PC, CPUCopy.PC);
+}
+
+TEST_F(M6502CPUTest, TestEveryInstructionProgramWithoutDecimalModeThreaded){
+    mem.Initialise();
+
+    const size_t TOTAL_BYTES = 65526;
+
+    //program writes its own memory, so it is copied to RAM instead of being mapped as ROM
+    ROMImage image{"bin_programs/6502_functional_test.bin"};
+    mem.Load(0x000A, image.Data(), image.Size());
+
+    EXPECT_EQ(image.Size(), TOTAL_BYTES);
 
     cpu.PC = 0x0400;
 
     while ( true ){
-        cpu.Execute(1, mem);
-        if(cpu.PC == 0x3469)
+        cpu.ExecuteThreaded(1, mem);
+        if(cpu.PC == 0x336d)
             break;
     }
-    EXPECT_EQ(cpu.PC, 0x3469);
-}
\ No newline at end of file
+    EXPECT_EQ(cpu.PC, 0x336d);
+}
+
+TEST_F(M6502CPUTest, CPUPushesFlagsOfBitInstructionWithNegativeTakenFromOperand){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $8000
+     *
+     * lda #$01
+     * bit $10
+     * php
+     * */
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x01, INSTRUCTIONS::INS_BIT_ZP, 0x10,
+                         INSTRUCTIONS::INS_PHP};
+    mem.LoadProgram( program, 7);
+    mem[0x0010] = 0x80;
+
+    cpu.Reset(c, mem);
+    cpu.P.PS = 0;
+
+    //when:
+    int32_t cyclesUsed = cpu.Execute(8, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, 8);
+    EXPECT_TRUE(cpu.P.N);
+    EXPECT_TRUE(cpu.P.Z);
+    EXPECT_FALSE(cpu.P.V);
+    EXPECT_EQ(mem[0x01FF], cpu.NegativeBitFlag | cpu.UnusedBitFlag | cpu.BreakBitFlag | cpu.ZeroBitFlag);
+}
+
+TEST_F(M6502CPUTest, CPUUsesFlagsSetByHostBetweenExecuteCalls){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $8000
+     *
+     * adc #$01
+     * beq skip
+     * ldx #$01
+     * skip ldy #$01
+     * */
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_ADC_IM, 0x01, INSTRUCTIONS::INS_BEQ, 0x02,
+                         INSTRUCTIONS::INS_LDX_IM, 0x01, INSTRUCTIONS::INS_LDY_IM, 0x01};
+    mem.LoadProgram( program, 10);
+
+    cpu.Reset(c, mem);
+    cpu.P.C = 1;
+
+    //when:
+    cpu.Execute(2, mem);
+    bool zeroAfterAdd = cpu.P.Z;
+    cpu.P.Z = 1;
+    cpu.Execute(3, mem);
+
+    //then:
+    EXPECT_EQ(cpu.A, 0x02);
+    EXPECT_FALSE(zeroAfterAdd);
+    EXPECT_FALSE(cpu.P.C);
+    EXPECT_EQ(cpu.X, 0x00);
+    EXPECT_EQ(cpu.PC, 0x8006);
+}
+
+TEST_F(M6502CPUTest, RunStopsAtCycleDeadlineAndReportsOvershoot){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x01, INSTRUCTIONS::INS_LDA_IM, 0x02,
+                         INSTRUCTIONS::INS_LDA_IM, 0x03};
+    mem.LoadProgram( program, 8);
+    cpu.Reset(c, mem);
+
+    RunLimits limits{};
+    limits.cycles = 3;
+
+    //when:
+    RunResult result = cpu.Run(limits, mem);
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::CYCLES);
+    EXPECT_EQ(result.cycles, 4);
+    EXPECT_EQ(result.instructions, 2);
+    EXPECT_EQ(result.overshoot, 1);
+    EXPECT_EQ(cpu.A, 0x02);
+    EXPECT_EQ(cpu.PC, 0x8004);
+}
+
+TEST_F(M6502CPUTest, RunStopsAfterInstructionCount){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x01, INSTRUCTIONS::INS_LDX_IM, 0x02,
+                         INSTRUCTIONS::INS_LDY_IM, 0x03};
+    mem.LoadProgram( program, 8);
+    cpu.Reset(c, mem);
+
+    RunLimits limits{};
+    limits.instructions = 2;
+    limits.cycles = 100;
+
+    //when:
+    RunResult result = cpu.Run(limits, mem);
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::INSTRUCTIONS);
+    EXPECT_EQ(result.cycles, 4);
+    EXPECT_EQ(result.overshoot, 0);
+    EXPECT_EQ(cpu.X, 0x02);
+    EXPECT_EQ(cpu.Y, 0x00);
+}
+
+TEST_F(M6502CPUTest, RunStopsBeforeInstructionAtTargetPC){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x00, 0x18, 0x69,
+                         0x08, 0xC9, 0x18, 0xD0, 0xFA, 0xA2,
+                         0x14};
+    mem.LoadProgram( program, 13);
+    cpu.Reset(c, mem);
+
+    RunLimits limits{};
+    limits.targetPC = 0x1009;
+
+    //when:
+    RunResult result = cpu.Run(limits, mem);
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::TARGET_PC);
+    EXPECT_EQ(result.cycles, 24);
+    EXPECT_EQ(cpu.A, 24);
+    EXPECT_EQ(cpu.X, 0);
+    EXPECT_EQ(cpu.PC, 0x1009);
+}
+
+TEST_F(M6502CPUTest, RunStopsWhenPredicateIsTrue){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $1000
+     *
+     * loop inx
+     * jmp loop
+     * */
+    uint8_t program[] = {0x00, 0x10, INSTRUCTIONS::INS_INX, INSTRUCTIONS::INS_JMP_ABS, 0x00, 0x10};
+    mem.LoadProgram( program, 6);
+    cpu.Reset(c, mem);
+
+    RunLimits limits{};
+    limits.predicate = [](const CPU& cpu, const Bus&) { return cpu.X == 5; };
+
+    //when:
+    RunResult result = cpu.Run(limits, mem);
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::PREDICATE);
+    EXPECT_EQ(result.instructions, 9);
+    EXPECT_EQ(cpu.X, 5);
+    EXPECT_EQ(cpu.PC, 0x1001);
+}
+
+TEST_F(M6502CPUTest, RunStopsOnUnknownInstruction){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, 0xFF};
+    mem.LoadProgram( program, 5);
+    cpu.Reset(c, mem);
+
+    //when:
+    RunResult result = cpu.Run(RunLimits{}, mem);
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::UNKNOWN_INSTRUCTION);
+    EXPECT_EQ(result.instructions, 2);
+    EXPECT_EQ(cpu.A, 0x84);
+}
+
+TEST_F(M6502CPUTest, ExecuteInfiniteRunsUntilStopFlagIsSetFromAnotherThread){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $1000
+     *
+     * loop inx
+     * jmp loop
+     * */
+    uint8_t program[] = {0x00, 0x10, INSTRUCTIONS::INS_INX, INSTRUCTIONS::INS_JMP_ABS, 0x00, 0x10};
+    mem.LoadProgram( program, 6);
+    cpu.Reset(c, mem);
+
+    std::atomic<bool> stop{false};
+    ExecutionCounters counters{};
+    std::thread stopper([&]() {
+        while(counters.cycles.load() < 1'000'000)
+            std::this_thread::yield();
+        stop = true;
+    });
+
+    //when:
+    RunResult result = cpu.ExecuteInfinite(mem, stop, &counters);
+    stopper.join();
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::STOP_REQUESTED);
+    EXPECT_GE(result.cycles, 1'000'000);
+    EXPECT_EQ(counters.cycles.load(), result.cycles);
+    EXPECT_EQ(counters.instructions.load(), result.instructions);
+    //INX takes 2 cycles, JMP 3
+    EXPECT_EQ(result.cycles, result.instructions / 2 * 5 + result.instructions % 2 * 2);
+    EXPECT_EQ(cpu.X, uint8_t((result.instructions + 1) / 2));
+}
+
+TEST_F(M6502CPUTest, ExecuteInfiniteStopsOnUnknownInstruction){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, 0xFF};
+    mem.LoadProgram( program, 5);
+    cpu.Reset(c, mem);
+
+    std::atomic<bool> stop{false};
+
+    //when:
+    RunResult result = cpu.ExecuteInfinite(mem, stop);
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::UNKNOWN_INSTRUCTION);
+    EXPECT_EQ(result.cycles, 2);
+    EXPECT_EQ(result.instructions, 2);
+    EXPECT_EQ(cpu.A, 0x84);
+}
@@ -0,0 +1,180 @@
+#include "6502_cpu.h"
+#include "6502_scheduler.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace MOS6502;
+
+/*status register polled by programs, counts reads and remembers the cycle of every write*/
+class StatusDevice : public Device {
+public:
+    Scheduler& scheduler;
+    uint8_t status = 0;
+    bool stable = true;
+    uint64_t reads = 0;
+    std::vector<uint64_t> writes{};
+
+    explicit StatusDevice(Scheduler& owner) : scheduler(owner) {}
+
+    uint8_t Read(uint16_t) override {
+        reads++;
+        return status;
+    }
+
+    void Write(uint16_t, uint8_t) override {
+        writes.push_back(scheduler.Now());
+        status = 0;
+    }
+
+    bool ReadIsStable(uint16_t) const override { return stable; }
+};
+
+class M6502IdleLoopTest : public testing::Test {
+public:
+    //one machine skipping idle loops and one running every instruction
+    struct Machine {
+        Bus mem{};
+        CPU cpu{};
+        Scheduler scheduler{cpu, mem};
+        StatusDevice device{scheduler};
+
+        Machine(bool skip, const std::vector<uint8_t>& program, bool stable) {
+            mem.Initialise();
+            mem.MapDevice(0x60, 1, &device);
+            device.stable = stable;
+            for(size_t i = 0; i < program.size(); i++)
+                mem[0x1000 + i] = program[i];
+            cpu.skipIdleLoops = skip;
+            cpu.LoadState(CPUState{0x1000, 0xFF, 0, 0, 0, 0x24});
+        }
+
+        /*device raises its status at every cycle of events*/
+        void Run(const std::vector<uint64_t>& events, uint64_t cycles) {
+            for(uint64_t cycle : events)
+                scheduler.ScheduleAt(cycle, [this](uint64_t){ device.status = 0x80; });
+            scheduler.RunFor(cycles);
+        }
+    };
+
+    virtual void SetUp(){
+
+    }
+
+    virtual void TearDown(){
+
+    }
+};
+
+TEST_F(M6502IdleLoopTest, PollingLoopIsSkippedWithExactCycles){
+    //given:
+    /*
+     * * = $1000
+     *
+     * wait bit $6000
+     * bpl wait
+     * inx
+     * sta $6000    ; clears status
+     * jmp wait
+     * */
+    std::vector<uint8_t> program{0x2C, 0x00, 0x60, 0x10, 0xFB, 0xE8, 0x8D, 0x00, 0x60, 0x4C, 0x00, 0x10};
+    std::vector<uint64_t> events{1000, 5003, 123457, 400001};
+    Machine skipping{true, program, true};
+    Machine interpreting{false, program, true};
+
+    //when:
+    skipping.Run(events, 500000);
+    interpreting.Run(events, 500000);
+
+    //then: status is seen on the same cycles, the cpu stops on the same instruction
+    EXPECT_EQ(skipping.device.writes.size(), 4);
+    EXPECT_EQ(skipping.device.writes, interpreting.device.writes);
+    EXPECT_EQ(skipping.cpu.SaveState(), interpreting.cpu.SaveState());
+    EXPECT_EQ(skipping.scheduler.Now(), interpreting.scheduler.Now());
+    EXPECT_EQ(skipping.cpu.X, 4);
+
+    //then: only a few iterations are run after every event
+    EXPECT_GT(interpreting.device.reads, 50000);
+    EXPECT_LT(skipping.device.reads, 100);
+}
+
+TEST_F(M6502IdleLoopTest, JmpToItselfWaitsForInterruptWithoutRunning){
+    //given:
+    /*
+     * * = $1000
+     *
+     * wait jmp wait
+     *
+     * * = $2000
+     * inx
+     * sta $6000
+     * rti
+     * */
+    std::vector<uint8_t> program(0x1005, 0xEA);
+    program[0x0000] = 0x4C;
+    program[0x0001] = 0x00;
+    program[0x0002] = 0x10;
+    program[0x1000] = 0xE8;
+    program[0x1001] = 0x8D;
+    program[0x1002] = 0x00;
+    program[0x1003] = 0x60;
+    program[0x1004] = 0x40;
+
+    Machine skipping{true, program, true};
+    Machine interpreting{false, program, true};
+    for(Machine* machine : {&skipping, &interpreting}) {
+        machine->mem[0xFFFA] = 0x00;
+        machine->mem[0xFFFB] = 0x20;
+        for(uint64_t cycle = 777; cycle < 300000; cycle += 4321)
+            machine->scheduler.ScheduleAt(cycle, [machine](uint64_t){
+                machine->cpu.SetNMI(true);
+                machine->cpu.SetNMI(false);
+            });
+    }
+
+    //when:
+    skipping.scheduler.RunFor(300000);
+    interpreting.scheduler.RunFor(300000);
+
+    //then: every nmi is entered on the same cycle
+    EXPECT_EQ(skipping.device.writes.size(), 70);
+    EXPECT_EQ(skipping.device.writes, interpreting.device.writes);
+    EXPECT_EQ(skipping.cpu.SaveState(), interpreting.cpu.SaveState());
+    EXPECT_EQ(skipping.scheduler.Now(), interpreting.scheduler.Now());
+}
+
+TEST_F(M6502IdleLoopTest, LoopsWhichCanChangeSomethingAreNotSkipped){
+    //given:
+    /*
+     * * = $1000
+     *
+     * wait lda $6000
+     * sta $20      ; writes memory
+     * bpl wait
+     * */
+    std::vector<uint8_t> writing{0xAD, 0x00, 0x60, 0x85, 0x20, 0x10, 0xF9};
+    /*
+     * wait lda $6000   ; register which is not stable
+     * bpl wait
+     * */
+    std::vector<uint8_t> unstable{0xAD, 0x00, 0x60, 0x10, 0xFB};
+    /*
+     * wait lda $6000
+     * inx          ; registers never repeat
+     * jmp wait
+     * */
+    std::vector<uint8_t> counting{0xAD, 0x00, 0x60, 0xE8, 0x4C, 0x00, 0x10};
+
+    Machine writingMachine{true, writing, true};
+    Machine unstableMachine{true, unstable, false};
+    Machine countingMachine{true, counting, true};
+
+    //when:
+    writingMachine.Run({}, 10000);
+    unstableMachine.Run({}, 10000);
+    countingMachine.Run({}, 10000);
+
+    //then: every iteration reads the register
+    EXPECT_GE(writingMachine.device.reads, 10000 / 10);
+    EXPECT_GE(unstableMachine.device.reads, 10000 / 7);
+    EXPECT_GE(countingMachine.device.reads, 10000 / 9);
+}
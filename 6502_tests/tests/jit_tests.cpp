@@ -0,0 +1,218 @@
+#include "6502_jit.h"
+#include "ROMImage.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+using namespace MOS6502;
+
+class M6502JITTest : public testing::Test {
+public:
+    Bus mem{};
+    CPU cpu{};
+    JIT jit{};
+
+    virtual void SetUp(){
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    static void LoadFunctionalTest(Bus& memory, const char* path){
+        memory.Initialise();
+
+        const size_t TOTAL_BYTES = 65526;
+
+        ROMImage image{path};
+        memory.Load(0x000A, image.Data(), image.Size());
+
+        ASSERT_EQ(image.Size(), TOTAL_BYTES);
+    }
+
+    /*runs interpreter and JIT side by side in small slices until PC reaches successAddress*/
+    void RunInLockstep(const char* path, uint16_t successAddress){
+        Bus interpreterMem{};
+        LoadFunctionalTest(mem, path);
+        LoadFunctionalTest(interpreterMem, path);
+
+        cpu.PC = 0x0400;
+        CPU interpreterCPU = cpu;
+
+        //odd slice, so blocks are left in the middle
+        constexpr int32_t SLICE = 97;
+        //functional tests take about 100M cycles
+        constexpr int32_t MAX_SLICES = 4'000'000;
+
+        int32_t slice = 0;
+        for(; slice < MAX_SLICES && cpu.PC != successAddress; slice++){
+            int32_t cyclesUsed = jit.Execute(cpu, SLICE, mem);
+            int32_t interpreterCyclesUsed = interpreterCPU.Execute(SLICE, interpreterMem);
+
+            ASSERT_EQ(cyclesUsed, interpreterCyclesUsed) << "slice " << slice;
+            ASSERT_EQ(cpu.PC, interpreterCPU.PC) << "slice " << slice;
+            ASSERT_EQ(cpu.A, interpreterCPU.A) << "slice " << slice;
+            ASSERT_EQ(cpu.X, interpreterCPU.X) << "slice " << slice;
+            ASSERT_EQ(cpu.Y, interpreterCPU.Y) << "slice " << slice;
+            ASSERT_EQ(cpu.S, interpreterCPU.S) << "slice " << slice;
+            ASSERT_EQ(cpu.P.PS, interpreterCPU.P.PS) << "slice " << slice;
+        }
+
+        EXPECT_LT(slice, MAX_SLICES);
+        EXPECT_EQ(cpu.PC, successAddress);
+        EXPECT_EQ(std::memcmp(mem.RAM, interpreterMem.RAM, Bus::MAX_MEM), 0);
+    }
+};
+
+TEST_F(M6502JITTest, JITCanRunForLoopProgram){
+    //given:
+    int32_t c = 7;
+
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x00, 0x18, 0x69,
+                         0x08, 0xC9, 0x18, 0xD0, 0xFA, 0xA2,
+                         0x14};
+
+    mem.LoadProgram( program, 13);
+    cpu.Reset(c, mem);
+    CPU CPUCopy = cpu;
+
+    //when:
+    int32_t cyclesUsed = jit.Execute(cpu, 40, mem);
+    int32_t cyclesUsedCopy = CPUCopy.Execute(40, mem);
+
+    //then:
+    EXPECT_EQ(cpu.A, 24);
+    EXPECT_EQ(cpu.X, 20);
+    EXPECT_EQ(cyclesUsed, cyclesUsedCopy);
+    EXPECT_EQ(cpu.PC, CPUCopy.PC);
+}
+
+TEST_F(M6502JITTest, JITReturnsErrorWhenExecutingUnknownInstruction){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, 0xFF};
+    mem.LoadProgram( program, 5);
+
+    cpu.Reset(c, mem);
+
+    //when:
+    int32_t cyclesUsed = jit.Execute(cpu, 10, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, -1);
+    EXPECT_EQ(cpu.A, 0x84);
+}
+
+TEST_F(M6502JITTest, CodeCacheIsNeverWritableAndExecutable){
+    if(!JIT::IsSupported())
+        GTEST_SKIP() << "code is not translated on this host";
+
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x00, 0x18, 0x69,
+                         0x08, 0xC9, 0x18, 0xD0, 0xFA, 0xA2,
+                         0x14};
+    mem.LoadProgram( program, 13);
+    cpu.Reset(c, mem);
+
+    //when:
+    jit.Execute(cpu, 40, mem);
+
+    //then: no mapping of the process has permissions rwx
+    std::ifstream maps{"/proc/self/maps"};
+    std::string line;
+    while(std::getline(maps, line))
+        EXPECT_EQ(line.find(" rwx"), std::string::npos) << line;
+    EXPECT_EQ(cpu.X, 20);
+}
+
+TEST_F(M6502JITTest, JITUsesSameCyclesAsExecute){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x80, INSTRUCTIONS::INS_LDA_IM, 0x84, INSTRUCTIONS::INS_STA_ABS_X, 0x00, 0x20};
+    mem.LoadProgram( program, 7);
+
+    cpu.Reset(c, mem);
+    CPU CPUCopy = cpu;
+
+    //when:
+    int32_t cyclesUsed = jit.Execute(cpu, 3, mem);
+    int32_t cyclesUsedCopy = CPUCopy.Execute(3, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, 7);
+    EXPECT_EQ(cyclesUsed, cyclesUsedCopy);
+    EXPECT_EQ(cpu.PC, CPUCopy.PC);
+}
+
+TEST_F(M6502JITTest, JITExecutesCodeModifiedByTheSameBlock){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $1000
+     *
+     * lda #$42
+     * sta $1006   ; operand of ldx below
+     * ldx #$00
+     * */
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x42, 0x8D, 0x06,
+                         0x10, 0xA2, 0x00};
+    mem.LoadProgram( program, 9);
+    cpu.Reset(c, mem);
+
+    //when:
+    jit.Execute(cpu, 8, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x42);
+    EXPECT_EQ(cpu.PC, 0x1007);
+}
+
+TEST_F(M6502JITTest, JITRetranslatesCodeModifiedFromOutside){
+    //given:
+    int32_t c = 7;
+    uint8_t program[] = {0x00, 0x10, 0xA2, 0x01, 0x4C, 0x00, 0x10};
+    mem.LoadProgram( program, 7);
+    cpu.Reset(c, mem);
+    jit.Execute(cpu, 5, mem);
+
+    //when:
+    mem[0x1001] = 0x33;
+    jit.Execute(cpu, 5, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x33);
+}
+
+TEST_F(M6502JITTest, JITRetranslatesBlockWhenItsLastPageIsWritten){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $10FF
+     *
+     * loop ldx #$01   ; operand on page $11
+     * jmp loop
+     * */
+    uint8_t program[] = {0xFF, 0x10, 0xA2, 0x01, 0x4C, 0xFF, 0x10};
+    mem.LoadProgram( program, 7);
+    cpu.Reset(c, mem);
+    jit.Execute(cpu, 5, mem);
+
+    //when:
+    mem.Write(0x1100, 0x33);
+    jit.Execute(cpu, 5, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x33);
+}
+
+TEST_F(M6502JITTest, JITMatchesInterpreterOnEveryInstructionProgramWithoutDecimalMode){
+    RunInLockstep("bin_programs/6502_functional_test.bin", 0x336d);
+}
+
+TEST_F(M6502JITTest, JITMatchesInterpreterOnEveryInstructionProgramWithDecimalMode){
+    RunInLockstep("bin_programs/6502_functional_test_decimal_mode.bin", 0x3469);
+}
@@ -0,0 +1,142 @@
+#include "6502_jobs.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace MOS6502;
+
+class M6502JobsTest : public testing::Test {
+public:
+    std::string path = testing::TempDir() + "6502_jobs_test.bin";
+
+    virtual void SetUp(){
+        /*
+         * * = $1000
+         *
+         * loop clc
+         * adc #$03
+         * dex
+         * bne loop
+         * sta $20
+         * end jmp end
+         * */
+        uint8_t program[] = {0x18, 0x69, 0x03, 0xCA, 0xD0, 0xFA,
+                             0x85, 0x20, 0x4C, 0x08, 0x10};
+        FILE* file = fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(program, 1, sizeof(program), file);
+        fclose(file);
+    }
+
+    virtual void TearDown(){
+        std::remove(path.c_str());
+    }
+};
+
+TEST_F(M6502JobsTest, JobsGiveSameResultsAsRunningThemAlone){
+    //given:
+    std::vector<Job> jobs;
+    for(uint8_t i = 0; i < 40; i++){
+        Job job{};
+        job.romPath = path;
+        job.loadAddress = 0x1000;
+        job.state.PC = 0x1000;
+        job.state.X = i + 1;
+        job.limits.targetPC = 0x1008;
+        job.limits.cycles = 100000;
+        jobs.push_back(job);
+    }
+    JobRunner runner{4};
+
+    //when:
+    std::vector<JobResult> results = runner.Run(jobs);
+
+    //then:
+    ASSERT_EQ(results.size(), jobs.size());
+    for(size_t i = 0; i < jobs.size(); i++){
+        Bus mem{};
+        CPU cpu{};
+        ROMImage image{path};
+        mem.Load(0x1000, image.Data(), image.Size());
+        cpu.LoadState(jobs[i].state);
+        RunResult expected = cpu.Run(jobs[i].limits, mem);
+
+        EXPECT_EQ(results[i].run.reason, STOP_REASON::TARGET_PC);
+        EXPECT_EQ(results[i].run.cycles, expected.cycles);
+        EXPECT_EQ(results[i].state, cpu.SaveState());
+        EXPECT_EQ(results[i].state.A, uint8_t(3 * (i + 1)));
+    }
+}
+
+TEST_F(M6502JobsTest, RunnerCanBeReusedWithMoreJobsThanThreads){
+    //given:
+    Job job{};
+    job.romPath = path;
+    job.loadAddress = 0x1000;
+    job.state.PC = 0x1000;
+    job.state.X = 5;
+    job.limits.targetPC = 0x1008;
+    JobRunner runner{3};
+
+    //when:
+    std::vector<JobResult> first = runner.Run(std::vector<Job>(7, job));
+    std::vector<JobResult> second = runner.Run(std::vector<Job>(2, job));
+
+    //then: memory written by earlier jobs does not leak into later ones
+    EXPECT_EQ(first.size(), 7);
+    EXPECT_EQ(second.size(), 2);
+    for(const JobResult& result : second)
+        EXPECT_EQ(result.state, first[0].state);
+}
+
+TEST_F(M6502JobsTest, MissingImageThrowsBeforeRunning){
+    //given:
+    Job job{};
+    job.romPath = testing::TempDir() + "6502_jobs_test_missing.bin";
+    job.limits.cycles = 10;
+    JobRunner runner{2};
+
+    //then:
+    EXPECT_THROW(runner.Run({job}), std::runtime_error);
+}
+
+TEST_F(M6502JobsTest, JobListIsParsed){
+    //given:
+    std::istringstream input(
+            "# image        start\n"
+            "\n"
+            "test.bin pc=0x0400 load=$000A target=0x3469 cycles=200000000\n"
+            "other.bin pc=4096 a=1 x=$FF y=0x10 s=0xFD p=0x24 instructions=100 # comment\n");
+
+    //when:
+    std::vector<Job> jobs = JobRunner::ParseJobList(input);
+
+    //then:
+    ASSERT_EQ(jobs.size(), 2);
+    EXPECT_EQ(jobs[0].romPath, "test.bin");
+    EXPECT_EQ(jobs[0].state.PC, 0x0400);
+    EXPECT_EQ(jobs[0].loadAddress, 0x000A);
+    EXPECT_EQ(jobs[0].limits.targetPC, 0x3469);
+    EXPECT_EQ(jobs[0].limits.cycles, 200000000);
+
+    EXPECT_EQ(jobs[1].romPath, "other.bin");
+    EXPECT_EQ(jobs[1].state, (CPUState{0x1000, 0xFD, 0x01, 0xFF, 0x10, 0x24}));
+    EXPECT_EQ(jobs[1].limits.instructions, 100);
+    EXPECT_FALSE(jobs[1].limits.targetPC.has_value());
+}
+
+TEST_F(M6502JobsTest, InvalidJobListThrows){
+    std::istringstream missingStop("test.bin pc=0x0400\n");
+    std::istringstream targetOnly("test.bin pc=0x0400 target=0x3469\n");
+    std::istringstream missingPC("test.bin cycles=10\n");
+    std::istringstream badNumber("test.bin pc=0x10000 cycles=10\n");
+    std::istringstream unknownKey("test.bin pc=0x0400 speed=2 cycles=10\n");
+
+    EXPECT_THROW(JobRunner::ParseJobList(missingStop), std::invalid_argument);
+    EXPECT_THROW(JobRunner::ParseJobList(targetOnly), std::invalid_argument);
+    EXPECT_THROW(JobRunner::ParseJobList(missingPC), std::invalid_argument);
+    EXPECT_THROW(JobRunner::ParseJobList(badNumber), std::invalid_argument);
+    EXPECT_THROW(JobRunner::ParseJobList(unknownKey), std::invalid_argument);
+}
@@ -0,0 +1,145 @@
+#include "6502_lanes.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace MOS6502;
+
+class M6502LanesTest : public testing::Test {
+public:
+    CPULanes lanes{};
+
+    virtual void SetUp(){
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    /*runs every lane alone with CPU::Execute on a copy of its memory and compares it with the lanes*/
+    void ExpectSameAsAlone(std::vector<std::unique_ptr<Bus>>& laneMemory, std::vector<std::unique_ptr<Bus>>& aloneMemory,
+                           const std::vector<CPUState>& states, int32_t cycles){
+        for(size_t lane = 0; lane < states.size(); lane++)
+            lanes.AddLane(states[lane], *laneMemory[lane]);
+
+        lanes.Execute(cycles);
+
+        for(size_t lane = 0; lane < states.size(); lane++){
+            CPU alone{};
+            alone.LoadState(states[lane]);
+            int32_t cyclesUsed = alone.Execute(cycles, *aloneMemory[lane]);
+
+            EXPECT_EQ(lanes.CyclesUsed(lane), cyclesUsed) << "lane " << lane;
+            EXPECT_EQ(lanes.GetState(lane), alone.SaveState()) << "lane " << lane;
+            EXPECT_EQ(std::memcmp(laneMemory[lane]->RAM, aloneMemory[lane]->RAM, Bus::MAX_MEM), 0) << "lane " << lane;
+        }
+    }
+
+    static std::vector<std::unique_ptr<Bus>> MakeMemories(size_t count, const std::vector<uint8_t>& program){
+        std::vector<std::unique_ptr<Bus>> memories;
+        for(size_t i = 0; i < count; i++){
+            memories.push_back(std::make_unique<Bus>());
+            memories.back()->LoadProgram(program.data(), uint32_t(program.size()));
+        }
+        return memories;
+    }
+};
+
+TEST_F(M6502LanesTest, DivergentLoopsMatchCpusRunAlone){
+    //given:
+    /*
+     * * = $1000
+     *
+     * loop adc #$07
+     * cmp #$80
+     * bcc skip
+     * sta $10,x
+     * skip dex
+     * bne loop
+     * tay
+     * iny
+     * end jmp end
+     * */
+    std::vector<uint8_t> program = {0x00, 0x10, 0x69, 0x07, 0xC9, 0x80,
+                                    0x90, 0x02, 0x95, 0x10, 0xCA, 0xD0,
+                                    0xF4, 0xA8, 0xC8, 0x4C, 0x0F, 0x10};
+    std::vector<CPUState> states;
+    for(uint8_t lane = 0; lane < 16; lane++)
+        states.push_back(CPUState{0x1000, 0xFF, uint8_t(lane * 13), uint8_t(lane + 1), 0x00, 0x20});
+    auto laneMemory = MakeMemories(states.size(), program);
+    auto aloneMemory = MakeMemories(states.size(), program);
+
+    //then:
+    ExpectSameAsAlone(laneMemory, aloneMemory, states, 300);
+    EXPECT_GT(lanes.vectorInstructions, 0);
+}
+
+TEST_F(M6502LanesTest, DecimalModeLanesMatchCpusRunAlone){
+    //given:
+    /*
+     * * = $1000
+     *
+     * adc #$19
+     * sbc #$08
+     * adc #$99
+     * end jmp end
+     * */
+    std::vector<uint8_t> program = {0x00, 0x10, 0x69, 0x19, 0xE9, 0x08,
+                                    0x69, 0x99, 0x4C, 0x08, 0x10};
+    std::vector<CPUState> states;
+    for(uint8_t lane = 0; lane < 8; lane++){
+        //every other lane in decimal mode, every fourth with carry
+        uint8_t P = 0x20 | (lane & 1 ? 0x08 : 0x00) | (lane & 2 ? 0x01 : 0x00);
+        states.push_back(CPUState{0x1000, 0xFF, uint8_t(lane * 0x11), 0x00, 0x00, P});
+    }
+    auto laneMemory = MakeMemories(states.size(), program);
+    auto aloneMemory = MakeMemories(states.size(), program);
+
+    //then:
+    ExpectSameAsAlone(laneMemory, aloneMemory, states, 12);
+}
+
+TEST_F(M6502LanesTest, UnknownInstructionStopsOnlyItsLane){
+    //given:
+    std::vector<uint8_t> program = {0x00, 0x10, 0xE8, 0xE8, 0x02, 0xE8};
+    auto memories = MakeMemories(2, program);
+    memories[1]->Write(0x1002, INSTRUCTIONS::INS_NOP);
+    lanes.AddLane(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20}, *memories[0]);
+    lanes.AddLane(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20}, *memories[1]);
+
+    //when:
+    lanes.Execute(8);
+
+    //then:
+    EXPECT_EQ(lanes.CyclesUsed(0), -1);
+    EXPECT_EQ(lanes.GetState(0).X, 2);
+    EXPECT_EQ(lanes.CyclesUsed(1), 8);
+}
+
+TEST_F(M6502LanesTest, RandomProgramsMatchCpusRunAlone){
+    //given:
+    std::mt19937 random{6502};
+    //mostly instructions with a vector implementation, so lanes keep meeting on the same opcode
+    const uint8_t vectorOpcodes[] = {0xA9, 0xA2, 0xA0, 0xAA, 0xA8, 0x8A, 0x98, 0xBA, 0x9A, 0xE8, 0xC8, 0xCA, 0x88,
+                                     0x18, 0x38, 0xD8, 0xF8, 0x58, 0x78, 0xB8, 0xEA, 0x29, 0x09, 0x49, 0x69, 0xE9,
+                                     0xC9, 0xE0, 0xC0, 0xF0, 0xD0, 0x30, 0x10, 0xB0, 0x90, 0x70, 0x50};
+    std::vector<uint8_t> program(2 + 0x800);
+    program[0] = 0x00;
+    program[1] = 0x10;
+    for(size_t i = 2; i < program.size(); i++)
+        program[i] = random() % 4 == 0 ? uint8_t(random()) : vectorOpcodes[random() % std::size(vectorOpcodes)];
+
+    std::vector<CPUState> states;
+    for(size_t lane = 0; lane < CPULanes::MAX_LANES; lane++){
+        uint16_t PC = 0x1000 + random() % 0x700;
+        states.push_back(CPUState{PC, uint8_t(random()), uint8_t(random()), uint8_t(random()), uint8_t(random()),
+                                  uint8_t(random() | 0x20)});
+    }
+    auto laneMemory = MakeMemories(states.size(), program);
+    auto aloneMemory = MakeMemories(states.size(), program);
+
+    //then:
+    ExpectSameAsAlone(laneMemory, aloneMemory, states, 2000);
+}
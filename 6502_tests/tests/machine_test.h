@@ -0,0 +1,39 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+
+#ifndef INC_6502_PROJECT_MACHINE_TEST_H
+#define INC_6502_PROJECT_MACHINE_TEST_H
+
+#include "6502_cpu.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Bus and cpu shared by fixtures running small programs, devices of a fixture are declared after them.
+ * SetUp of the fixture initialises memory, tests place their code with Place.
+ */
+class M6502MachineTest : public testing::Test {
+public:
+    MOS6502::Bus mem{};
+    MOS6502::CPU cpu{};
+
+    void Place(uint16_t address, const std::vector<uint8_t>& program){
+        for(size_t i = 0; i < program.size(); i++)
+            mem[address + i] = program[i];
+    }
+
+    /*
+     * Long run of nops from $1000 to $7FFF, then jmp $1000, cpu starts at $1000 with IRQ masked (P = $24).
+     * Every instruction takes 2 cycles, so device tests can count cycles exactly.
+     */
+    void LoadNopSled(){
+        for(uint16_t address = 0x1000; address < 0x8000; address++)
+            mem[address] = MOS6502::INS_NOP;
+        Place(0x8000, {0x4C, 0x00, 0x10});
+        cpu.LoadState(MOS6502::CPUState{0x1000, 0xFF, 0, 0, 0, 0x24});
+    }
+};
+
+#endif //INC_6502_PROJECT_MACHINE_TEST_H
@@ -0,0 +1,270 @@
+#include "6502_cpu.h"
+#include "6502_block_cache.h"
+#include "NES_mappers.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace MOS6502;
+
+/*ppu stand-in remembering register accesses*/
+class RegisterFile : public Device {
+public:
+    uint8_t registers[8]{};
+
+    uint8_t Read(uint16_t address) override {
+        return registers[address - 0x2000];
+    }
+
+    void Write(uint16_t address, uint8_t value) override {
+        registers[address - 0x2000] = value;
+    }
+};
+
+class M6502NESMappersTest : public testing::Test {
+public:
+    Bus nes{NES};
+    CPU cpu{};
+
+    virtual void SetUp(){
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    /*PRG-ROM with number of every 8 KiB bank in its first byte*/
+    static std::vector<uint8_t> MakePRG(uint32_t size){
+        std::vector<uint8_t> prg(size, 0xEA);
+        for(uint32_t bank = 0; bank < size / 0x2000; bank++)
+            prg[bank * 0x2000] = bank;
+        return prg;
+    }
+
+    /*writes value to address like the cpu does*/
+    void CpuWrite(uint16_t address, uint8_t value){
+        nes.Write(address, value);
+    }
+
+    /*writes 5 bit MMC1 register one bit at a time*/
+    void WriteMMC1(uint16_t address, uint8_t value){
+        for(int i = 0; i < 5; i++)
+            CpuWrite(address, (value >> i) & 0x01);
+    }
+};
+
+TEST_F(M6502NESMappersTest, PPURegistersAreMirroredEveryEightBytes){
+    //given:
+    RegisterFile ppu{};
+    PPURegisterMirror mirror{nes, ppu};
+
+    //when:
+    CpuWrite(0x3FFE, 0x42);
+
+    //then:
+    EXPECT_EQ(ppu.registers[6], 0x42);
+    EXPECT_EQ(nes.Read(0x2006), 0x42);
+    EXPECT_EQ(nes.Read(0x200E), 0x42);
+}
+
+TEST_F(M6502NESMappersTest, NROMMirrors16KiBPRGAndHasPRGRAM){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x4000);
+    NROM cartridge{nes, prg.data(), uint32_t(prg.size())};
+
+    //when:
+    CpuWrite(0x8000, 0x55);
+    CpuWrite(0x6010, 0x66);
+
+    //then:
+    EXPECT_EQ(nes.Read(0x8000), 0);
+    EXPECT_EQ(nes.Read(0xA000), 1);
+    EXPECT_EQ(nes.Read(0xC000), 0);
+    EXPECT_EQ(nes.Read(0xE000), 1);
+    EXPECT_EQ(prg[0], 0);
+    EXPECT_EQ(cartridge.prgRAM[0x10], 0x66);
+}
+
+TEST_F(M6502NESMappersTest, UxROMSwitchesPagesWithoutCopying){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x20000);
+    UxROM cartridge{nes, prg.data(), uint32_t(prg.size())};
+    uint32_t generation = nes.pageGeneration[0x80];
+
+    //when:
+    CpuWrite(0x8000, 3);
+
+    //then:
+    EXPECT_EQ(nes.pages[0x80].read, prg.data() + 3 * 0x4000);
+    EXPECT_EQ(nes.Read(0x8000), 6);
+    EXPECT_EQ(nes.Read(0xC000), 14);
+    EXPECT_EQ(nes.pageGeneration[0x80], generation + 1);
+
+    //when:
+    CpuWrite(0x8000, 3);
+
+    //then:
+    EXPECT_EQ(nes.pageGeneration[0x80], generation + 1);
+}
+
+TEST_F(M6502NESMappersTest, MMC1LoadsRegistersThroughShiftRegister){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x20000);
+    MMC1 cartridge{nes, prg.data(), uint32_t(prg.size())};
+
+    //then:
+    EXPECT_EQ(nes.Read(0xC000), 14);
+
+    //when:
+    WriteMMC1(0xE000, 2);
+
+    //then:
+    EXPECT_EQ(cartridge.prgBank, 2);
+    EXPECT_EQ(nes.Read(0x8000), 4);
+    EXPECT_EQ(nes.Read(0xC000), 14);
+
+    //when:
+    WriteMMC1(0x8000, 0x02);
+
+    //then: 32 KiB mode, vertical mirroring
+    EXPECT_EQ(cartridge.Mirroring(), VERTICAL);
+    EXPECT_EQ(nes.Read(0x8000), 4);
+    EXPECT_EQ(nes.Read(0xC000), 6);
+}
+
+TEST_F(M6502NESMappersTest, MMC1ResetBitClearsPartialWrite){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x20000);
+    MMC1 cartridge{nes, prg.data(), uint32_t(prg.size())};
+
+    //when:
+    CpuWrite(0xE000, 1);
+    CpuWrite(0xE000, 1);
+    CpuWrite(0x8000, 0x80);
+    WriteMMC1(0xE000, 1);
+
+    //then:
+    EXPECT_EQ(cartridge.prgBank, 1);
+    EXPECT_EQ(nes.Read(0x8000), 2);
+}
+
+TEST_F(M6502NESMappersTest, MMC3SwitchesPRGWindowsAndCountsScanlines){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x10000);
+    MMC3 cartridge{nes, prg.data(), uint32_t(prg.size())};
+    cartridge.irqOutput = [this](bool asserted){ cpu.SetIRQ(asserted); };
+
+    //when:
+    CpuWrite(0x8000, 0x06);
+    CpuWrite(0x8001, 3);
+    CpuWrite(0x8000, 0x07);
+    CpuWrite(0x8001, 5);
+
+    //then:
+    EXPECT_EQ(nes.Read(0x8000), 3);
+    EXPECT_EQ(nes.Read(0xA000), 5);
+    EXPECT_EQ(nes.Read(0xC000), 6);
+    EXPECT_EQ(nes.Read(0xE000), 7);
+
+    //when:
+    CpuWrite(0x8000, 0x46);
+
+    //then:
+    EXPECT_EQ(nes.Read(0x8000), 6);
+    EXPECT_EQ(nes.Read(0xC000), 3);
+
+    //when:
+    CpuWrite(0xC000, 2);
+    CpuWrite(0xC001, 0);
+    CpuWrite(0xE001, 0);
+    cartridge.ClockScanline();
+    cartridge.ClockScanline();
+
+    //then:
+    EXPECT_FALSE(cartridge.irqPending);
+    EXPECT_FALSE(cpu.IRQLine());
+
+    //when:
+    cartridge.ClockScanline();
+
+    //then:
+    EXPECT_TRUE(cartridge.irqPending);
+    EXPECT_TRUE(cpu.IRQLine());
+
+    //when: acknowledged
+    CpuWrite(0xE000, 0);
+
+    //then:
+    EXPECT_FALSE(cartridge.irqPending);
+    EXPECT_FALSE(cpu.IRQLine());
+}
+
+TEST_F(M6502NESMappersTest, BankSwitchInvalidatesDecodedCode){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x10000);
+    UxROM cartridge{nes, prg.data(), uint32_t(prg.size())};
+    BlockCache cache{};
+
+    /*
+     * bank 0:  lda #$01
+     *          sta $8000   ; switch to bank 1
+     *          jmp $8000
+     * bank 1:  ldx #$42
+     *          jmp *
+     *          jmp $8000   ; continues after the switch
+     * */
+    uint8_t bank0[] = {INSTRUCTIONS::INS_LDA_IM, 0x01, INSTRUCTIONS::INS_STA_ABS, 0x00, 0x80,
+                       INSTRUCTIONS::INS_JMP_ABS, 0x00, 0x80};
+    uint8_t bank1[] = {INSTRUCTIONS::INS_LDX_IM, 0x42, INSTRUCTIONS::INS_JMP_ABS, 0x02, 0x80,
+                       INSTRUCTIONS::INS_JMP_ABS, 0x00, 0x80};
+    std::copy(std::begin(bank0), std::end(bank0), prg.begin());
+    std::copy(std::begin(bank1), std::end(bank1), prg.begin() + 0x4000);
+    cpu.PC = 0x8000;
+
+    //when:
+    cache.Execute(cpu, 2 + 4 + 3 + 2, nes);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x42);
+    EXPECT_EQ(cpu.PC, 0x8002);
+}
+
+TEST_F(M6502NESMappersTest, CreateMapperRejectsUnknownMappers){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x8000);
+
+    //then:
+    EXPECT_NE(CreateMapper(4, nes, prg.data(), uint32_t(prg.size())), nullptr);
+    EXPECT_THROW(CreateMapper(7, nes, prg.data(), uint32_t(prg.size())), std::invalid_argument);
+    EXPECT_THROW(CreateMapper(0, nes, prg.data(), 0x3000), std::invalid_argument);
+}
+
+TEST_F(M6502NESMappersTest, RejectedCartridgeLeavesBusUntouched){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x10000);
+
+    //then:
+    EXPECT_THROW(NROM(nes, prg.data(), uint32_t(prg.size())), std::invalid_argument);
+    EXPECT_THROW(MMC3(nes, prg.data(), 0x2000), std::invalid_argument);
+    EXPECT_FALSE(nes.IsHostMemory(0x6000));
+    EXPECT_EQ(nes.pageGeneration[0x60], 0u);
+}
+
+TEST_F(M6502NESMappersTest, DestroyedMapperUnmapsCartridgeSpace){
+    //given:
+    std::vector<uint8_t> prg = MakePRG(0x8000);
+    {
+        NROM cartridge{nes, prg.data(), uint32_t(prg.size())};
+        ASSERT_TRUE(nes.IsHostMemory(0x6000));
+        ASSERT_TRUE(nes.IsHostMemory(0x8000));
+    }
+
+    //when:
+    nes.Write(0x6000, 0x42);
+    nes.Write(0x8000, 0x42);
+
+    //then:
+    EXPECT_FALSE(nes.IsHostMemory(0x6000));
+    EXPECT_FALSE(nes.IsHostMemory(0xFFFF));
+    EXPECT_EQ(nes.Read(0x6000), 0);
+    EXPECT_EQ(nes.Read(0x8000), 0);
+}
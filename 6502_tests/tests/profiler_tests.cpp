@@ -0,0 +1,175 @@
+#include "6502_cpu.h"
+#include "6502_profiler.h"
+#include "machine_test.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+using namespace MOS6502;
+
+class M6502ProfilerTest : public M6502MachineTest {
+public:
+    Profiler profiler{};
+
+    virtual void SetUp(){
+#if !MOS6502_PROFILER
+        GTEST_SKIP() << "profiling is compiled out";
+#endif
+        mem.Initialise();
+        cpu.LoadState(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20});
+        cpu.profiler = &profiler;
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    RunResult RunTo(uint16_t targetPC){
+        RunLimits limits{};
+        limits.targetPC = targetPC;
+        limits.cycles = 100000;
+        return cpu.Run(limits, mem);
+    }
+};
+
+TEST_F(M6502ProfilerTest, CountsOpcodesCyclesAndBranches){
+    //given:
+    /*
+     * * = $1000
+     *
+     * ldx #$03
+     * loop dex
+     * bne loop
+     * end jmp end
+     * */
+    Place(0x1000, {0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0x4C, 0x05, 0x10});
+
+    //when:
+    RunResult result = RunTo(0x1005);
+
+    //then:
+    EXPECT_EQ(result.cycles, 16);
+    EXPECT_EQ(profiler.opcodeCount[INS_LDX_IM], 1);
+    EXPECT_EQ(profiler.opcodeCount[INS_DEX], 3);
+    EXPECT_EQ(profiler.opcodeCount[INS_BNE], 3);
+    EXPECT_EQ(profiler.opcodeCycles[INS_BNE], 8);
+    EXPECT_EQ(profiler.pcCycles[0x1000], 2);
+    EXPECT_EQ(profiler.pcCycles[0x1002], 6);
+    EXPECT_EQ(profiler.pcCycles[0x1003], 8);
+    EXPECT_EQ(profiler.branchesTaken, 2);
+    EXPECT_EQ(profiler.branchesNotTaken, 1);
+    EXPECT_EQ(profiler.pageCrossings, 0);
+}
+
+TEST_F(M6502ProfilerTest, CountsPageCrossings){
+    //given:
+    /*
+     * * = $10F0
+     *
+     * ldx #$20
+     * lda $20F0,x
+     * beq next
+     * nop
+     * next nop
+     * */
+    cpu.PC = 0x10F0;
+    Place(0x10F0, {0xA2, 0x20, 0xBD, 0xF0, 0x20, 0xF0, 0x0A});
+    Place(0x1101, {0xEA});
+
+    //when:
+    cpu.Execute(13, mem);
+
+    //then: lda crosses into $2110, taken beq lands on the next page
+    EXPECT_EQ(cpu.PC, 0x1102);
+    EXPECT_EQ(profiler.pageCrossings, 2);
+    EXPECT_EQ(profiler.branchesTaken, 1);
+}
+
+TEST_F(M6502ProfilerTest, CollapsedStacksFollowSubroutines){
+    //given:
+    /*
+     * * = $1000
+     *
+     * jsr first
+     * jsr second
+     * end jmp end
+     *
+     * * = $1100
+     * first jsr second
+     * rts
+     *
+     * * = $1200
+     * second nop
+     * rts
+     * */
+    Place(0x1000, {0x20, 0x00, 0x11, 0x20, 0x00, 0x12, 0x4C, 0x06, 0x10});
+    Place(0x1100, {0x20, 0x00, 0x12, 0x60});
+    Place(0x1200, {0xEA, 0x60});
+
+    //when:
+    RunTo(0x1006);
+    std::ostringstream stacks;
+    profiler.WriteCollapsedStacks(stacks);
+
+    //then: jsr is counted in the caller, rts in the callee
+    EXPECT_EQ(stacks.str(), "root 12\n"
+                            "root;$1100 12\n"
+                            "root;$1100;$1200 8\n"
+                            "root;$1200 8\n");
+}
+
+TEST_F(M6502ProfilerTest, ReturnsFromCallsDeeperThanMaxDepthComeBackToRoot){
+    //given: stack of the 6502 can not hold that many return addresses, so the cpu is left out
+    uint32_t depth = Profiler::MAX_DEPTH + 10;
+    for(uint32_t i = 0; i < depth; i++)
+        profiler.Record(0x2000, INS_JSR, 6, 0x2000);
+    for(uint32_t i = 0; i < depth; i++)
+        profiler.Record(0x2003, INS_RTS, 6, 0x2003);
+
+    //when:
+    profiler.Record(0x1003, INS_NOP, 2, 0x1004);
+    std::ostringstream stacks;
+    profiler.WriteCollapsedStacks(stacks);
+
+    //then: first jsr and nop run in root
+    EXPECT_EQ(stacks.str().substr(0, 7), "root 8\n");
+}
+
+TEST_F(M6502ProfilerTest, ProfiledExecutionGivesSameResults){
+    //given:
+    Place(0x1000, {0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0x4C, 0x05, 0x10});
+    CPU unprofiled{};
+    unprofiled.LoadState(cpu.SaveState());
+
+    //when:
+    int32_t profiledCycles = cpu.Execute(100, mem);
+    int32_t cycles = unprofiled.Execute(100, mem);
+
+    //then:
+    EXPECT_EQ(profiledCycles, cycles);
+    EXPECT_EQ(cpu.SaveState(), unprofiled.SaveState());
+}
+
+TEST_F(M6502ProfilerTest, FlatProfileListsHottestOpcodesAndAddresses){
+    //given:
+    Place(0x1000, {0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0x4C, 0x05, 0x10});
+    RunTo(0x1005);
+
+    //when:
+    std::ostringstream flat;
+    profiler.WriteFlatProfile(flat);
+    std::string text = flat.str();
+
+    //then: BNE (8 cycles) comes before DEX (6) and LDX (2)
+    EXPECT_NE(text.find("cycles: 16"), std::string::npos);
+    EXPECT_LT(text.find("$D0 BNE"), text.find("$CA DEX"));
+    EXPECT_LT(text.find("$CA DEX"), text.find("$A2 LDX"));
+    EXPECT_NE(text.find("$1003"), std::string::npos);
+
+    //when:
+    profiler.Clear();
+
+    //then:
+    EXPECT_EQ(profiler.opcodeCount[INS_DEX], 0);
+    EXPECT_EQ(profiler.pcCycles[0x1003], 0);
+}
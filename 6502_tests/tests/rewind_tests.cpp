@@ -0,0 +1,106 @@
+#include "6502_rewind.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace MOS6502;
+
+class M6502RewindTest : public testing::Test {
+public:
+    Bus mem{};
+    CPU cpu{};
+
+    virtual void SetUp(){
+        int32_t c = 7;
+
+        /*
+         * * = $1000
+         *
+         * loop inc $10
+         * bne skip
+         * inc $11
+         * skip inx
+         * stx $0200,x
+         * jmp loop
+         * */
+        uint8_t program[] = {0x00, 0x10, 0xE6, 0x10, 0xD0, 0x02,
+                             0xE6, 0x11, 0xE8, 0x9D, 0x00, 0x02,
+                             0x4C, 0x00, 0x10};
+        mem.LoadProgram(program, 15);
+        cpu.Reset(c, mem);
+    }
+
+    virtual void TearDown(){
+
+    }
+};
+
+TEST_F(M6502RewindTest, SteppingBackRestoresStateCapturedAtThatCycle){
+    //given:
+    RewindBuffer rewind{1000, 1 << 20};
+    rewind.Run(cpu, mem, 4000);
+    uint64_t expectedCycle = rewind.Now();
+    CPUState expectedState = cpu.SaveState();
+    std::vector<uint8_t> expectedRAM(mem.RAM, mem.RAM + Bus::MAX_MEM);
+
+    //when:
+    rewind.Run(cpu, mem, 6000);
+    uint64_t restoredCycle = rewind.StepBack(6000, cpu, mem);
+
+    //then:
+    EXPECT_EQ(restoredCycle, expectedCycle);
+    EXPECT_EQ(rewind.Now(), expectedCycle);
+    EXPECT_EQ(cpu.SaveState(), expectedState);
+    EXPECT_EQ(std::vector<uint8_t>(mem.RAM, mem.RAM + Bus::MAX_MEM), expectedRAM);
+}
+
+TEST_F(M6502RewindTest, RunAfterStepBackReplaysSameTimeline){
+    //given:
+    RewindBuffer rewind{500, 1 << 20};
+    rewind.Run(cpu, mem, 10000);
+    uint64_t end = rewind.Now();
+    CPUState expectedState = cpu.SaveState();
+    std::vector<uint8_t> expectedRAM(mem.RAM, mem.RAM + Bus::MAX_MEM);
+
+    //when:
+    uint64_t restoredCycle = rewind.StepBack(3200, cpu, mem);
+    rewind.Run(cpu, mem, end - restoredCycle);
+
+    //then:
+    EXPECT_LE(restoredCycle, end - 3200);
+    EXPECT_EQ(rewind.Now(), end);
+    EXPECT_EQ(cpu.SaveState(), expectedState);
+    EXPECT_EQ(std::vector<uint8_t>(mem.RAM, mem.RAM + Bus::MAX_MEM), expectedRAM);
+}
+
+TEST_F(M6502RewindTest, FramesStoreOnlyChangedBytes){
+    //given:
+    RewindBuffer rewind{1000, 1 << 20};
+
+    //when:
+    rewind.Run(cpu, mem, 20000);
+
+    //then: full RAM once, each frame a few hundred bytes at most
+    EXPECT_EQ(rewind.FrameCount(), 21);
+    EXPECT_LT(rewind.MemoryUsed(), Bus::MAX_MEM + 20 * 400);
+}
+
+TEST_F(M6502RewindTest, MemoryCapDropsOldestFrames){
+    //given:
+    RewindBuffer rewind{100, Bus::MAX_MEM + 4096};
+
+    //when:
+    rewind.Run(cpu, mem, 100000);
+
+    //then:
+    EXPECT_LE(rewind.MemoryUsed(), Bus::MAX_MEM + 4096);
+    EXPECT_GT(rewind.OldestCycle(), 0);
+    EXPECT_GE(rewind.FrameCount(), 2);
+
+    //when: stepping back past the oldest frame stops at it
+    uint64_t oldest = rewind.OldestCycle();
+    uint64_t restoredCycle = rewind.StepBack(100000, cpu, mem);
+
+    //then:
+    EXPECT_EQ(restoredCycle, oldest);
+    EXPECT_EQ(rewind.FrameCount(), 1);
+}
@@ -0,0 +1,146 @@
+#include "6502_cpu.h"
+#include "NES_mappers.h"
+#include "ROMImage.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace MOS6502;
+
+class M6502ROMImageTest : public testing::Test {
+public:
+    Bus mem{};
+    CPU cpu{};
+    std::string path = testing::TempDir() + "6502_rom_image_test.bin";
+
+    virtual void SetUp(){
+    }
+
+    virtual void TearDown(){
+        std::remove(path.c_str());
+    }
+
+    void WriteFile(const std::vector<uint8_t>& bytes){
+        FILE* file = fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(bytes.data(), 1, bytes.size(), file);
+        fclose(file);
+    }
+
+    std::vector<uint8_t> ReadFile(){
+        std::vector<uint8_t> bytes(0x10000);
+        FILE* file = fopen(path.c_str(), "rb");
+        bytes.resize(fread(bytes.data(), 1, bytes.size(), file));
+        fclose(file);
+        return bytes;
+    }
+};
+
+TEST_F(M6502ROMImageTest, MappedImageIsExecutedInPlaceAndIsNotWritable){
+    //given:
+    std::vector<uint8_t> rom(0x4000, INSTRUCTIONS::INS_NOP);
+
+    /*
+     * * = $C000
+     *
+     * lda $C006
+     * sta $C006
+     * ldx #$42
+     * */
+    uint8_t program[] = {INSTRUCTIONS::INS_LDA_ABS, 0x06, 0xC0, INSTRUCTIONS::INS_STA_ABS, 0x06, 0xC0,
+                         INSTRUCTIONS::INS_LDX_IM, 0x42};
+    std::copy(std::begin(program), std::end(program), rom.begin());
+    WriteFile(rom);
+
+    ROMImage image{path};
+    image.MapTo(mem, 0xC0);
+    cpu.PC = 0xC000;
+
+    //when:
+    cpu.Execute(4 + 4 + 2, mem);
+
+    //then:
+    EXPECT_EQ(mem.pages[0xC0].read, image.Data());
+    EXPECT_EQ(mem.pages[0xFF].read, image.Data() + 0x3F00);
+    EXPECT_EQ(cpu.A, INSTRUCTIONS::INS_LDX_IM);
+    EXPECT_EQ(cpu.X, 0x42);
+    EXPECT_EQ(image.Data()[6], INSTRUCTIONS::INS_LDX_IM);
+    EXPECT_EQ(ReadFile(), rom);
+}
+
+TEST_F(M6502ROMImageTest, RamNextToMappedImageStaysWritable){
+    //given:
+    WriteFile(std::vector<uint8_t>(0x2000, 0xFF));
+    ROMImage image{path};
+    image.MapTo(mem, 0xE0);
+
+    //when:
+    mem.Write(0x0200, 0x12);
+    mem.Write(0xE000, 0x34);
+
+    //then:
+    EXPECT_EQ(mem.Read(0x0200), 0x12);
+    EXPECT_EQ(mem.Read(0xE000), 0xFF);
+}
+
+TEST_F(M6502ROMImageTest, MappingPartOfAPageThrows){
+    //given:
+    WriteFile(std::vector<uint8_t>(0x2000, 0xFF));
+    ROMImage image{path};
+
+    //then:
+    EXPECT_THROW(image.MapTo(mem, 0xE0, 0, 0x1F80), std::invalid_argument);
+    EXPECT_THROW(image.MapTo(mem, 0xE0, 0x80), std::invalid_argument);
+    EXPECT_THROW(image.MapTo(mem, 0xF0), std::invalid_argument);
+    EXPECT_EQ(mem.pages[0xE0].read, mem.RAM + 0xE000);
+}
+
+TEST_F(M6502ROMImageTest, LoadProgramAcceptsProgramsLongerThan255Bytes){
+    //given:
+    std::vector<uint8_t> program(2 + 300, INSTRUCTIONS::INS_NOP);
+    program[0] = 0x00;
+    program[1] = 0x10;
+    program[2 + 299] = 0x77;
+
+    //when:
+    mem.LoadProgram(program.data(), uint32_t(program.size()));
+
+    //then:
+    EXPECT_EQ(mem[0xFFFC], 0x00);
+    EXPECT_EQ(mem[0xFFFD], 0x10);
+    EXPECT_EQ(mem[0x1000], INSTRUCTIONS::INS_NOP);
+    EXPECT_EQ(mem[0x1000 + 299], 0x77);
+}
+
+TEST_F(M6502ROMImageTest, CartridgeMapsPRGFromINESImage){
+    //given:
+    Bus nes{NES};
+    //UxROM (mapper 2), vertical mirroring, two 16 KiB PRG banks, no CHR
+    const uint8_t header[] = {'N', 'E', 'S', 0x1A, 2, 0, 0x21, 0x00, 0, 0, 0, 0, 0, 0, 0, 0};
+    std::vector<uint8_t> file(Cartridge::HEADER_SIZE + 2 * Cartridge::PRG_UNIT, 0xEA);
+    std::copy(std::begin(header), std::end(header), file.begin());
+    file[Cartridge::HEADER_SIZE] = 0x10;
+    file[Cartridge::HEADER_SIZE + Cartridge::PRG_UNIT] = 0x20;
+    WriteFile(file);
+
+    //when:
+    Cartridge cartridge{nes, path};
+
+    //then:
+    EXPECT_EQ(cartridge.mapperNumber, 2);
+    EXPECT_EQ(cartridge.GetMapper().Mirroring(), VERTICAL);
+    EXPECT_EQ(cartridge.chr, nullptr);
+    EXPECT_EQ(nes.Read(0x8000), 0x10);
+    EXPECT_EQ(nes.Read(0xC000), 0x20);
+}
+
+TEST_F(M6502ROMImageTest, LoadingRejectsMissingAndMalformedFiles){
+    //given:
+    WriteFile({'N', 'E', 'S', 0x00, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+    Bus nes{NES};
+
+    //then:
+    EXPECT_THROW(ROMImage{path + ".missing"}, std::runtime_error);
+    EXPECT_THROW(Cartridge(nes, path), std::runtime_error);
+}
@@ -0,0 +1,204 @@
+#include "6502_cpu.h"
+#include "6502_scheduler.h"
+#include "machine_test.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace MOS6502;
+
+/*device remembering the cycle of every register access, write schedules an event that many cycles later*/
+class ClockedDevice : public Device {
+public:
+    Scheduler& scheduler;
+    std::vector<uint64_t> accesses{};
+    std::vector<uint64_t> fired{};
+
+    explicit ClockedDevice(Scheduler& owner) : scheduler(owner) {}
+
+    uint8_t Read(uint16_t) override {
+        accesses.push_back(scheduler.Now());
+        return 0;
+    }
+
+    void Write(uint16_t, uint8_t data) override {
+        accesses.push_back(scheduler.Now());
+        scheduler.ScheduleIn(data, [this](uint64_t){ fired.push_back(scheduler.Now()); });
+    }
+};
+
+class M6502SchedulerTest : public M6502MachineTest {
+public:
+    Scheduler scheduler{cpu, mem};
+
+    virtual void SetUp(){
+        mem.Initialise();
+        cpu.LoadState(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20});
+    }
+
+    virtual void TearDown(){
+
+    }
+};
+
+TEST_F(M6502SchedulerTest, CpuRunsUninterruptedUntilTheNextEvent){
+    //given:
+    /*
+     * * = $1000
+     *
+     * loop inx
+     * jmp loop
+     * */
+    Place(0x1000, {0xE8, 0x4C, 0x00, 0x10});
+    std::vector<uint64_t> cycles{};
+    std::vector<uint8_t> counters{};
+    auto record = [&](uint64_t cycle){
+        cycles.push_back(cycle);
+        counters.push_back(cpu.X);
+    };
+    scheduler.ScheduleAt(100, record);
+    scheduler.ScheduleAt(50, record);
+    scheduler.ScheduleAt(50, [&](uint64_t cycle){ cycles.push_back(cycle + 1); });
+
+    //when:
+    STOP_REASON reason = scheduler.RunFor(1000);
+
+    //then: events at one cycle fire in scheduling order, loop takes 5 cycles
+    EXPECT_EQ(reason, STOP_REASON::CYCLES);
+    EXPECT_EQ(cycles, (std::vector<uint64_t>{50, 51, 100}));
+    EXPECT_EQ(counters, (std::vector<uint8_t>{10, 20}));
+    EXPECT_GE(scheduler.Now(), 1000);
+    EXPECT_EQ(scheduler.PendingEvents(), 0);
+}
+
+TEST_F(M6502SchedulerTest, DeviceSeesCycleOfTheAccess){
+    //given:
+    /*
+     * * = $1000
+     *
+     * nop
+     * nop
+     * lda $6000
+     * lda $6000
+     * */
+    ClockedDevice device{scheduler};
+    mem.MapDevice(0x60, 1, &device);
+    Place(0x1000, {0xEA, 0xEA, 0xAD, 0x00, 0x60, 0xAD, 0x00, 0x60});
+
+    //when:
+    scheduler.RunFor(12);
+
+    //then: lda reads on its fourth cycle
+    EXPECT_EQ(device.accesses, (std::vector<uint64_t>{7, 11}));
+}
+
+TEST_F(M6502SchedulerTest, EventScheduledByDeviceShortensRunningSlice){
+    //given:
+    /*
+     * * = $1000
+     *
+     * lda #$0A
+     * sta $6000
+     * loop inx
+     * jmp loop
+     * */
+    ClockedDevice device{scheduler};
+    mem.MapDevice(0x60, 1, &device);
+    Place(0x1000, {0xA9, 0x0A, 0x8D, 0x00, 0x60, 0xE8, 0x4C, 0x05, 0x10});
+
+    //when:
+    scheduler.RunFor(10000);
+
+    //then: written on cycle 5, event is due on cycle 15, the cpu stops at the end of the instruction running then
+    ASSERT_EQ(device.accesses.size(), 1);
+    EXPECT_EQ(device.accesses[0], 5);
+    ASSERT_EQ(device.fired.size(), 1);
+    EXPECT_GE(device.fired[0], 15);
+    EXPECT_LT(device.fired[0], 15 + 3);
+}
+
+TEST_F(M6502SchedulerTest, CancelledEventDoesNotFire){
+    //given:
+    Place(0x1000, {0xE8, 0x4C, 0x00, 0x10});
+    int fired = 0;
+    Scheduler::EventId first = scheduler.ScheduleAt(10, [&](uint64_t){ fired += 1; });
+    scheduler.ScheduleAt(20, [&](uint64_t){ fired += 10; });
+
+    //when:
+    bool cancelled = scheduler.Cancel(first);
+    scheduler.RunFor(100);
+
+    //then:
+    EXPECT_TRUE(cancelled);
+    EXPECT_FALSE(scheduler.Cancel(first));
+    EXPECT_EQ(fired, 10);
+
+    //when: slot of the cancelled event is reused, its old id stays invalid
+    Scheduler::EventId second = scheduler.ScheduleIn(10, [&](uint64_t){ fired += 100; });
+
+    //then:
+    EXPECT_NE(first, second);
+    EXPECT_FALSE(scheduler.Cancel(first));
+    EXPECT_EQ(scheduler.PendingEvents(), 1);
+}
+
+TEST_F(M6502SchedulerTest, ThousandsOfEventsFireInOrder){
+    //given:
+    Place(0x1000, {0xE8, 0x4C, 0x00, 0x10});
+    std::mt19937 random{6502};
+    std::vector<uint64_t> fired{};
+    for(int i = 0; i < 5000; i++)
+        scheduler.ScheduleAt(random() % 30000, [&](uint64_t cycle){ fired.push_back(cycle); });
+
+    //when:
+    scheduler.RunFor(30000);
+
+    //then:
+    ASSERT_EQ(fired.size(), 5000);
+    EXPECT_TRUE(std::is_sorted(fired.begin(), fired.end()));
+    EXPECT_EQ(scheduler.PendingEvents(), 0);
+}
+
+TEST_F(M6502SchedulerTest, RescheduledEventsDoNotPileUpInTheHeap){
+    //given: device rescheduling its timer on every register access
+    Place(0x1000, {0xE8, 0x4C, 0x00, 0x10});
+    int fired = 0;
+    Scheduler::EventId timer = scheduler.ScheduleAt(1000, [&](uint64_t){ fired++; });
+
+    //when:
+    for(uint64_t i = 0; i < 10000; i++){
+        scheduler.Cancel(timer);
+        timer = scheduler.ScheduleAt(1000 + i, [&](uint64_t){ fired++; });
+    }
+
+    //then:
+    EXPECT_LE(scheduler.QueuedEvents(), 2 * Scheduler::COMPACT_THRESHOLD);
+
+    //when:
+    scheduler.RunFor(20000);
+
+    //then:
+    EXPECT_EQ(fired, 1);
+    EXPECT_EQ(scheduler.PendingEvents(), 0);
+}
+
+TEST_F(M6502SchedulerTest, UnknownInstructionStopKeepsTimeOfExecutedInstructions){
+    //given:
+    /*
+     * * = $1000
+     *
+     * lda #$01
+     * inx
+     * .byte $02 ; unknown
+     * */
+    Place(0x1000, {0xA9, 0x01, 0xE8, 0x02});
+    scheduler.ScheduleAt(1000, [](uint64_t){});
+
+    //when:
+    STOP_REASON reason = scheduler.RunFor(100);
+
+    //then: lda 2, inx 2, fetch of the unknown opcode 1
+    EXPECT_EQ(reason, STOP_REASON::UNKNOWN_INSTRUCTION);
+    EXPECT_EQ(scheduler.Now(), 5);
+}
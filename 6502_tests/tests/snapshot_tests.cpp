@@ -0,0 +1,167 @@
+#include "6502_cpu.h"
+#include "6502_block_cache.h"
+#include <gtest/gtest.h>
+
+using namespace MOS6502;
+
+class M6502SnapshotTest : public testing::Test {
+public:
+    Bus mem{};
+    CPU cpu{};
+
+    virtual void SetUp(){
+    }
+
+    virtual void TearDown(){
+
+    }
+};
+
+TEST_F(M6502SnapshotTest, RestoringSnapshotAndStateResumesFromCheckpoint){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $1000
+     *
+     * loop inc $10
+     * inx
+     * jmp loop
+     * */
+    uint8_t program[] = {0x00, 0x10, 0xE6, 0x10, 0xE8, 0x4C, 0x00, 0x10};
+    mem.LoadProgram(program, 8);
+    cpu.Reset(c, mem);
+    cpu.Execute(20, mem);
+
+    CPUState state = cpu.SaveState();
+    Bus::Snapshot snapshot = mem.TakeSnapshot();
+    uint8_t counter = mem.Read(0x0010);
+
+    //when:
+    cpu.Execute(100, mem);
+    cpu.LoadState(state);
+    mem.RestoreSnapshot(snapshot);
+
+    //then:
+    EXPECT_EQ(cpu.SaveState(), state);
+    EXPECT_EQ(mem.Read(0x0010), counter);
+
+    //when:
+    CPU replay = cpu;
+    cpu.Execute(100, mem);
+    Bus::Snapshot afterReplay = mem.TakeSnapshot();
+    mem.RestoreSnapshot(snapshot);
+    replay.Execute(100, mem);
+
+    //then:
+    EXPECT_EQ(replay.SaveState(), cpu.SaveState());
+    EXPECT_EQ(mem.Read(0x0010), (*afterReplay.pages[0x00])[0x10]);
+}
+
+TEST_F(M6502SnapshotTest, UnmodifiedPagesAreSharedBetweenSnapshots){
+    //given:
+    Bus::Snapshot first = mem.TakeSnapshot();
+
+    //when:
+    mem.Write(0x0210, 0x42);
+    Bus::Snapshot second = mem.TakeSnapshot();
+
+    //then:
+    EXPECT_NE(second.pages[0x02], first.pages[0x02]);
+    EXPECT_EQ((*first.pages[0x02])[0x10], 0x00);
+    EXPECT_EQ((*second.pages[0x02])[0x10], 0x42);
+    for(uint32_t page = 0; page < Bus::PAGE_COUNT; page++){
+        if(page != 0x02) {
+            EXPECT_EQ(second.pages[page], first.pages[page]) << "page " << page;
+        }
+    }
+}
+
+TEST_F(M6502SnapshotTest, HostWriteCopiesOnlyItsPage){
+    //given:
+    Bus::Snapshot first = mem.TakeSnapshot();
+
+    //when:
+    mem[0x0310] = 0x42;
+    Bus::Snapshot second = mem.TakeSnapshot();
+
+    //then:
+    EXPECT_NE(second.pages[0x03], first.pages[0x03]);
+    EXPECT_EQ((*second.pages[0x03])[0x10], 0x42);
+    for(uint32_t page = 0; page < Bus::PAGE_COUNT; page++){
+        if(page != 0x03) {
+            EXPECT_EQ(second.pages[page], first.pages[page]) << "page " << page;
+        }
+    }
+}
+
+TEST_F(M6502SnapshotTest, RestoreCopiesOnlyPagesWhichDiffer){
+    //given:
+    mem.Write(0x0300, 0x01);
+    Bus::Snapshot snapshot = mem.TakeSnapshot();
+    mem.Write(0x0300, 0x02);
+    mem.Write(0x0400, 0x03);
+    uint32_t generations[Bus::PAGE_COUNT];
+    std::copy(std::begin(mem.pageGeneration), std::end(mem.pageGeneration), std::begin(generations));
+
+    //when:
+    mem.RestoreSnapshot(snapshot);
+
+    //then:
+    EXPECT_EQ(mem.Read(0x0300), 0x01);
+    EXPECT_EQ(mem.Read(0x0400), 0x00);
+    for(uint32_t page = 0; page < Bus::PAGE_COUNT; page++){
+        bool restored = page == 0x03 || page == 0x04;
+        EXPECT_EQ(mem.pageGeneration[page] != generations[page], restored) << "page " << page;
+    }
+}
+
+TEST_F(M6502SnapshotTest, BlockCacheRunsRestoredCode){
+    //given:
+    BlockCache cache{};
+
+    /*
+     * * = $0200
+     *
+     * ldx #$01
+     * jmp *
+     * */
+    mem[0x0200] = INSTRUCTIONS::INS_LDX_IM;
+    mem[0x0201] = 0x01;
+    mem[0x0202] = INSTRUCTIONS::INS_JMP_ABS;
+    mem[0x0203] = 0x02;
+    mem[0x0204] = 0x02;
+    Bus::Snapshot snapshot = mem.TakeSnapshot();
+
+    //ldx is replaced by ldy and decoded
+    mem.Write(0x0200, INSTRUCTIONS::INS_LDY_IM);
+    cpu.PC = 0x0200;
+    cache.Execute(cpu, 2, mem);
+
+    //when:
+    mem.RestoreSnapshot(snapshot);
+    cpu.PC = 0x0200;
+    cpu.Y = 0x00;
+    cache.Execute(cpu, 2, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0x01);
+    EXPECT_EQ(cpu.Y, 0x00);
+}
+
+TEST_F(M6502SnapshotTest, MirroredPagesShareOneCopy){
+    //given:
+    Bus nes{NES};
+    nes.Write(0x0805, 0x42);
+
+    //when:
+    Bus::Snapshot snapshot = nes.TakeSnapshot();
+    nes.Write(0x1005, 0x00);
+    nes.RestoreSnapshot(snapshot);
+
+    //then:
+    EXPECT_EQ(snapshot.pages[0x00], snapshot.pages[0x08]);
+    EXPECT_EQ(snapshot.pages[0x00], snapshot.pages[0x18]);
+    EXPECT_EQ(snapshot.pages[0x20], nullptr);
+    EXPECT_EQ(nes.Read(0x0005), 0x42);
+}
@@ -0,0 +1,146 @@
+#include "6502_block_cache.h"
+#include "6502_superinstructions.h"
+#include <gtest/gtest.h>
+
+using namespace MOS6502;
+
+class M6502SuperinstructionsTest : public testing::Test {
+public:
+    Bus mem{};
+    CPU cpu{};
+    BlockCache cache{};
+
+    virtual void SetUp(){
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    /*runs program on block cache and interpreter with every budget up to maxCycles*/
+    static void ExpectSameAsInterpreter(const uint8_t* program, uint8_t programSize, int32_t maxCycles){
+        for(int32_t budget = 1; budget <= maxCycles; budget++){
+            int32_t c = 7;
+            Bus cacheMem{};
+            Bus interpreterMem{};
+            CPU cacheCPU{};
+            BlockCache budgetCache{};
+
+            cacheMem.LoadProgram(program, programSize);
+            interpreterMem.LoadProgram(program, programSize);
+            cacheCPU.Reset(c, cacheMem);
+            CPU interpreterCPU = cacheCPU;
+
+            int32_t cyclesUsed = budgetCache.Execute(cacheCPU, budget, cacheMem);
+            int32_t interpreterCyclesUsed = interpreterCPU.Execute(budget, interpreterMem);
+
+            EXPECT_EQ(cyclesUsed, interpreterCyclesUsed) << "budget " << budget;
+            EXPECT_EQ(cacheCPU.PC, interpreterCPU.PC) << "budget " << budget;
+            EXPECT_EQ(cacheCPU.A, interpreterCPU.A) << "budget " << budget;
+            EXPECT_EQ(cacheCPU.X, interpreterCPU.X) << "budget " << budget;
+            EXPECT_EQ(cacheCPU.Y, interpreterCPU.Y) << "budget " << budget;
+            EXPECT_EQ(cacheCPU.P.PS, interpreterCPU.P.PS) << "budget " << budget;
+            EXPECT_EQ(cacheMem.RAM[0x0010], interpreterMem.RAM[0x0010]) << "budget " << budget;
+        }
+    }
+};
+
+TEST_F(M6502SuperinstructionsTest, FusedPairStopsBetweenInstructionsWhenCyclesRunOut){
+    //given:
+    int32_t c = 7;
+
+    /*
+     * * = $1000
+     *
+     * lda #$42
+     * sta $10
+     * */
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x42, 0x85, 0x10};
+    mem.LoadProgram( program, 6);
+    cpu.Reset(c, mem);
+
+    //when:
+    int32_t cyclesUsed = cache.Execute(cpu, 2, mem);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, 2);
+    EXPECT_EQ(cpu.A, 0x42);
+    EXPECT_EQ(cpu.PC, 0x1002);
+    EXPECT_EQ(mem.RAM[0x0010], 0x00);
+}
+
+TEST_F(M6502SuperinstructionsTest, DecrementAndBranchLoopMatchesInterpreter){
+    //given:
+    /*
+     * * = $1000
+     *
+     * ldx #$05
+     * loop dex
+     * bne loop
+     * lda #$01
+     * sta $10
+     * end jmp end
+     * */
+    uint8_t program[] = {0x00, 0x10, 0xA2, 0x05, 0xCA, 0xD0,
+                         0xFD, 0xA9, 0x01, 0x85, 0x10, 0x4C,
+                         0x09, 0x10};
+
+    //then:
+    ExpectSameAsInterpreter(program, 14, 40);
+}
+
+TEST_F(M6502SuperinstructionsTest, CompareAndBranchMatchesInterpreter){
+    //given:
+    /*
+     * * = $1000
+     *
+     * lda #$05
+     * cmp #$05
+     * beq skip
+     * ldx #$01
+     * skip ldy #$02
+     * cmp #$06
+     * beq skip
+     * end jmp end
+     * */
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x05, 0xC9, 0x05,
+                         0xF0, 0x02, 0xA2, 0x01, 0xA0, 0x02,
+                         0xC9, 0x06, 0xF0, 0xF8, 0x4C, 0x0E,
+                         0x10};
+
+    //then:
+    ExpectSameAsInterpreter(program, 19, 20);
+}
+
+TEST_F(M6502SuperinstructionsTest, OpcodeProfileFindsHottestSequenceOfCountingLoop){
+    //given:
+    int32_t c = 7;
+    OpcodeProfile profile{};
+
+    uint8_t program[] = {0x00, 0x10, 0xA9, 0x00, 0x18, 0x69,
+                         0x08, 0xC9, 0x18, 0xD0, 0xFA, 0xA2,
+                         0x14};
+    mem.LoadProgram( program, 13);
+    cpu.Reset(c, mem);
+
+    //when:
+    int32_t cyclesUsed = profile.Record(cpu, 26, mem);
+    std::vector<OpcodeProfile::NGram> pairs = profile.Hottest(2, 2);
+    std::vector<OpcodeProfile::NGram> triples = profile.Hottest(3, 1);
+
+    //then:
+    EXPECT_EQ(cyclesUsed, 26);
+    EXPECT_EQ(cpu.X, 0x14);
+
+    ASSERT_EQ(pairs.size(), 2);
+    EXPECT_EQ(pairs[0].opcodes[0], 0x69);
+    EXPECT_EQ(pairs[0].opcodes[1], 0xC9);
+    EXPECT_EQ(pairs[0].count, 3);
+    EXPECT_EQ(pairs[1].opcodes[0], 0xC9);
+    EXPECT_EQ(pairs[1].opcodes[1], 0xD0);
+    EXPECT_EQ(pairs[1].count, 3);
+
+    ASSERT_EQ(triples.size(), 1);
+    EXPECT_EQ(triples[0].opcodes, (std::array<uint8_t, 3>{0x69, 0xC9, 0xD0}));
+    EXPECT_EQ(triples[0].count, 3);
+}
@@ -0,0 +1,380 @@
+//
+// Created by Lukasz on 18.10.2026.
+//
+#include "6502_cpu.h"
+#include "6502_profiler.h"
+#include "6502_trace.h"
+#include "../machine_test.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace MOS6502;
+
+/*device driving IRQ line of the cpu with the last value written to it*/
+class IRQSource : public Device {
+public:
+    CPU& cpu;
+
+    explicit IRQSource(CPU& processor) : cpu(processor) {}
+
+    uint8_t Read(uint16_t) override {
+        return cpu.IRQLine();
+    }
+
+    void Write(uint16_t, uint8_t data) override {
+        cpu.SetIRQ(data != 0);
+    }
+};
+
+class M6502InterruptTest : public M6502MachineTest {
+public:
+
+    virtual void SetUp(){
+        mem.Initialise();
+        cpu.LoadState(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20});
+
+        //IRQ handler at $2000, NMI handler at $3000, both spin
+        mem[0xFFFE] = 0x00;
+        mem[0xFFFF] = 0x20;
+        mem[0xFFFA] = 0x00;
+        mem[0xFFFB] = 0x30;
+        Place(0x2000, {0x4C, 0x00, 0x20});
+        Place(0x3000, {0x4C, 0x00, 0x30});
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    uint16_t PushedPC() const {
+        return mem[0x01FE] | (mem[0x01FF] << 8);
+    }
+};
+
+TEST_F(M6502InterruptTest, IRQTakesSevenCyclesAndPushesStatusWithoutBreak){
+    //given:
+    Place(0x1000, {0xEA, 0x4C, 0x00, 0x10});
+    cpu.SetIRQ(true);
+
+    //when:
+    int32_t cycles = cpu.Execute(7, mem);
+
+    //then:
+    EXPECT_EQ(cycles, 7);
+    EXPECT_EQ(cpu.PC, 0x2000);
+    EXPECT_EQ(cpu.S, 0xFC);
+    EXPECT_TRUE(cpu.P.I);
+    EXPECT_EQ(PushedPC(), 0x1000);
+    EXPECT_EQ(mem[0x01FD], 0x20);
+}
+
+TEST_F(M6502InterruptTest, MaskedIRQIsTakenOneInstructionAfterCLI){
+    //given:
+    /*
+     * * = $1000
+     *
+     * nop
+     * cli
+     * inx
+     * iny
+     * end jmp end
+     * */
+    Place(0x1000, {0xEA, 0x58, 0xE8, 0xC8, 0x4C, 0x04, 0x10});
+    cpu.P.I = 1;
+    cpu.SetIRQ(true);
+
+    //when:
+    int32_t cycles = cpu.Execute(13, mem);
+
+    //then: nop 2, cli 2, inx 2, interrupt 7
+    EXPECT_EQ(cycles, 13);
+    EXPECT_EQ(cpu.PC, 0x2000);
+    EXPECT_EQ(cpu.X, 1);
+    EXPECT_EQ(cpu.Y, 0);
+    EXPECT_EQ(PushedPC(), 0x1003);
+}
+
+TEST_F(M6502InterruptTest, RunHonoursCLIDelayToo){
+    //given:
+    Place(0x1000, {0xEA, 0x58, 0xE8, 0xC8, 0x4C, 0x04, 0x10});
+    cpu.P.I = 1;
+    cpu.SetIRQ(true);
+    RunLimits limits{};
+    limits.targetPC = 0x2000;
+    limits.cycles = 1000;
+
+    //when:
+    RunResult result = cpu.Run(limits, mem);
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::TARGET_PC);
+    EXPECT_EQ(result.cycles, 13);
+    EXPECT_EQ(result.instructions, 3);
+    EXPECT_EQ(PushedPC(), 0x1003);
+}
+
+TEST_F(M6502InterruptTest, IRQRaisedByDeviceIsTakenAfterTheInstructionRaisingIt){
+    //given:
+    /*
+     * * = $1000
+     *
+     * lda #$01
+     * sta $6000
+     * nop
+     * */
+    IRQSource device{cpu};
+    mem.MapDevice(0x60, 1, &device);
+    Place(0x1000, {0xA9, 0x01, 0x8D, 0x00, 0x60, 0xEA});
+
+    //when:
+    int32_t cycles = cpu.Execute(100, mem);
+
+    //then: lda 2, sta 4, interrupt 7, the rest of the budget in the handler
+    EXPECT_EQ(cycles, 100);
+    EXPECT_EQ(PushedPC(), 0x1005);
+    EXPECT_EQ(cpu.S, 0xFC);
+
+    //when:
+    cpu.LoadState(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20});
+    cpu.SetIRQ(false);
+    cycles = cpu.Execute(13, mem);
+
+    //then:
+    EXPECT_EQ(cycles, 13);
+    EXPECT_EQ(cpu.PC, 0x2000);
+}
+
+TEST_F(M6502InterruptTest, RTIReturnsIntoPendingIRQ){
+    //given:
+    /*
+     * * = $1000
+     *
+     * loop inx
+     * jmp loop
+     *
+     * * = $2000
+     * iny
+     * rti
+     * */
+    Place(0x1000, {0xE8, 0x4C, 0x00, 0x10});
+    Place(0x2000, {0xC8, 0x40});
+    cpu.SetIRQ(true);
+
+    //when: line is never released, every RTI goes straight back to the handler
+    cpu.Execute(7 + 10 * (2 + 6 + 7), mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 0);
+    EXPECT_EQ(cpu.Y, 10);
+}
+
+TEST_F(M6502InterruptTest, NMIIsTakenOncePerEdgeAndIgnoresInterruptFlag){
+    //given:
+    /*
+     * * = $1000
+     *
+     * loop jmp loop
+     *
+     * * = $3000
+     * inx
+     * rti
+     * */
+    Place(0x1000, {0x4C, 0x00, 0x10});
+    Place(0x3000, {0xE8, 0x40});
+    cpu.P.I = 1;
+
+    //when:
+    cpu.SetNMI(true);
+    cpu.Execute(50, mem);
+    cpu.SetNMI(true);
+    cpu.Execute(50, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 1);
+    EXPECT_FALSE(cpu.NMIPending());
+
+    //when:
+    cpu.SetNMI(false);
+    cpu.SetNMI(true);
+    cpu.Execute(50, mem);
+
+    //then:
+    EXPECT_EQ(cpu.X, 2);
+    EXPECT_EQ(cpu.PC, 0x1000);
+}
+
+TEST_F(M6502InterruptTest, MaskedIRQIsIgnored){
+    //given:
+    Place(0x1000, {0xE8, 0x4C, 0x00, 0x10});
+    cpu.P.I = 1;
+    cpu.SetIRQ(true);
+
+    //when:
+    int32_t cycles = cpu.Execute(1000, mem);
+
+    //then: masked line changes nothing
+    EXPECT_EQ(cycles, 1000);
+    EXPECT_EQ(cpu.S, 0xFF);
+}
+
+TEST_F(M6502InterruptTest, InterruptEntryIsTracedAndProfiled){
+    //given:
+    /*
+     * * = $1000
+     *
+     * lda #$01
+     * sta $6000
+     * nop
+     * end jmp end
+     *
+     * * = $2000
+     * lda #$00
+     * sta $6000
+     * rti
+     * */
+    IRQSource device{cpu};
+    mem.MapDevice(0x60, 1, &device);
+    Place(0x1000, {0xA9, 0x01, 0x8D, 0x00, 0x60, 0xEA, 0x4C, 0x06, 0x10});
+    Place(0x2000, {0xA9, 0x00, 0x8D, 0x00, 0x60, 0x40});
+    std::string path = testing::TempDir() + "6502_interrupt_test.trace";
+    Profiler profiler{};
+    cpu.profiler = &profiler;
+
+    //when:
+    RunResult result{};
+    {
+        TraceRecorder recorder{path};
+        cpu.tracer = &recorder;
+        RunLimits limits{};
+        limits.targetPC = 0x1006;
+        limits.cycles = 1000;
+        result = cpu.Run(limits, mem);
+        cpu.tracer = nullptr;
+    }
+
+    //then: lda 2, sta 4, interrupt 7, handler 12, nop 2
+    EXPECT_EQ(result.cycles, 27);
+    EXPECT_EQ(result.instructions, 6);
+
+    std::ifstream input(path, std::ios::binary);
+    input.seekg(sizeof(TraceRecorder::MAGIC) + sizeof(uint32_t));
+    std::vector<TraceRecord> records;
+    TraceRecord record{};
+    while(input.read(reinterpret_cast<char*>(&record), sizeof(record)))
+        records.push_back(record);
+    ASSERT_EQ(records.size(), 7);
+    EXPECT_EQ(records[1].flags, 0);
+    EXPECT_EQ(records[2].flags, TRACE_IRQ);
+    EXPECT_EQ(records[2].PC, 0x1005);
+    EXPECT_EQ(records[2].cycles, 7);
+    EXPECT_EQ(records[2].writeCount, 3);
+    EXPECT_EQ(records[2].operands[0] | (records[2].operands[1] << 8), 0x2000);
+    EXPECT_EQ(records[3].PC, 0x2000);
+    EXPECT_EQ(records[3].S, 0xFC);
+    uint32_t tracedCycles = 0;
+    for(const TraceRecord& traced : records)
+        tracedCycles += traced.cycles;
+    EXPECT_EQ(tracedCycles, result.cycles);
+
+    input.clear();
+    input.seekg(0);
+    std::ostringstream decoded;
+    DecodeTrace(input, decoded);
+    std::string text = decoded.str();
+    EXPECT_NE(text.find("IRQ -> $2000"), std::string::npos) << text;
+    //handler starts after the cycles of lda, sta and the interrupt entry
+    EXPECT_NE(text.find("        13 2000"), std::string::npos) << text;
+    input.close();
+    std::remove(path.c_str());
+
+#if MOS6502_PROFILER
+    //then: entry is charged to the handler, RTI returns to the interrupted code
+    EXPECT_EQ(profiler.irqs, 1);
+    EXPECT_EQ(profiler.nmis, 0);
+    EXPECT_EQ(profiler.interruptCycles, 7);
+    std::ostringstream stacks;
+    profiler.WriteCollapsedStacks(stacks);
+    EXPECT_EQ(stacks.str(), "root 8\n"
+                            "root;$2000 19\n");
+#endif
+}
+
+TEST_F(M6502InterruptTest, ExecuteInfiniteTakesNMIRaisedWhileRunning){
+    //given:
+    /*
+     * * = $1000
+     *
+     * lda #$01
+     * sta $6000   ; raises NMI
+     * loop jmp loop
+     *
+     * * = $3000
+     * lda #$02
+     * sta $6000   ; stops the run
+     * end jmp end
+     * */
+    class NMISource : public Device {
+    public:
+        CPU& cpu;
+        std::atomic<bool>& stop;
+
+        NMISource(CPU& processor, std::atomic<bool>& stopFlag) : cpu(processor), stop(stopFlag) {}
+
+        uint8_t Read(uint16_t) override {
+            return 0;
+        }
+
+        void Write(uint16_t, uint8_t data) override {
+            if(data == 1)
+                cpu.SetNMI(true);
+            else
+                stop.store(true);
+        }
+    };
+    std::atomic<bool> stop{false};
+    NMISource device{cpu, stop};
+    mem.MapDevice(0x60, 1, &device);
+    Place(0x1000, {0xA9, 0x01, 0x8D, 0x00, 0x60, 0x4C, 0x05, 0x10});
+    Place(0x3000, {0xA9, 0x02, 0x8D, 0x00, 0x60, 0x4C, 0x05, 0x30});
+
+    //when:
+    RunResult result = cpu.ExecuteInfinite(mem, stop);
+
+    //then:
+    EXPECT_EQ(result.reason, STOP_REASON::STOP_REQUESTED);
+    EXPECT_EQ(cpu.PC, 0x3005);
+    EXPECT_EQ(cpu.S, 0xFC);
+    EXPECT_EQ(PushedPC(), 0x1005);
+    EXPECT_FALSE(cpu.NMIPending());
+}
+
+TEST_F(M6502InterruptTest, DeviceThrowingOutOfExecuteLeavesNoSliceBehind){
+    //given:
+    class FaultyDevice : public Device {
+    public:
+        uint8_t Read(uint16_t) override {
+            throw std::runtime_error("bus error");
+        }
+
+        void Write(uint16_t, uint8_t) override {}
+    };
+    FaultyDevice device{};
+    mem.MapDevice(0x60, 1, &device);
+    //lda $6000
+    Place(0x1000, {0xAD, 0x00, 0x60});
+
+    //when:
+    EXPECT_THROW(cpu.Execute(100, mem), std::runtime_error);
+    cpu.SetIRQ(true);
+
+    //then: cpu is outside of Execute, interrupt waits for the next call
+    EXPECT_EQ(cpu.SliceElapsed(), 0);
+    EXPECT_EQ(cpu.Execute(7, mem), 7);
+    EXPECT_EQ(cpu.PC, 0x2000);
+}
@@ -0,0 +1,132 @@
+#include "6502_cpu.h"
+#include "6502_trace.h"
+#include "machine_test.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace MOS6502;
+
+class M6502TraceTest : public M6502MachineTest {
+public:
+    std::string path = testing::TempDir() + "6502_trace_test.trace";
+
+    virtual void SetUp(){
+        mem.Initialise();
+        cpu.LoadState(CPUState{0x1000, 0xFF, 0, 0, 0, 0x20});
+    }
+
+    virtual void TearDown(){
+        std::remove(path.c_str());
+    }
+
+    std::vector<TraceRecord> ReadRecords(){
+        std::ifstream input(path, std::ios::binary);
+        input.seekg(sizeof(TraceRecorder::MAGIC) + sizeof(uint32_t));
+        std::vector<TraceRecord> records;
+        TraceRecord record{};
+        while(input.read(reinterpret_cast<char*>(&record), sizeof(record)))
+            records.push_back(record);
+        return records;
+    }
+
+    std::vector<std::string> DecodedLines(){
+        std::ifstream input(path, std::ios::binary);
+        std::ostringstream output;
+        DecodeTrace(input, output);
+
+        std::vector<std::string> lines;
+        std::istringstream text(output.str());
+        for(std::string line; std::getline(text, line);)
+            lines.push_back(line);
+        return lines;
+    }
+};
+
+TEST_F(M6502TraceTest, RecordsRegistersBeforeInstructionAndWrites){
+    //given:
+    /*
+     * * = $1000
+     *
+     * ldx #$03
+     * stx $0200
+     * jsr sub
+     * end jmp end
+     *
+     * sub rts
+     * */
+    Place(0x1000, {0xA2, 0x03, 0x8E, 0x00, 0x02, 0x20, 0x0B, 0x10, 0x4C, 0x08, 0x10, 0x60});
+
+    //when:
+    {
+        TraceRecorder recorder{path};
+        cpu.tracer = &recorder;
+        RunLimits limits{};
+        limits.targetPC = 0x1008;
+        cpu.Run(limits, mem);
+    }
+
+    //then:
+    std::vector<TraceRecord> records = ReadRecords();
+    ASSERT_EQ(records.size(), 4);
+    EXPECT_EQ(records[0].PC, 0x1000);
+    EXPECT_EQ(records[0].opcode, INS_LDX_IM);
+    EXPECT_EQ(records[0].X, 0x00);
+    EXPECT_EQ(records[0].writeCount, 0);
+    EXPECT_EQ(records[1].X, 0x03);
+    EXPECT_EQ(records[1].cycles, 4);
+    EXPECT_EQ(records[1].writeCount, 1);
+    EXPECT_EQ(records[1].writeAddress, 0x0200);
+    EXPECT_EQ(records[1].writeValue, 0x03);
+    EXPECT_EQ(records[2].writeCount, 2);
+    EXPECT_EQ(records[3].PC, 0x100B);
+    EXPECT_EQ(records[3].S, 0xFD);
+
+    std::vector<std::string> lines = DecodedLines();
+    ASSERT_EQ(lines.size(), 4);
+    EXPECT_NE(lines[0].find("1000  A2 03     LDX #$03"), std::string::npos) << lines[0];
+    EXPECT_NE(lines[1].find("STX $0200"), std::string::npos) << lines[1];
+    EXPECT_NE(lines[1].find("[$0200]=$03"), std::string::npos) << lines[1];
+    EXPECT_NE(lines[2].find("JSR $100B"), std::string::npos) << lines[2];
+    //cycles of the records before: ldx 2, stx 4, jsr 6
+    EXPECT_EQ(lines[3].substr(0, 10), "        12");
+}
+
+TEST_F(M6502TraceTest, RecorderKeepsEveryRecordWhenRingWrapsAround){
+    //given:
+    /*
+     * * = $1000
+     *
+     * loop inx
+     * bne loop
+     * iny
+     * jmp loop
+     * */
+    Place(0x1000, {0xE8, 0xD0, 0xFD, 0xC8, 0x4C, 0x00, 0x10});
+    CPU untraced = cpu;
+    uint64_t count = 0;
+
+    //when:
+    {
+        TraceRecorder recorder{path};
+        cpu.tracer = &recorder;
+        cpu.Execute(1'000'000, mem);
+        count = recorder.RecordCount();
+    }
+    untraced.Execute(1'000'000, mem);
+
+    //then: results do not depend on tracing
+    EXPECT_GT(count, 4 * TraceRecorder::CAPACITY);
+    EXPECT_EQ(ReadRecords().size(), count);
+    EXPECT_EQ(cpu.SaveState(), untraced.SaveState());
+}
+
+TEST_F(M6502TraceTest, DecoderRejectsOtherFiles){
+    std::istringstream input("not a trace file at all");
+    std::ostringstream output;
+
+    EXPECT_THROW(DecodeTrace(input, output), std::runtime_error);
+}
@@ -0,0 +1,234 @@
+#include "6502_cpu.h"
+#include "6502_scheduler.h"
+#include "6502_via.h"
+#include "machine_test.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace MOS6502;
+
+class M6502VIATest : public M6502MachineTest {
+public:
+    Scheduler scheduler{cpu, mem};
+    VIA6522 via{scheduler};
+
+    virtual void SetUp(){
+        mem.Initialise();
+        mem.MapDevice(0x60, 1, &via);
+        via.irqOutput = [this](bool asserted){ cpu.SetIRQ(asserted); };
+
+        LoadNopSled();
+    }
+
+    virtual void TearDown(){
+
+    }
+
+    uint8_t Register(VIA6522::REGISTER reg){
+        return via.Read(0x6000 + reg);
+    }
+
+    void SetRegister(VIA6522::REGISTER reg, uint8_t value){
+        via.Write(0x6000 + reg, value);
+    }
+};
+
+TEST_F(M6502VIATest, OneShotTimer1IsComputedFromCurrentCycle){
+    //given: loaded on cycle 0, counts from cycle 1
+    SetRegister(VIA6522::T1CL, 0x10);
+    SetRegister(VIA6522::T1CH, 0x00);
+
+    //when:
+    scheduler.RunFor(10);
+
+    //then:
+    EXPECT_EQ(Register(VIA6522::T1CH), 0x00);
+    EXPECT_EQ(Register(VIA6522::T1CL), 0x10 - 9);
+    EXPECT_EQ(Register(VIA6522::IFR) & VIA6522::IRQ_T1, 0);
+
+    //when: underflow on cycle 18, counter keeps going down through $FFFF
+    scheduler.RunFor(10);
+
+    //then:
+    EXPECT_EQ(Register(VIA6522::IFR) & VIA6522::IRQ_T1, VIA6522::IRQ_T1);
+    EXPECT_EQ(Register(VIA6522::T1CH), 0xFF);
+    EXPECT_EQ(Register(VIA6522::T1CL), 0xFD);
+    EXPECT_EQ(Register(VIA6522::IFR) & VIA6522::IRQ_T1, 0);
+
+    //when: one shot interrupts once per load
+    scheduler.RunFor(0x20000);
+
+    //then:
+    EXPECT_EQ(Register(VIA6522::IFR) & VIA6522::IRQ_T1, 0);
+}
+
+TEST_F(M6502VIATest, FreeRunningTimer1InterruptsCpuEveryPeriod){
+    //given:
+    /*
+     * * = $1000
+     *
+     * cli
+     * loop jmp loop
+     *
+     * * = $2000
+     * inx
+     * lda $6004
+     * rti
+     * */
+    Place(0x1000, {0x58, 0x4C, 0x01, 0x10});
+    Place(0x2000, {0xE8, 0xAD, 0x04, 0x60, 0x40});
+    mem[0xFFFE] = 0x00;
+    mem[0xFFFF] = 0x20;
+    SetRegister(VIA6522::ACR, 0x40);
+    SetRegister(VIA6522::IER, 0x80 | VIA6522::IRQ_T1);
+    SetRegister(VIA6522::T1CL, 98);
+    SetRegister(VIA6522::T1CH, 0x00);
+
+    //when: period is latch + 2
+    scheduler.RunFor(100 * 50 + 50);
+
+    //then: one event for the next underflow
+    EXPECT_EQ(cpu.X, 50);
+    EXPECT_EQ(scheduler.PendingEvents(), 1);
+}
+
+TEST_F(M6502VIATest, MaskedTimersScheduleNothing){
+    //given:
+    SetRegister(VIA6522::ACR, 0x40);
+    SetRegister(VIA6522::T1CL, 0x00);
+    SetRegister(VIA6522::T1CH, 0x01);
+    SetRegister(VIA6522::T2CL, 0x00);
+    SetRegister(VIA6522::T2CH, 0x01);
+
+    //when:
+    scheduler.RunFor(100000);
+
+    //then: flags are found when IFR is read
+    EXPECT_EQ(scheduler.PendingEvents(), 0);
+    EXPECT_FALSE(via.IRQ());
+    EXPECT_EQ(Register(VIA6522::IFR), VIA6522::IRQ_T1 | VIA6522::IRQ_T2);
+
+    //when:
+    SetRegister(VIA6522::IER, 0x80 | VIA6522::IRQ_T2);
+
+    //then:
+    EXPECT_TRUE(via.IRQ());
+    EXPECT_TRUE(cpu.IRQLine());
+    EXPECT_EQ(Register(VIA6522::IFR), 0x80 | VIA6522::IRQ_T1 | VIA6522::IRQ_T2);
+    EXPECT_EQ(Register(VIA6522::IER), 0x80 | VIA6522::IRQ_T2);
+
+    //when:
+    Register(VIA6522::T2CL);
+
+    //then:
+    EXPECT_FALSE(cpu.IRQLine());
+}
+
+TEST_F(M6502VIATest, Timer1DrivesPB7){
+    //given:
+    SetRegister(VIA6522::ACR, 0xC0);
+    SetRegister(VIA6522::T1CL, 8);
+    SetRegister(VIA6522::T1CH, 0x00);
+
+    //then: low from the load, toggles every 10 cycles from cycle 10
+    EXPECT_EQ(via.PortBOutput() & 0x80, 0x00);
+    scheduler.RunFor(10);
+    EXPECT_EQ(via.PortBOutput() & 0x80, 0x80);
+    scheduler.RunFor(10);
+    EXPECT_EQ(via.PortBOutput() & 0x80, 0x00);
+    scheduler.RunFor(30);
+    EXPECT_EQ(via.PortBOutput() & 0x80, 0x80);
+}
+
+TEST_F(M6502VIATest, Timer2CountsPulsesOnPB6){
+    //given:
+    SetRegister(VIA6522::ACR, 0x20);
+    SetRegister(VIA6522::T2CL, 3);
+    SetRegister(VIA6522::T2CH, 0x00);
+
+    //when:
+    for(int i = 0; i < 3; i++)
+        via.PulsePB6();
+    scheduler.RunFor(1000);
+
+    //then: time does not count
+    EXPECT_EQ(Register(VIA6522::T2CL), 0);
+    EXPECT_EQ(Register(VIA6522::IFR) & VIA6522::IRQ_T2, 0);
+
+    //when:
+    via.PulsePB6();
+
+    //then:
+    EXPECT_EQ(Register(VIA6522::IFR) & VIA6522::IRQ_T2, VIA6522::IRQ_T2);
+    EXPECT_EQ(Register(VIA6522::T2CH), 0xFF);
+}
+
+TEST_F(M6502VIATest, ShiftRegisterShiftsInUnderPhi2){
+    //given: shift in clocked by phi2, a bit every 2 cycles from the cycle after the access
+    via.SetCB2(true);
+    SetRegister(VIA6522::ACR, 0x08);
+    SetRegister(VIA6522::IER, 0x80 | VIA6522::IRQ_SR);
+    SetRegister(VIA6522::SR, 0x00);
+
+    //when:
+    scheduler.RunFor(8);
+
+    //then:
+    EXPECT_FALSE(via.IRQ());
+    EXPECT_EQ(scheduler.PendingEvents(), 1);
+
+    //when: CB2 goes low after 4 bits
+    scheduler.RunFor(2);
+    via.SetCB2(false);
+    scheduler.RunFor(8);
+
+    //then:
+    EXPECT_TRUE(via.IRQ());
+    EXPECT_EQ(Register(VIA6522::SR), 0xF0);
+    EXPECT_FALSE(via.IRQ());
+}
+
+TEST_F(M6502VIATest, ShiftRegisterShiftsOutOnCB1Edges){
+    //given:
+    SetRegister(VIA6522::ACR, 0x1C);
+    SetRegister(VIA6522::SR, 0x81);
+
+    //when:
+    for(int i = 0; i < 3; i++) {
+        via.SetCB1(false);
+        via.SetCB1(true);
+    }
+
+    //then: bit 7 goes out and comes back as bit 0
+    EXPECT_EQ(Register(VIA6522::SR), 0x0C);
+    EXPECT_EQ(Register(VIA6522::IFR) & VIA6522::IRQ_SR, 0);
+}
+
+TEST_F(M6502VIATest, PortsAndCA1Interrupt){
+    //given:
+    SetRegister(VIA6522::DDRA, 0x0F);
+    SetRegister(VIA6522::ORA, 0x05);
+    via.SetPortAInput(0xA0);
+
+    //then:
+    EXPECT_EQ(Register(VIA6522::ORA_NO_HANDSHAKE), 0xA5);
+    EXPECT_EQ(via.PortAOutput(), 0xF5);
+
+    //when: falling edge is active with PCR bit 0 clear
+    via.SetCA1(false);
+
+    //then:
+    EXPECT_EQ(Register(VIA6522::IFR), VIA6522::IRQ_CA1);
+
+    //when:
+    Register(VIA6522::ORA);
+
+    //then:
+    EXPECT_EQ(Register(VIA6522::IFR), 0);
+
+    //when:
+    via.SetCA1(true);
+
+    //then:
+    EXPECT_EQ(Register(VIA6522::IFR), 0);
+}